@@ -0,0 +1,119 @@
+#include "SyntheticMedia.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStringList>
+
+namespace SyntheticMedia {
+
+QList<Distortion> allDistortions() {
+    return {Noise, Blur, Downscale, Compress};
+}
+
+QString distortionName(Distortion distortion) {
+    switch (distortion) {
+    case Noise:     return "noise";
+    case Blur:      return "blur";
+    case Downscale: return "downscale";
+    case Compress:  return "compress";
+    }
+    return QString();
+}
+
+bool distortionFromName(const QString& name, Distortion& distortion) {
+    for (Distortion d : allDistortions()) {
+        if (distortionName(d) == name) {
+            distortion = d;
+            return true;
+        }
+    }
+    return false;
+}
+
+QString pixelFormat(int bitDepth) {
+    return bitDepth > 8 ? "yuv420p10le" : "yuv420p";
+}
+
+static QString clipTag(const ClipSpec& spec) {
+    return QString("%1x%2_%3bit_%4f_%5fps")
+        .arg(spec.width).arg(spec.height).arg(spec.bitDepth).arg(spec.frames).arg(spec.fps);
+}
+
+// Runs ffmpeg to produce `output`. Writes to a temporary name first so an
+// interrupted run never leaves a truncated file that a later run would reuse.
+static bool runFfmpeg(QStringList arguments, const QString& output, QString *error) {
+    const QFileInfo info(output);
+    const QString partial = info.dir().filePath(info.completeBaseName() + ".part." + info.suffix());
+    arguments.prepend("-y");
+    arguments.prepend("error");
+    arguments.prepend("-loglevel");
+    arguments.prepend("-hide_banner");
+    arguments << "-fflags" << "+bitexact" << "-flags:v" << "+bitexact" << partial;
+
+    QProcess process;
+    process.start("ffmpeg", arguments);
+    if (!process.waitForStarted()) {
+        if (error) *error = "Cannot start ffmpeg: " + process.errorString();
+        return false;
+    }
+    process.waitForFinished(-1);
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        if (error) *error = QString::fromLocal8Bit(process.readAllStandardError()).trimmed();
+        QFile::remove(partial);
+        return false;
+    }
+    QFile::remove(output);
+    return QFile::rename(partial, output);
+}
+
+bool generateReference(const ClipSpec& spec, const QString& dir, QString *path, QString *error) {
+    QDir().mkpath(dir);
+    *path = QDir(dir).filePath("ref_" + clipTag(spec) + ".mkv");
+    if (QFileInfo::exists(*path)) return true;
+
+    const QString source = QString("testsrc2=size=%1x%2:rate=%3").arg(spec.width).arg(spec.height).arg(spec.fps);
+    return runFfmpeg({"-f", "lavfi", "-i", source,
+                      "-frames:v", QString::number(spec.frames),
+                      "-pix_fmt", pixelFormat(spec.bitDepth),
+                      "-c:v", "ffv1"},
+                     *path, error);
+}
+
+bool generateDistorted(const ClipSpec& spec, const QString& reference, Distortion distortion,
+                       const QString& dir, QString *path, QString *error) {
+    QDir().mkpath(dir);
+    const QString name = distortionName(distortion) + "_" + clipTag(spec);
+
+    QStringList arguments{"-i", reference};
+    switch (distortion) {
+    case Noise:
+        *path = QDir(dir).filePath(name + ".mkv");
+        arguments << "-vf" << "noise=alls=12:allf=t";
+        arguments << "-pix_fmt" << pixelFormat(spec.bitDepth) << "-c:v" << "ffv1";
+        break;
+    case Blur:
+        *path = QDir(dir).filePath(name + ".mkv");
+        arguments << "-vf" << "gblur=sigma=1.2";
+        arguments << "-pix_fmt" << pixelFormat(spec.bitDepth) << "-c:v" << "ffv1";
+        break;
+    case Downscale:
+        *path = QDir(dir).filePath(name + ".mkv");
+        arguments << "-vf" << QString("scale=%1:%2:flags=bilinear,scale=%3:%4:flags=bilinear")
+                                  .arg(spec.width / 2 & ~1).arg(spec.height / 2 & ~1)
+                                  .arg(spec.width).arg(spec.height);
+        arguments << "-pix_fmt" << pixelFormat(spec.bitDepth) << "-c:v" << "ffv1";
+        break;
+    case Compress:
+        // Built into every ffmpeg, unlike x264/x265, so the suite runs on minimal builds
+        *path = QDir(dir).filePath(name + ".mkv");
+        arguments << "-pix_fmt" << "yuv420p" << "-c:v" << "mpeg2video"
+                  << "-q:v" << "12" << "-g" << QString::number(spec.fps) << "-bf" << "2";
+        break;
+    }
+
+    if (QFileInfo::exists(*path)) return true;
+    return runFfmpeg(arguments, *path, error);
+}
+
+} // namespace SyntheticMedia
@@ -0,0 +1,39 @@
+#ifndef SYNTHETICMEDIA_H
+#define SYNTHETICMEDIA_H
+
+#include <QList>
+#include <QString>
+
+// Deterministic test clips for the benchmark, generated with ffmpeg's lavfi sources.
+// References are testsrc2 stored losslessly (FFV1), so a distortion applied to them
+// is the only difference the metrics see. Everything is written with bitexact flags,
+// making the files reproducible across runs and machines with the same ffmpeg.
+namespace SyntheticMedia {
+    struct ClipSpec {
+        int width = 1280;
+        int height = 720;
+        int bitDepth = 8;   // 8 or 10
+        int frames = 120;
+        int fps = 30;
+    };
+
+    enum Distortion {
+        Noise,      // temporal grain (noise filter, fixed seed)
+        Blur,       // gaussian blur
+        Downscale,  // half-resolution round trip
+        Compress    // MPEG-2 at a coarse quantizer (always 8-bit 4:2:0)
+    };
+
+    QList<Distortion> allDistortions();
+    QString distortionName(Distortion distortion);
+    // Accepts the names returned by distortionName(); returns false for anything else
+    bool distortionFromName(const QString& name, Distortion& distortion);
+    QString pixelFormat(int bitDepth);
+
+    // Write the clip into `dir` unless an earlier run already did; *path receives the file.
+    bool generateReference(const ClipSpec& spec, const QString& dir, QString *path, QString *error);
+    bool generateDistorted(const ClipSpec& spec, const QString& reference, Distortion distortion,
+                           const QString& dir, QString *path, QString *error);
+}
+
+#endif // SYNTHETICMEDIA_H
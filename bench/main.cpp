@@ -0,0 +1,343 @@
+// vidmetric-bench: throughput benchmark for the comparison pipeline.
+//
+// Generates deterministic synthetic clips (see SyntheticMedia.h), runs every engine
+// over them through the same FfmpegJob/JobScheduler path the app uses, and writes
+// one JSON document with wall time, frames/sec, CPU time and peak RSS per run.
+// Compare two documents from different builds or machines to spot regressions.
+#include "FfmpegJob.h"
+#include "JobProtocol.h"
+#include "JobScheduler.h"
+#include "ProcessStats.h"
+#include "SyntheticMedia.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QThread>
+#include <QTimer>
+#include <algorithm>
+#include <cmath>
+
+using SyntheticMedia::ClipSpec;
+using SyntheticMedia::Distortion;
+
+// How often the running ffmpeg is sampled for CPU time and peak RSS
+static constexpr int SampleIntervalMs = 50;
+
+struct RunStats {
+    bool success = false;
+    double wallSeconds = 0;
+    double cpuSeconds = -1;   // -1: not available on this platform
+    qint64 peakRssKiB = -1;
+    QJsonArray scores;
+};
+
+// proxySize: score in FfmpegJob's proxy mode (with VMAF) at this size; invalid for full resolution
+static RunStats runComparison(const QString& reference, const QStringList& distorted,
+                              const QSize& proxySize, bool verbose) {
+    RunStats stats;
+    FfmpegJob job;
+    if (proxySize.isValid()) job.setProxyMode(true, proxySize, true);
+    QEventLoop loop;
+    QTimer sampler;
+    qint64 pid = 0;
+
+    QObject::connect(&job, &FfmpegJob::processStarted, [&](qint64 startedPid) {
+        pid = startedPid;
+        sampler.start(SampleIntervalMs);
+    });
+    QObject::connect(&sampler, &QTimer::timeout, [&]() {
+        // VmHWM is itself a peak, so sampling only misses growth in the final interval
+        ProcessStats::Sample sample;
+        if (!ProcessStats::sample(pid, sample)) return;
+        stats.cpuSeconds = sample.cpuSeconds;
+        stats.peakRssKiB = sample.peakRssKiB;
+    });
+    QObject::connect(&job, &FfmpegJob::comparisonResult, [&](int, const ComparisonResult& r) {
+        stats.scores.append(JobProtocol::toJson(r));
+    });
+    if (verbose) {
+        QObject::connect(&job, &FfmpegJob::logLine, [](const QString& line) {
+            qInfo().noquote() << line.trimmed();
+        });
+    }
+    QObject::connect(&job, &FfmpegJob::finished, [&](bool success, int) {
+        sampler.stop();
+        stats.success = success;
+        loop.quit();
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    job.startMulti(reference, distorted);
+    loop.exec();
+    stats.wallSeconds = timer.nsecsElapsed() / 1e9;
+    return stats;
+}
+
+static double pearson(const QVector<double>& a, const QVector<double>& b) {
+    const int n = a.size();
+    if (n < 3) return qQNaN();
+    double ma = 0, mb = 0;
+    for (int i = 0; i < n; ++i) { ma += a[i]; mb += b[i]; }
+    ma /= n;
+    mb /= n;
+    double cov = 0, va = 0, vb = 0;
+    for (int i = 0; i < n; ++i) {
+        cov += (a[i] - ma) * (b[i] - mb);
+        va  += (a[i] - ma) * (a[i] - ma);
+        vb  += (b[i] - mb) * (b[i] - mb);
+    }
+    return va > 0 && vb > 0 ? cov / std::sqrt(va * vb) : qQNaN();
+}
+
+// How well proxy-mode scores track full-resolution ones over the same clips.
+// full/proxy map "<clip>/<distortion>" to the first run's result and wall time.
+static QJsonObject proxyCorrelation(const QMap<QString, QPair<ComparisonResult, double>>& full,
+                                    const QMap<QString, QPair<ComparisonResult, double>>& proxy,
+                                    const QSize& proxySize) {
+    QVector<double> fullValues[3], proxyValues[3];
+    QVector<double> speedups;
+    for (auto it = full.cbegin(); it != full.cend(); ++it) {
+        if (!proxy.contains(it.key())) continue;
+        const ComparisonResult& f = it.value().first;
+        const ComparisonResult& p = proxy[it.key()].first;
+        if (f.hasSsim && p.hasSsim) { fullValues[0] << f.ssim.all; proxyValues[0] << p.ssim.all; }
+        // Identical frames give inf PSNR, which has no place in a correlation
+        bool finiteF = false, finiteP = false;
+        const double psnrF = f.psnr.avgDb.toDouble(&finiteF), psnrP = p.psnr.avgDb.toDouble(&finiteP);
+        if (f.hasPsnr && p.hasPsnr && finiteF && finiteP) { fullValues[1] << psnrF; proxyValues[1] << psnrP; }
+        if (f.hasVmaf && p.hasVmaf) { fullValues[2] << f.vmaf; proxyValues[2] << p.vmaf; }
+        if (proxy[it.key()].second > 0) speedups << it.value().second / proxy[it.key()].second;
+    }
+
+    QJsonObject report{{"proxySize", QString("%1x%2").arg(proxySize.width()).arg(proxySize.height())},
+                       {"pairs", speedups.size()}};
+    const char *names[3] = {"ssim", "psnr", "vmaf"};
+    for (int m = 0; m < 3; ++m) {
+        double absDiff = 0;
+        for (int i = 0; i < fullValues[m].size(); ++i) absDiff += qAbs(fullValues[m][i] - proxyValues[m][i]);
+        const double r = pearson(fullValues[m], proxyValues[m]);
+        QJsonObject metric{{"pairs", fullValues[m].size()}};
+        if (!qIsNaN(r)) metric["pearson"] = r;
+        if (!fullValues[m].isEmpty()) metric["meanAbsDiff"] = absDiff / fullValues[m].size();
+        report[names[m]] = metric;
+    }
+    if (!speedups.isEmpty()) {
+        std::sort(speedups.begin(), speedups.end());
+        report["medianSpeedup"] = speedups[speedups.size() / 2];
+    }
+    return report;
+}
+
+static QString ffmpegVersion() {
+    QProcess process;
+    process.start("ffmpeg", {"-hide_banner", "-version"});
+    if (!process.waitForFinished(10000)) return QString();
+    return QString::fromLocal8Bit(process.readAllStandardOutput()).section('\n', 0, 0).trimmed();
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    // Separate settings from the GUI so the benchmark's thread budget never leaks into it
+    QCoreApplication::setOrganizationName("VidMetric");
+    QCoreApplication::setApplicationName("VidMetricBench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("VidMetric comparison pipeline benchmark");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"resolutions", "Comma-separated WxH list. Default: 640x360,1280x720,1920x1080", "list",
+         "640x360,1280x720,1920x1080"},
+        {"bit-depths", "Comma-separated bit depths (8, 10). Default: 8,10", "list", "8,10"},
+        {"frames", "Frames per clip. Default: 120", "n", "120"},
+        {"fps", "Clip frame rate. Default: 30", "n", "30"},
+        {"distortions", "Comma-separated subset of noise,blur,downscale,compress. Default: all", "list",
+         "noise,blur,downscale,compress"},
+        {"engines", "single (one ffmpeg run per distorted clip), multi (all clips against one "
+                    "reference decode), proxy (like single, in proxy mode). With single and proxy, "
+                    "the report includes their score correlation. Default: single,multi,proxy", "list",
+         "single,multi,proxy"},
+        {"proxy-size", "Proxy resolution for the proxy engine. Default: 640x360", "WxH", "640x360"},
+        {"repeat", "Runs per case; report every run. Default: 1", "n", "1"},
+        {"threads", "Thread budget. Default: all logical CPUs", "n"},
+        {"work-dir", "Where synthetic clips are generated and reused between runs", "dir"},
+        {"output", "Write the JSON report here instead of stdout", "file"},
+        {"verbose", "Echo ffmpeg output to stderr"},
+    });
+    parser.process(app);
+
+    const QString workDir = parser.isSet("work-dir")
+        ? parser.value("work-dir")
+        : QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/bench-media";
+    const int frames  = qMax(1, parser.value("frames").toInt());
+    const int fps     = qMax(1, parser.value("fps").toInt());
+    const int repeat  = qMax(1, parser.value("repeat").toInt());
+    const int threads = parser.isSet("threads") ? qMax(1, parser.value("threads").toInt())
+                                                : QThread::idealThreadCount();
+    const bool verbose = parser.isSet("verbose");
+    JobScheduler::instance()->setThreadBudget(threads);
+
+    QList<Distortion> distortions;
+    for (const QString& name : parser.value("distortions").split(',', Qt::SkipEmptyParts)) {
+        Distortion d;
+        if (!SyntheticMedia::distortionFromName(name.trimmed(), d)) {
+            qCritical().noquote() << "Unknown distortion:" << name;
+            return 2;
+        }
+        distortions << d;
+    }
+    const QStringList engines = parser.value("engines").split(',', Qt::SkipEmptyParts);
+    for (const QString& engine : engines) {
+        if (engine != "single" && engine != "multi" && engine != "proxy") {
+            qCritical().noquote() << "Unknown engine:" << engine;
+            return 2;
+        }
+    }
+
+    const QStringList proxyWh = parser.value("proxy-size").split('x');
+    const QSize proxySize(proxyWh.value(0).toInt(), proxyWh.value(1).toInt());
+    if (engines.contains("proxy") && proxySize.isEmpty()) {
+        qCritical().noquote() << "Bad proxy size:" << parser.value("proxy-size");
+        return 2;
+    }
+
+    QList<ClipSpec> clips;
+    for (const QString& resolution : parser.value("resolutions").split(',', Qt::SkipEmptyParts)) {
+        const QStringList wh = resolution.trimmed().split('x');
+        for (const QString& depth : parser.value("bit-depths").split(',', Qt::SkipEmptyParts)) {
+            ClipSpec spec;
+            spec.width    = wh.value(0).toInt();
+            spec.height   = wh.value(1).toInt();
+            spec.bitDepth = depth.trimmed().toInt();
+            spec.frames   = frames;
+            spec.fps      = fps;
+            if (spec.width <= 0 || spec.height <= 0 || (spec.bitDepth != 8 && spec.bitDepth != 10)) {
+                qCritical().noquote() << "Bad clip spec:" << resolution << depth;
+                return 2;
+            }
+            clips << spec;
+        }
+    }
+
+    QJsonArray results;
+    bool allOk = true;
+    QMap<QString, QPair<ComparisonResult, double>> fullScores, proxyScores;
+
+    for (const ClipSpec& spec : std::as_const(clips)) {
+        const QString label = QString("%1x%2 %3-bit").arg(spec.width).arg(spec.height).arg(spec.bitDepth);
+        qInfo().noquote() << "Generating" << label << "clips in" << workDir;
+
+        QString reference, error;
+        if (!SyntheticMedia::generateReference(spec, workDir, &reference, &error)) {
+            qCritical().noquote() << "Reference generation failed:" << error;
+            return 1;
+        }
+        QStringList distorted;
+        QStringList names;
+        for (Distortion d : std::as_const(distortions)) {
+            QString path;
+            if (!SyntheticMedia::generateDistorted(spec, reference, d, workDir, &path, &error)) {
+                qCritical().noquote() << "Generating" << SyntheticMedia::distortionName(d) << "failed:" << error;
+                return 1;
+            }
+            distorted << path;
+            names << SyntheticMedia::distortionName(d);
+        }
+
+        // Each case is one ffmpeg invocation: a list of distorted inputs and their names
+        QList<QPair<QString, QList<int>>> cases;
+        for (const QString& engine : engines) {
+            if (engine == "single" || engine == "proxy") {
+                for (int i = 0; i < distorted.size(); ++i) cases.append({engine, {i}});
+            } else {
+                QList<int> all;
+                for (int i = 0; i < distorted.size(); ++i) all << i;
+                cases.append({engine, all});
+            }
+        }
+
+        for (const auto& c : std::as_const(cases)) {
+            QStringList inputs, inputNames;
+            for (int i : c.second) {
+                inputs << distorted[i];
+                inputNames << names[i];
+            }
+            for (int run = 0; run < repeat; ++run) {
+                qInfo().noquote() << QString("  %1 [%2] run %3/%4")
+                                     .arg(c.first, inputNames.join(",")).arg(run + 1).arg(repeat);
+                const bool proxy = c.first == "proxy";
+                const RunStats stats = runComparison(reference, inputs, proxy ? proxySize : QSize(), verbose);
+                allOk = allOk && stats.success;
+
+                if (run == 0 && stats.success && !stats.scores.isEmpty() && c.first != "multi") {
+                    auto& scores = proxy ? proxyScores : fullScores;
+                    scores.insert(label + "/" + inputNames.first(),
+                                  {JobProtocol::comparisonFromJson(stats.scores.first().toObject()),
+                                   stats.wallSeconds});
+                }
+
+                QJsonObject entry{
+                    {"clip", QJsonObject{{"width", spec.width}, {"height", spec.height},
+                                         {"bitDepth", spec.bitDepth}, {"frames", spec.frames},
+                                         {"fps", spec.fps}}},
+                    {"engine", c.first},
+                    {"distortions", QJsonArray::fromStringList(inputNames)},
+                    {"run", run},
+                    {"success", stats.success},
+                    {"wallSeconds", stats.wallSeconds},
+                    // Reference frames scored per second, whatever the number of distorted inputs
+                    {"fps", stats.wallSeconds > 0 ? spec.frames / stats.wallSeconds : 0.0},
+                    {"comparisonsPerSecond", stats.wallSeconds > 0
+                         ? spec.frames * inputs.size() / stats.wallSeconds : 0.0},
+                    {"scores", stats.scores},
+                };
+                if (stats.cpuSeconds >= 0) entry["cpuSeconds"] = stats.cpuSeconds;
+                if (stats.peakRssKiB >= 0) entry["peakRssKiB"] = stats.peakRssKiB;
+                results.append(entry);
+                qInfo().noquote() << QString("    %1 s, %2 fps%3")
+                                     .arg(stats.wallSeconds, 0, 'f', 2)
+                                     .arg(entry["fps"].toDouble(), 0, 'f', 1)
+                                     .arg(stats.success ? QString() : QString(" (FAILED)"));
+            }
+        }
+    }
+
+    QJsonObject report{
+        {"tool", "vidmetric-bench"},
+        {"timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate)},
+        {"host", QJsonObject{{"os", QSysInfo::prettyProductName()},
+                             {"cpuArchitecture", QSysInfo::currentCpuArchitecture()},
+                             {"logicalCpus", QThread::idealThreadCount()},
+                             {"ffmpeg", ffmpegVersion()}}},
+        {"threadBudget", threads},
+        {"results", results},
+    };
+    if (!fullScores.isEmpty() && !proxyScores.isEmpty())
+        report["proxyCorrelation"] = proxyCorrelation(fullScores, proxyScores, proxySize);
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet("output")) {
+        QFile file(parser.value("output"));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical().noquote() << "Cannot write" << file.fileName() << ":" << file.errorString();
+            return 1;
+        }
+        file.write(json);
+    } else {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+    }
+    return allOk ? 0 : 1;
+}
@@ -1,24 +1,50 @@
 #include "AbAv1Job.h"
+#include "JobScheduler.h"
+#include "ProcessSupervisor.h"
+#include <QFileInfo>
 #include <QRegularExpression>
 
 AbAv1Job::AbAv1Job(QObject *parent) : QObject(parent) {}
 
 AbAv1Job::~AbAv1Job() {
+    if (m_ticket) JobScheduler::instance()->withdraw(m_ticket);
     if (m_process) {
-        m_process->kill();
+        m_process->disconnect(this);
+        ProcessSupervisor::killTree(m_process);
         m_process->waitForFinished();
         delete m_process;
     }
+    releaseTicket();
 }
 
 bool AbAv1Job::isRunning() const {
-    return m_process && m_process->state() != QProcess::NotRunning;
+    return m_remoteActive
+        || (m_process && m_process->state() != QProcess::NotRunning)
+        || (m_ticket && JobScheduler::instance()->isQueued(m_ticket));
 }
 
 void AbAv1Job::cancel() {
+    if (m_remoteActive) {
+        emit logLine("\nCancelling remote job...");
+        if (m_remote && m_remoteJobId) m_remote->call("cancel", {{"jobId", m_remoteJobId}});
+        return;
+    }
+    if (m_ticket && JobScheduler::instance()->withdraw(m_ticket)) {
+        m_ticket = 0;
+        emit logLine("\nCancelled before start.");
+        emit finished(false, -1);
+        return;
+    }
     if (m_process && m_process->state() != QProcess::NotRunning) {
         emit logLine("\nCancelling process...");
-        m_process->kill();
+        ProcessSupervisor::killTree(m_process);
+    }
+}
+
+void AbAv1Job::releaseTicket() {
+    if (m_ticket) {
+        JobScheduler::instance()->release(m_ticket);
+        m_ticket = 0;
     }
 }
 
@@ -28,8 +54,93 @@ void AbAv1Job::start(const QString& inputFile, const QString& encoder, const QSt
         m_process->deleteLater();
         m_process = nullptr;
     }
+    if (m_ticket && JobScheduler::instance()->withdraw(m_ticket)) m_ticket = 0;
+    releaseTicket();
+
+    m_inputFile = inputFile;
+    m_encoder   = encoder;
+    m_preset    = preset;
+    m_minVmaf   = minVmaf;
+    m_samples   = samples;
+
+    if (m_remote && m_remote->isConnected()) {
+        startRemote();
+        return;
+    }
+
+    JobScheduler *scheduler = JobScheduler::instance();
+    m_ticket = scheduler->submit("CRF search: " + QFileInfo(inputFile).fileName(),
+                                 m_priority, m_threads,
+                                 [this](int threads) { launch(threads); });
+    if (scheduler->isQueued(m_ticket) && scheduler->runningCount() > 0)
+        emit logLine(QString("Queued behind %1 running job(s)...").arg(scheduler->runningCount()));
+}
+
+void AbAv1Job::setRemote(JobClient *client) {
+    if (m_remote) m_remote->disconnect(this);
+    m_remote = client;
+    if (!client) return;
+
+    connect(client, &JobClient::notification, this, &AbAv1Job::handleRemoteNotification);
+    connect(client, &JobClient::disconnected, this, [this]() {
+        if (!m_remoteActive) return;
+        m_remoteActive = false;
+        m_remoteJobId  = 0;
+        emit logLine("Lost connection to the job server.");
+        emit finished(false, -1);
+    });
+}
+
+void AbAv1Job::startRemote() {
+    m_remoteActive = true;
+    m_remoteJobId  = 0;
+    emit logLine("Submitting CRF search to job server " + m_remote->address() + "...");
+
+    const QJsonObject params{
+        {"input",   m_inputFile},  {"encoder", m_encoder}, {"preset",   m_preset},
+        {"minVmaf", m_minVmaf},    {"samples", m_samples},
+        {"priority", m_priority},  {"threads", m_threads}
+    };
+    QPointer<AbAv1Job> self(this);
+    m_remote->call("crfSearch", params, [self](const QJsonValue& result, const QString& error) {
+        if (!self) return;
+        if (!error.isEmpty()) {
+            self->m_remoteActive = false;
+            emit self->logLine("Job server error: " + error);
+            emit self->finished(false, -1);
+            return;
+        }
+        self->m_remoteJobId = result.toObject().value("jobId").toInt();
+    });
+}
+
+// Replays the server's notifications for our job through the usual signals
+void AbAv1Job::handleRemoteNotification(const QString& method, const QJsonObject& params) {
+    if (!m_remoteActive || params.value("jobId").toInt() != m_remoteJobId) return;
+
+    if (method == "job.log") {
+        emit logLine(params.value("line").toString());
+    } else if (method == "job.progress") {
+        const int total = params.value("total").toInt();
+        if (total > 0) emit progressUpdated(params.value("current").toInt(), total);
+    } else if (method == "job.prediction") {
+        emit resultReady(params.value("crf").toString(), params.value("vmaf").toDouble(),
+                         params.value("size").toString(), params.value("time").toString());
+    } else if (method == "job.finished") {
+        m_remoteActive = false;
+        m_remoteJobId  = 0;
+        emit finished(params.value("success").toBool(), params.value("exitCode").toInt());
+    }
+}
 
+void AbAv1Job::launch(int threads) {
     m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    m_cpuSeconds = -1;
+    m_peakRssKiB = -1;
+    connect(m_supervisor, &ProcessSupervisor::timeoutExpired, this, [this](const QString& reason) {
+        emit logLine("Stopping ab-av1 and its encoders: " + reason);
+    });
 
     connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
         handleOutput(m_process->readAllStandardOutput());
@@ -40,17 +151,31 @@ void AbAv1Job::start(const QString& inputFile, const QString& encoder, const QSt
     connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, [this](int exitCode, QProcess::ExitStatus status) {
         bool success = (status == QProcess::NormalExit && exitCode == 0);
-        emit finished(success, exitCode);
+        // Covers ab-av1 and every ffmpeg it ran
+        m_cpuSeconds = m_supervisor->cpuSeconds();
+        m_peakRssKiB = m_supervisor->peakRssKiB();
+        if (m_cpuSeconds >= 0)
+            emit logLine(QString("Resources: %1 s CPU, peak memory %2 MiB (ab-av1 and its encoders)")
+                             .arg(m_cpuSeconds, 0, 'f', 1).arg(m_peakRssKiB / 1024.0, 0, 'f', 0));
+        // Detach first: a finished() handler may immediately start() the next run
         m_process->deleteLater();
         m_process = nullptr;
+        releaseTicket();
+        emit finished(success, exitCode);
     });
 
+    const QString threadArg = QString::number(threads);
     QStringList args;
-    args << "crf-search" << "-i" << inputFile
-         << "--encoder" << encoder
-         << "--preset" << preset
-         << "--min-vmaf" << QString::number(minVmaf)
-         << "--samples" << QString::number(samples);
+    args << "crf-search" << "-i" << m_inputFile
+         << "--encoder" << m_encoder
+         << "--preset" << m_preset
+         << "--min-vmaf" << QString::number(m_minVmaf)
+         << "--samples" << QString::number(m_samples);
+
+    // Pass the granted budget to both the sample encodes and the VMAF scoring
+    if (m_encoder == "libsvtav1") args << "--svt" << "lp=" + threadArg;
+    else                          args << "--enc" << "threads=" + threadArg;
+    args << "--vmaf" << "n_threads=" + threadArg;
 
     emit logLine("Executing: ab-av1 " + args.join(" "));
     emit logLine("--------------------------------------------------");
@@ -58,10 +183,13 @@ void AbAv1Job::start(const QString& inputFile, const QString& encoder, const QSt
     m_process->start("ab-av1", args);
     if (!m_process->waitForStarted()) {
         emit logLine("Error: Failed to start ab-av1. Ensure it is in your PATH.");
-        emit finished(false, -1);
         m_process->deleteLater();
         m_process = nullptr;
+        releaseTicket();
+        emit finished(false, -1);
+        return;
     }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
 }
 
 void AbAv1Job::handleOutput(const QByteArray& data) {
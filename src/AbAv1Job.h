@@ -4,6 +4,11 @@
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <QJsonObject>
+#include <QPointer>
+#include "JobClient.h"
+
+class ProcessSupervisor;
 
 // Encapsulates running an ab-av1 crf-search as a background process.
 // The tab connects to the signals to drive UI updates; it never touches QProcess directly.
@@ -14,11 +19,24 @@ public:
     explicit AbAv1Job(QObject *parent = nullptr);
     ~AbAv1Job();
 
+    // The job is queued on the JobScheduler and launched when its thread budget allows.
     void start(const QString& inputFile, const QString& encoder, const QString& preset,
                double minVmaf, int samples);
+    // Kills ab-av1 together with the ffmpeg processes it spawned
     void cancel();
+    // True while queued or running
     bool isRunning() const;
 
+    // Scheduling parameters for the next start(); threads <= 0 asks for the whole budget
+    void setPriority(int priority) { m_priority = priority; }
+    void setThreads(int threads) { m_threads = threads; }
+    // Runs subsequent start() calls on a JobServer instead of locally; nullptr runs locally
+    void setRemote(JobClient *client);
+    bool isRemote() const { return m_remote && m_remote->isConnected(); }
+    // CPU time and peak memory of the last local run's whole process tree; -1 if unknown
+    double cpuSeconds() const { return m_cpuSeconds; }
+    qint64 peakRssKiB() const { return m_peakRssKiB; }
+
 signals:
     // Raw text line from the process (stdout or stderr)
     void logLine(const QString& line);
@@ -30,9 +48,27 @@ signals:
     void finished(bool success, int exitCode);
 
 private:
+    void launch(int threads);
+    void releaseTicket();
+    void startRemote();
+    void handleRemoteNotification(const QString& method, const QJsonObject& params);
     void handleOutput(const QByteArray& data);
 
     QProcess *m_process = nullptr;
+    QPointer<ProcessSupervisor> m_supervisor;   // owned by m_process
+    double m_cpuSeconds = -1;
+    qint64 m_peakRssKiB = -1;
+    int m_ticket   = 0;
+    int m_priority = 1;   // JobScheduler::Normal
+    int m_threads  = 0;
+
+    QPointer<JobClient> m_remote;
+    bool m_remoteActive = false;
+    int m_remoteJobId   = 0;
+
+    QString m_inputFile, m_encoder, m_preset;
+    double m_minVmaf = 95.0;
+    int m_samples = 4;
 };
 
 #endif // ABAV1JOB_H
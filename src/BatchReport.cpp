@@ -0,0 +1,339 @@
+#include "BatchReport.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+ReportSample::ReportSample() : vmaf(NaN), psnr(NaN), ssim(NaN) {}
+
+BdDeltas::BdDeltas() : ratePsnr(NaN), rateVmaf(NaN), psnr(NaN), vmaf(NaN) {}
+
+bool ReportSample::fromHistory(const QStringList& fields, ReportSample& sample) {
+    if (fields.size() < 4) return false;
+    sample = ReportSample();
+    sample.time    = fields[0];
+    sample.type    = fields[1];
+    sample.details = fields[2];
+
+    // Single-file entries carry the label text ("SSIM: Overall: 0.98 (17 dB)", "PSNR: Avg: 42 dB"),
+    // multi-file ones the bare values ("SSIM: 0.98", "PSNR: 42 dB")
+    // (the lookbehind keeps "MS-SSIM: 0.99" from the extra metrics out of SSIM)
+    static QRegularExpression ssimRx(R"((?<![\w-])SSIM:\s*(?:Overall:\s*)?([\d.]+))");
+    static QRegularExpression psnrRx(R"(PSNR:\s*(?:Avg:\s*)?([\d.]+))");
+    static QRegularExpression vmafRx(R"(VMAF(?: Score)?:\s*([\d.]+))");
+    static QRegularExpression bitrateRx(R"(Bitrate:\s*([\d.]+)\s*kbps)");
+    const QString& result = fields[3];
+    QRegularExpressionMatch m;
+    if ((m = ssimRx.match(result)).hasMatch()) sample.ssim = m.captured(1).toDouble();
+    // "PSNR: ∞" (identical files) has no finite value and is left out
+    if ((m = psnrRx.match(result)).hasMatch()) sample.psnr = m.captured(1).toDouble();
+    if ((m = vmafRx.match(result)).hasMatch()) sample.vmaf = m.captured(1).toDouble();
+    if ((m = bitrateRx.match(result)).hasMatch()) sample.bitrateKbps = m.captured(1).toDouble();
+    return !std::isnan(sample.ssim) || !std::isnan(sample.psnr) || !std::isnan(sample.vmaf);
+}
+
+namespace ReportMath {
+
+double percentile(const QVector<double>& sorted, double p) {
+    if (sorted.isEmpty()) return NaN;
+    const double rank = p * (sorted.size() - 1);
+    const int lower = int(std::floor(rank));
+    const int upper = qMin(lower + 1, int(sorted.size()) - 1);
+    return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+MetricSummary summarize(QVector<double> values) {
+    values.erase(std::remove_if(values.begin(), values.end(), [](double v) { return !std::isfinite(v); }),
+                 values.end());
+    MetricSummary s;
+    s.count = int(values.size());
+    if (values.isEmpty()) return s;
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double v : std::as_const(values)) sum += v;
+    s.mean   = sum / values.size();
+    s.min    = values.first();
+    s.max    = values.last();
+    s.p5     = percentile(values, 0.05);
+    s.p25    = percentile(values, 0.25);
+    s.median = percentile(values, 0.50);
+    s.p75    = percentile(values, 0.75);
+    s.p95    = percentile(values, 0.95);
+    return s;
+}
+
+QVector<double> polyfit(const QVector<double>& x, const QVector<double>& y, int degree) {
+    const int n = degree + 1;
+    if (degree < 0 || x.size() != y.size() || x.size() < n) return {};
+    // Normal equations A c = b, solved by Gaussian elimination with partial pivoting
+    QVector<QVector<double>> a(n, QVector<double>(n + 1, 0.0));
+    for (int i = 0; i < x.size(); ++i) {
+        QVector<double> powers(2 * n, 1.0);
+        for (int k = 1; k < 2 * n; ++k) powers[k] = powers[k - 1] * x[i];
+        for (int r = 0; r < n; ++r) {
+            for (int c = 0; c < n; ++c) a[r][c] += powers[r + c];
+            a[r][n] += powers[r] * y[i];
+        }
+    }
+    for (int col = 0; col < n; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < n; ++r)
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+        if (std::abs(a[pivot][col]) < 1e-12) return {};
+        std::swap(a[col], a[pivot]);
+        for (int r = 0; r < n; ++r) {
+            if (r == col) continue;
+            const double f = a[r][col] / a[col][col];
+            for (int c = col; c <= n; ++c) a[r][c] -= f * a[col][c];
+        }
+    }
+    QVector<double> coefficients(n);
+    for (int i = 0; i < n; ++i) coefficients[i] = a[i][n] / a[i][i];
+    return coefficients;
+}
+
+double polyIntegral(const QVector<double>& coefficients, double from, double to) {
+    double result = 0;
+    for (int k = 0; k < coefficients.size(); ++k)
+        result += coefficients[k] / (k + 1) * (std::pow(to, k + 1) - std::pow(from, k + 1));
+    return result;
+}
+
+// Average vertical distance between two fitted curves over the overlap of their x ranges
+static double averageGap(const QVector<double>& xA, const QVector<double>& yA,
+                         const QVector<double>& xB, const QVector<double>& yB) {
+    if (xA.size() < 2 || xB.size() < 2) return NaN;
+    const double lo = qMax(*std::min_element(xA.begin(), xA.end()), *std::min_element(xB.begin(), xB.end()));
+    const double hi = qMin(*std::max_element(xA.begin(), xA.end()), *std::max_element(xB.begin(), xB.end()));
+    if (hi <= lo) return NaN;
+    // Fit on x mapped to [0, 1] over the overlap; keeps the cubic's normal equations well conditioned
+    auto normalize = [lo, hi](QVector<double> x) {
+        for (double& v : x) v = (v - lo) / (hi - lo);
+        return x;
+    };
+    const QVector<double> fitA = polyfit(normalize(xA), yA, qMin(3, int(xA.size()) - 1));
+    const QVector<double> fitB = polyfit(normalize(xB), yB, qMin(3, int(xB.size()) - 1));
+    if (fitA.isEmpty() || fitB.isEmpty()) return NaN;
+    return polyIntegral(fitB, 0, 1) - polyIntegral(fitA, 0, 1);
+}
+
+// Bjontegaard: log-rate as a function of quality, integrated over the common quality range
+double bdRate(const QVector<QPointF>& anchor, const QVector<QPointF>& test) {
+    QVector<double> qA, rA, qB, rB;
+    for (const QPointF& p : anchor) if (p.x() > 0 && std::isfinite(p.y())) { qA << p.y(); rA << std::log10(p.x()); }
+    for (const QPointF& p : test)   if (p.x() > 0 && std::isfinite(p.y())) { qB << p.y(); rB << std::log10(p.x()); }
+    const double gap = averageGap(qA, rA, qB, rB);
+    return std::isnan(gap) ? NaN : (std::pow(10.0, gap) - 1.0) * 100.0;
+}
+
+// Quality as a function of log-rate, integrated over the common rate range
+double bdQuality(const QVector<QPointF>& anchor, const QVector<QPointF>& test) {
+    QVector<double> rA, qA, rB, qB;
+    for (const QPointF& p : anchor) if (p.x() > 0 && std::isfinite(p.y())) { rA << std::log10(p.x()); qA << p.y(); }
+    for (const QPointF& p : test)   if (p.x() > 0 && std::isfinite(p.y())) { rB << std::log10(p.x()); qB << p.y(); }
+    return averageGap(rA, qA, rB, qB);
+}
+
+} // namespace ReportMath
+
+static void summarizeGroup(ReportGroup& group) {
+    QVector<double> vmaf, psnr, ssim, bitrate;
+    for (const ReportSample& s : std::as_const(group.samples)) {
+        vmaf << s.vmaf;
+        psnr << s.psnr;
+        ssim << s.ssim;
+        bitrate << (s.bitrateKbps > 0 ? s.bitrateKbps : NaN);
+    }
+    group.vmaf    = ReportMath::summarize(vmaf);
+    group.psnr    = ReportMath::summarize(psnr);
+    group.ssim    = ReportMath::summarize(ssim);
+    group.bitrate = ReportMath::summarize(bitrate);
+}
+
+static QVector<QPointF> curve(const ReportGroup& group, double ReportSample::*metric) {
+    QVector<QPointF> points;
+    for (const ReportSample& s : group.samples)
+        if (s.bitrateKbps > 0 && std::isfinite(s.*metric)) points << QPointF(s.bitrateKbps, s.*metric);
+    std::sort(points.begin(), points.end(), [](const QPointF& a, const QPointF& b) { return a.x() < b.x(); });
+    return points;
+}
+
+BatchReport BatchReport::build(const QList<QStringList>& historyRows,
+                               const QString& configA, const QString& configB) {
+    BatchReport report;
+    report.created = QDateTime::currentDateTime().toString(Qt::ISODate);
+    report.entries = int(historyRows.size());
+    report.all.name = "All";
+    report.configA = configA;
+    report.configB = configB;
+    report.groupA.name = configA;
+    report.groupB.name = configB;
+
+    ReportSample sample;
+    for (const QStringList& fields : historyRows) {
+        if (!ReportSample::fromHistory(fields, sample)) {
+            ++report.skipped;
+            continue;
+        }
+        report.all.samples << sample;
+        if (!report.hasComparison()) continue;
+        if (sample.details.contains(configA, Qt::CaseInsensitive)) report.groupA.samples << sample;
+        else if (sample.details.contains(configB, Qt::CaseInsensitive)) report.groupB.samples << sample;
+    }
+    summarizeGroup(report.all);
+
+    if (report.hasComparison()) {
+        summarizeGroup(report.groupA);
+        summarizeGroup(report.groupB);
+        const QVector<QPointF> psnrA = curve(report.groupA, &ReportSample::psnr);
+        const QVector<QPointF> psnrB = curve(report.groupB, &ReportSample::psnr);
+        const QVector<QPointF> vmafA = curve(report.groupA, &ReportSample::vmaf);
+        const QVector<QPointF> vmafB = curve(report.groupB, &ReportSample::vmaf);
+        report.bd.ratePsnr = ReportMath::bdRate(psnrA, psnrB);
+        report.bd.psnr     = ReportMath::bdQuality(psnrA, psnrB);
+        report.bd.rateVmaf = ReportMath::bdRate(vmafA, vmafB);
+        report.bd.vmaf     = ReportMath::bdQuality(vmafA, vmafB);
+    }
+    return report;
+}
+
+// --- JSON ---
+
+static QJsonValue number(double v) {
+    return std::isfinite(v) ? QJsonValue(v) : QJsonValue(QJsonValue::Null);
+}
+
+static QJsonObject toJson(const MetricSummary& s) {
+    if (s.count == 0) return QJsonObject{{"count", 0}};
+    return {{"count", s.count}, {"mean", s.mean}, {"min", s.min}, {"max", s.max},
+            {"p5", s.p5}, {"p25", s.p25}, {"median", s.median}, {"p75", s.p75}, {"p95", s.p95}};
+}
+
+static QJsonObject toJson(const ReportGroup& g, bool withSamples) {
+    QJsonObject o{{"name", g.name}, {"count", int(g.samples.size())},
+                  {"vmaf", toJson(g.vmaf)}, {"psnr", toJson(g.psnr)}, {"ssim", toJson(g.ssim)},
+                  {"bitrateKbps", toJson(g.bitrate)}};
+    if (withSamples) {
+        QJsonArray samples;
+        for (const ReportSample& s : g.samples)
+            samples.append(QJsonObject{{"time", s.time}, {"type", s.type}, {"details", s.details},
+                                       {"vmaf", number(s.vmaf)}, {"psnr", number(s.psnr)},
+                                       {"ssim", number(s.ssim)},
+                                       {"bitrateKbps", s.bitrateKbps > 0 ? number(s.bitrateKbps) : QJsonValue()}});
+        o["samples"] = samples;
+    }
+    return o;
+}
+
+QJsonObject BatchReport::toJson() const {
+    QJsonObject o{{"created", created}, {"entries", entries}, {"skipped", skipped},
+                  {"all", ::toJson(all, true)}};
+    if (hasComparison()) {
+        o["comparison"] = QJsonObject{
+            {"a", ::toJson(groupA, false)}, {"b", ::toJson(groupB, false)},
+            {"bdRatePsnr", number(bd.ratePsnr)}, {"bdRateVmaf", number(bd.rateVmaf)},
+            {"bdPsnr", number(bd.psnr)}, {"bdVmaf", number(bd.vmaf)}};
+    }
+    return o;
+}
+
+// --- HTML ---
+
+static QString cell(double v, int decimals) {
+    return std::isfinite(v) ? QString::number(v, 'f', decimals) : QString("&ndash;");
+}
+
+static QString summaryRow(const QString& name, const MetricSummary& s, int decimals) {
+    if (s.count == 0) return QString("<tr><th>%1</th><td colspan=\"9\">not measured</td></tr>").arg(name);
+    return QString("<tr><th>%1</th><td>%2</td><td>%3</td><td>%4</td><td>%5</td><td>%6</td>"
+                   "<td>%7</td><td>%8</td><td>%9</td><td>%10</td></tr>")
+        .arg(name).arg(s.count)
+        .arg(cell(s.mean, decimals), cell(s.min, decimals), cell(s.p5, decimals), cell(s.p25, decimals),
+             cell(s.median, decimals), cell(s.p75, decimals), cell(s.p95, decimals))
+        .arg(cell(s.max, decimals));
+}
+
+static QString summaryTable(const ReportGroup& g) {
+    QString html = QString("<h2>%1 (%2 results)</h2>\n<table>\n").arg(g.name.toHtmlEscaped()).arg(g.samples.size());
+    html += "<tr><th></th><th>n</th><th>mean</th><th>min</th><th>p5</th><th>p25</th>"
+            "<th>median</th><th>p75</th><th>p95</th><th>max</th></tr>\n";
+    html += summaryRow("VMAF", g.vmaf, 2) + "\n";
+    html += summaryRow("PSNR (dB)", g.psnr, 2) + "\n";
+    html += summaryRow("SSIM", g.ssim, 4) + "\n";
+    html += summaryRow("Bitrate (kbps)", g.bitrate, 0) + "\n";
+    return html + "</table>\n";
+}
+
+// Rate-VMAF curves of both configurations on a log-rate axis
+static QString rateQualityPlot(const ReportGroup& a, const ReportGroup& b) {
+    const QVector<QPointF> pa = curve(a, &ReportSample::vmaf), pb = curve(b, &ReportSample::vmaf);
+    if (pa.isEmpty() && pb.isEmpty()) return QString();
+    double rLo = 1e300, rHi = 0, qLo = 100, qHi = 0;
+    for (const QPointF& p : pa + pb) {
+        rLo = qMin(rLo, p.x()); rHi = qMax(rHi, p.x());
+        qLo = qMin(qLo, p.y()); qHi = qMax(qHi, p.y());
+    }
+    if (rHi <= rLo) rHi = rLo * 2;
+    if (qHi <= qLo) qHi = qLo + 1;
+    const int w = 640, h = 360, m = 40;
+    auto x = [&](double r) { return m + (std::log10(r) - std::log10(rLo)) / (std::log10(rHi) - std::log10(rLo)) * (w - 2 * m); };
+    auto y = [&](double q) { return h - m - (q - qLo) / (qHi - qLo) * (h - 2 * m); };
+    auto polyline = [&](const QVector<QPointF>& pts, const char *color) {
+        QStringList coords;
+        for (const QPointF& p : pts) coords << QString("%1,%2").arg(x(p.x()), 0, 'f', 1).arg(y(p.y()), 0, 'f', 1);
+        QString s = QString("<polyline fill=\"none\" stroke=\"%1\" stroke-width=\"2\" points=\"%2\"/>")
+                        .arg(color, coords.join(' '));
+        for (const QString& c : coords)
+            s += QString("<circle r=\"3\" fill=\"%1\" cx=\"%2\" cy=\"%3\"/>").arg(color, c.section(',', 0, 0), c.section(',', 1));
+        return s;
+    };
+    QString svg = QString("<svg width=\"%1\" height=\"%2\" xmlns=\"http://www.w3.org/2000/svg\">").arg(w).arg(h);
+    svg += QString("<rect x=\"%1\" y=\"%1\" width=\"%2\" height=\"%3\" fill=\"none\" stroke=\"#999\"/>")
+               .arg(m).arg(w - 2 * m).arg(h - 2 * m);
+    svg += QString("<text x=\"%1\" y=\"%2\" font-size=\"11\">%3 kbps</text>").arg(m).arg(h - 15).arg(rLo, 0, 'f', 0);
+    svg += QString("<text x=\"%1\" y=\"%2\" font-size=\"11\" text-anchor=\"end\">%3 kbps</text>")
+               .arg(w - m).arg(h - 15).arg(rHi, 0, 'f', 0);
+    svg += QString("<text x=\"5\" y=\"%1\" font-size=\"11\">%2</text>").arg(m).arg(qHi, 0, 'f', 1);
+    svg += QString("<text x=\"5\" y=\"%1\" font-size=\"11\">%2</text>").arg(h - m).arg(qLo, 0, 'f', 1);
+    svg += polyline(pa, "#1565c0") + polyline(pb, "#c62828");
+    svg += QString("<text x=\"%1\" y=\"20\" font-size=\"12\" fill=\"#1565c0\">A: %2</text>").arg(m).arg(a.name.toHtmlEscaped());
+    svg += QString("<text x=\"%1\" y=\"20\" font-size=\"12\" fill=\"#c62828\">B: %2</text>").arg(w / 2).arg(b.name.toHtmlEscaped());
+    return svg + "</svg>\n";
+}
+
+QString BatchReport::toHtml() const {
+    QString html = "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>Quality Report</title>\n"
+                   "<style>body{font-family:sans-serif;margin:2em}table{border-collapse:collapse;margin-bottom:1.5em}"
+                   "td,th{border:1px solid #ccc;padding:4px 8px;text-align:right}th{background:#f4f4f4}"
+                   "td.text{text-align:left}</style></head><body>\n";
+    html += QString("<h1>Quality Report</h1>\n<p>Created %1 from %2 history entries (%3 without metrics skipped).</p>\n")
+                .arg(created).arg(entries).arg(skipped);
+
+    if (hasComparison()) {
+        html += QString("<h2>B (%1) vs A (%2)</h2>\n<table>\n")
+                    .arg(configB.toHtmlEscaped(), configA.toHtmlEscaped());
+        html += QString("<tr><th>BD-rate (VMAF)</th><td>%1 %</td></tr>\n").arg(cell(bd.rateVmaf, 2));
+        html += QString("<tr><th>BD-rate (PSNR)</th><td>%1 %</td></tr>\n").arg(cell(bd.ratePsnr, 2));
+        html += QString("<tr><th>BD-VMAF</th><td>%1</td></tr>\n").arg(cell(bd.vmaf, 2));
+        html += QString("<tr><th>BD-PSNR</th><td>%1 dB</td></tr>\n").arg(cell(bd.psnr, 3));
+        html += "</table>\n<p>Negative BD-rate: B needs less bitrate than A for the same quality. "
+                "Needs at least two results with a bitrate per configuration, over overlapping ranges.</p>\n";
+        html += rateQualityPlot(groupA, groupB);
+        html += summaryTable(groupA) + summaryTable(groupB);
+    }
+    html += summaryTable(all);
+
+    html += "<h2>Results</h2>\n<table>\n<tr><th>Date/Time</th><th>Details</th><th>VMAF</th>"
+            "<th>PSNR (dB)</th><th>SSIM</th><th>Bitrate (kbps)</th></tr>\n";
+    for (const ReportSample& s : all.samples) {
+        html += QString("<tr><td class=\"text\">%1</td><td class=\"text\">%2</td><td>%3</td><td>%4</td>"
+                        "<td>%5</td><td>%6</td></tr>\n")
+                    .arg(s.time.toHtmlEscaped(), s.details.toHtmlEscaped(), cell(s.vmaf, 2), cell(s.psnr, 2),
+                         cell(s.ssim, 4), s.bitrateKbps > 0 ? cell(s.bitrateKbps, 0) : cell(NaN, 0));
+    }
+    return html + "</table>\n</body></html>\n";
+}
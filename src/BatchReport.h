@@ -0,0 +1,78 @@
+#ifndef BATCHREPORT_H
+#define BATCHREPORT_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QPointF>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// The numbers of one history entry ("SSIM: 0.98 | PSNR: 42.1 dB | VMAF: 93.2 |
+// Bitrate: 2400 kbps | ..."); metrics missing from the entry are NaN
+struct ReportSample {
+    QString time, type, details;
+    double vmaf, psnr, ssim;
+    double bitrateKbps = 0;
+
+    ReportSample();
+    // False for entries that carry no metric at all (e.g. predictions)
+    static bool fromHistory(const QStringList& fields, ReportSample& sample);
+};
+
+struct MetricSummary {
+    int count = 0;
+    double mean = 0, min = 0, max = 0;
+    double p5 = 0, p25 = 0, median = 0, p75 = 0, p95 = 0;
+};
+
+// Summary of a set of samples: all of them, or one encoder configuration
+struct ReportGroup {
+    QString name;
+    QVector<ReportSample> samples;
+    MetricSummary vmaf, psnr, ssim, bitrate;
+};
+
+// Bjontegaard deltas of configuration B against configuration A. Rates are percent
+// bitrate change at equal quality (negative = B is cheaper); the others are quality
+// change at equal bitrate. NaN when the curves have too few points or don't overlap.
+struct BdDeltas {
+    double ratePsnr, rateVmaf;
+    double psnr, vmaf;
+    BdDeltas();
+};
+
+struct BatchReport {
+    QString created;
+    int entries = 0;    // history rows handed in
+    int skipped = 0;    // rows without any metric
+    ReportGroup all;
+    // Optional A/B comparison; configurations are picked by a substring of the details
+    QString configA, configB;
+    ReportGroup groupA, groupB;
+    BdDeltas bd;
+
+    // Pure function of its inputs, so it can run on a worker thread
+    static BatchReport build(const QList<QStringList>& historyRows,
+                             const QString& configA = QString(), const QString& configB = QString());
+    bool hasComparison() const { return !configA.isEmpty() && !configB.isEmpty(); }
+
+    QJsonObject toJson() const;
+    QString toHtml() const;
+};
+
+namespace ReportMath {
+    // NaN values are ignored
+    MetricSummary summarize(QVector<double> values);
+    // Linear interpolation between closest ranks; `sorted` ascending, p in [0, 1]
+    double percentile(const QVector<double>& sorted, double p);
+    // Least-squares polynomial of `degree`, lowest coefficient first; empty on failure
+    QVector<double> polyfit(const QVector<double>& x, const QVector<double>& y, int degree);
+    double polyIntegral(const QVector<double>& coefficients, double from, double to);
+
+    // Points are (bitrate kbps, quality). Cubic fits (fewer points: lower degree, at least 2).
+    double bdRate(const QVector<QPointF>& anchor, const QVector<QPointF>& test);
+    double bdQuality(const QVector<QPointF>& anchor, const QVector<QPointF>& test);
+}
+
+#endif // BATCHREPORT_H
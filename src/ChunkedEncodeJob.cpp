@@ -0,0 +1,392 @@
+#include "ChunkedEncodeJob.h"
+#include "EncodeModel.h"
+#include "JobScheduler.h"
+#include "VideoUtils.h"
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+static constexpr int ManifestVersion = 1;
+static constexpr const char *ManifestName = "manifest.json";
+static constexpr const char *SegmentListName = "segments.csv";
+
+// ffmpeg's "time=00:01:02.50" progress field, in seconds; -1 if the text has none
+static double progressSeconds(const QString& text) {
+    static const QRegularExpression timeRx(R"(time=(\d+):(\d+):(\d+(?:\.\d+)?))");
+    double seconds = -1;
+    auto it = timeRx.globalMatch(text);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch m = it.next();
+        seconds = m.captured(1).toInt() * 3600.0 + m.captured(2).toInt() * 60.0 + m.captured(3).toDouble();
+    }
+    return seconds;
+}
+
+ChunkedEncodeJob::ChunkedEncodeJob(QObject *parent) : QObject(parent) {}
+
+ChunkedEncodeJob::~ChunkedEncodeJob() {
+    stopAll();
+}
+
+QStringList ChunkedEncodeJob::qualityArguments(const QString& encoder, const QString& preset, double crf) {
+    const QString q = QString::number(crf, 'g', 4);
+    QStringList args;
+    if (encoder.endsWith("_amf")) args << "-quality" << preset;
+    else                          args << "-preset" << preset;
+
+    if (encoder.endsWith("_nvenc"))    args << "-rc" << "vbr" << "-cq" << q << "-b:v" << "0";
+    else if (encoder.endsWith("_qsv")) args << "-global_quality" << q;
+    else if (encoder.endsWith("_amf")) args << "-rc" << "cqp" << "-qp_i" << q << "-qp_p" << q << "-qp_b" << q;
+    else                               args << "-crf" << q;
+
+    // ab-av1 scores SVT-AV1 in 10-bit by default; encode the way it was predicted
+    if (encoder == "libsvtav1") args << "-pix_fmt" << "yuv420p10le";
+    return args;
+}
+
+QStringList ChunkedEncodeJob::threadArguments(const QString& encoder, int threads) {
+    const QString t = QString::number(threads);
+    if (encoder == "libsvtav1") return {"-svtav1-params", "lp=" + t};
+    if (encoder == "libx265")   return {"-x265-params", "pools=" + t};
+    return {"-threads", t};
+}
+
+QList<double> ChunkedEncodeJob::planCuts(const QList<double>& scenes, double duration,
+                                         double minChunk, double maxChunk) {
+    QList<double> sorted = scenes;
+    std::sort(sorted.begin(), sorted.end());
+    sorted << duration;
+
+    QList<double> cuts;
+    double last = 0;
+    for (double cut : std::as_const(sorted)) {
+        const bool end = cut >= duration;
+        if (end) cut = duration;
+        // Too close to the previous cut, or would leave a sliver at the end: merge
+        if (!end && (cut - last < minChunk || duration - cut < minChunk)) continue;
+        const int pieces = maxChunk > 0 ? int(std::ceil((cut - last) / maxChunk)) : 1;
+        for (int k = 1; k < pieces; ++k) cuts << last + (cut - last) * k / pieces;
+        if (!end) cuts << cut;
+        last = cut;
+        if (end) break;
+    }
+    return cuts;
+}
+
+void ChunkedEncodeJob::start(const Settings& settings) {
+    if (m_running) return;
+    m_settings = settings;
+    m_settings.input  = QFileInfo(settings.input).absoluteFilePath();
+    m_settings.output = QFileInfo(settings.output).absoluteFilePath();
+    m_settings.workers = qMax(1, settings.workers);
+    m_workDir = workDirectory(m_settings.output);
+    m_steps.setWorkingDirectory(m_workDir);
+    m_chunks.clear();
+    m_nextChunk = 0;
+    m_activeChunks = 0;
+    m_running = true;
+    m_source = VideoUtils::getVideoFormat(m_settings.input);
+    m_duration = m_source.durationSeconds;
+
+    if (loadManifest()) {
+        const int done = int(std::count_if(m_chunks.cbegin(), m_chunks.cend(), [](const Chunk& c) { return c.done; }));
+        emit logLine(QString("Resuming from %1: %2 of %3 chunks already encoded.").arg(m_workDir).arg(done).arg(m_chunks.size()));
+        emit stageChanged("Encoding");
+        encodeNext();
+        return;
+    }
+    // Missing, or left by an encode with other settings: start over
+    QDir(m_workDir).removeRecursively();
+    if (!QDir().mkpath(m_workDir)) {
+        fail("cannot create the work directory " + m_workDir);
+        return;
+    }
+    detectScenes();
+}
+
+void ChunkedEncodeJob::cancel() {
+    if (!m_running) return;
+    const int done = int(std::count_if(m_chunks.cbegin(), m_chunks.cend(), [](const Chunk& c) { return c.done; }));
+    emit logLine(QString("Cancelled. %1 of %2 finished chunks are kept in %3; start the same encode again to resume.")
+                     .arg(done).arg(m_chunks.size()).arg(m_workDir));
+    stopAll();
+    complete(false);
+}
+
+// --- Stages ---
+
+void ChunkedEncodeJob::detectScenes() {
+    emit stageChanged("Detecting scenes");
+    emit logLine(QString("Detecting scene cuts (scene score > %1)...").arg(m_settings.sceneThreshold));
+
+    // Scene scores don't need full resolution; only the selected frames reach showinfo
+    const QString filter = QString("scale=-2:270,select='gt(scene,%1)',showinfo").arg(m_settings.sceneThreshold);
+    const QString input = m_settings.input;
+    auto scenes = std::make_shared<QList<double>>();
+    auto buffer = std::make_shared<QString>();
+
+    m_steps.run("Encode: scenes of " + QFileInfo(input).fileName(), [input, filter](int threads) {
+        return QStringList{"-hide_banner", "-threads", QString::number(threads), "-i", input,
+                           "-map", "0:v:0", "-an", "-sn", "-vf", filter, "-f", "null", "-"};
+    }, 0, [this, scenes, buffer](const QString& text) {
+        static const QRegularExpression ptsRx(R"(Parsed_showinfo.*pts_time:\s*([\d.]+))");
+        *buffer += text;
+        const int end = int(buffer->lastIndexOf('\n'));
+        if (end < 0) return;
+        for (const QString& line : buffer->left(end).split('\n')) {
+            const QRegularExpressionMatch m = ptsRx.match(line);
+            if (m.hasMatch()) *scenes << m.captured(1).toDouble();
+        }
+        buffer->remove(0, end + 1);
+        const double t = progressSeconds(text);
+        if (t >= 0) emit progressUpdated(t, m_duration);
+    }, [this, scenes](bool ok, const QString& errors) {
+        if (!ok) {
+            fail("scene detection failed: " + errors.trimmed().section('\n', -1));
+            return;
+        }
+        const QList<double> cuts = planCuts(*scenes, m_duration, m_settings.minChunkSeconds, m_settings.maxChunkSeconds);
+        emit logLine(QString("%1 scene cuts found; splitting into %2 chunks.").arg(scenes->size()).arg(cuts.size() + 1));
+        split(cuts);
+    });
+}
+
+// Stream copy can only cut on keyframes, so each chunk starts at the first source
+// keyframe at or after its cut time; nothing is decoded or re-encoded here.
+void ChunkedEncodeJob::split(const QList<double>& cuts) {
+    emit stageChanged("Splitting");
+    QStringList times;
+    for (double t : cuts) times << QString::number(t, 'f', 3);
+    const QString input = m_settings.input;
+
+    m_steps.run("Encode: split " + QFileInfo(input).fileName(), [input, times](int) {
+        QStringList args{"-hide_banner", "-y", "-i", input, "-map", "0:v:0", "-c", "copy", "-f", "segment"};
+        if (!times.isEmpty()) args << "-segment_times" << times.join(',');
+        args << "-segment_list" << SegmentListName << "-segment_list_type" << "csv"
+             << "-reset_timestamps" << "1" << "seg%05d.mkv";
+        return args;
+    }, 1, [this](const QString& text) {
+        const double t = progressSeconds(text);
+        if (t >= 0) emit progressUpdated(t, m_duration);
+    }, [this](bool ok, const QString& errors) {
+        if (!ok || !readSegmentList()) {
+            fail("splitting failed: " + errors.trimmed().section('\n', -1));
+            return;
+        }
+        saveManifest();
+        emit stageChanged("Encoding");
+        encodeNext();
+    });
+}
+
+// "seg00000.mkv,0.000000,10.010000": file, start and end of every chunk
+bool ChunkedEncodeJob::readSegmentList() {
+    QFile file(QDir(m_workDir).filePath(SegmentListName));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return false;
+    m_chunks.clear();
+    while (!file.atEnd()) {
+        const QStringList fields = QString::fromUtf8(file.readLine()).trimmed().split(',');
+        if (fields.size() < 3) continue;
+        Chunk chunk;
+        chunk.source   = fields[0];
+        chunk.start    = fields[1].toDouble();
+        chunk.duration = fields[2].toDouble() - chunk.start;
+        m_chunks << chunk;
+    }
+    return !m_chunks.isEmpty();
+}
+
+void ChunkedEncodeJob::encodeNext() {
+    const int threads = qMax(1, JobScheduler::instance()->threadBudget() / m_settings.workers);
+    while (m_running && m_activeChunks < m_settings.workers && m_nextChunk < m_chunks.size()) {
+        const int index = m_nextChunk++;
+        if (m_chunks[index].done) continue;
+        ++m_activeChunks;
+
+        const Chunk& chunk = m_chunks[index];
+        const QString partial = QString("enc%1.part.mkv").arg(index, 5, 10, QChar('0'));
+        const Settings settings = m_settings;
+        // Wall time and threads of the encode itself, for the EncodeModel
+        auto clock = std::make_shared<QElapsedTimer>();
+        auto threadsUsed = std::make_shared<int>(0);
+        m_steps.run(QString("Encode: chunk %1/%2").arg(index + 1).arg(m_chunks.size()),
+                    [settings, source = chunk.source, partial, clock, threadsUsed](int granted) {
+            clock->start();
+            *threadsUsed = granted;
+            QStringList args{"-hide_banner", "-y", "-i", source, "-map", "0:v:0", "-c:v", settings.encoder};
+            args << qualityArguments(settings.encoder, settings.preset, settings.crf)
+                 << threadArguments(settings.encoder, granted)
+                 << "-an" << "-sn" << partial;
+            return args;
+        }, threads, [this, index](const QString& text) {
+            const double t = progressSeconds(text);
+            if (t < 0) return;
+            m_chunks[index].encoded = t;
+            reportProgress();
+        }, [this, index, partial, clock, threadsUsed](bool ok, const QString& errors) {
+            --m_activeChunks;
+            QDir dir(m_workDir);
+            if (!ok) {
+                dir.remove(partial);
+                fail(QString("chunk %1 failed: %2").arg(index + 1).arg(errors.trimmed().section('\n', -1)));
+                return;
+            }
+            dir.remove(encodedName(index));
+            dir.rename(partial, encodedName(index));
+            recordMeasurement(index, clock->elapsed() / 1000.0, *threadsUsed);
+            m_chunks[index].done = true;
+            m_chunks[index].encoded = m_chunks[index].duration;
+            saveManifest();
+            reportProgress();
+            const int done = int(std::count_if(m_chunks.cbegin(), m_chunks.cend(), [](const Chunk& c) { return c.done; }));
+            emit chunkFinished(done, m_chunks.size());
+            encodeNext();
+        });
+    }
+
+    const bool allDone = std::all_of(m_chunks.cbegin(), m_chunks.cend(), [](const Chunk& c) { return c.done; });
+    if (m_running && allDone && m_activeChunks == 0) join();
+}
+
+void ChunkedEncodeJob::join() {
+    emit stageChanged("Joining");
+    QSaveFile list(QDir(m_workDir).filePath("concat.txt"));
+    if (!list.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        fail("cannot write the chunk list");
+        return;
+    }
+    for (int i = 0; i < m_chunks.size(); ++i)
+        list.write(QString("file '%1'\n").arg(encodedName(i)).toUtf8());
+    if (!list.commit()) {
+        fail("cannot write the chunk list");
+        return;
+    }
+
+    const QString input = m_settings.input, output = m_settings.output;
+    m_steps.run("Encode: join " + QFileInfo(output).fileName(), [input, output](int) {
+        // Encoded chunks in order, plus the source's audio; nothing is re-encoded
+        return QStringList{"-hide_banner", "-y", "-f", "concat", "-safe", "0", "-i", "concat.txt",
+                           "-i", input, "-map", "0:v", "-map", "1:a?", "-c", "copy", output};
+    }, 1, [this](const QString& text) {
+        const double t = progressSeconds(text);
+        if (t >= 0) emit progressUpdated(t, m_duration);
+    }, [this, output](bool ok, const QString& errors) {
+        if (!ok) {
+            fail("joining the chunks failed: " + errors.trimmed().section('\n', -1));
+            return;
+        }
+        emit logLine(QString("Wrote %1 (%2 MB) from %3 chunks.")
+                         .arg(output).arg(QFileInfo(output).size() / (1024.0 * 1024.0), 0, 'f', 1).arg(m_chunks.size()));
+        QDir(m_workDir).removeRecursively();
+        complete(true);
+    });
+}
+
+void ChunkedEncodeJob::recordMeasurement(int index, double seconds, int threads) const {
+    const double frames = m_chunks[index].duration * m_source.frameRate;
+    if (frames <= 0 || seconds <= 0 || m_source.width <= 0 || m_source.height <= 0) return;
+    EncodeSample sample;
+    sample.encoder      = m_settings.encoder;
+    sample.preset       = m_settings.preset;
+    sample.width        = m_source.width;
+    sample.height       = m_source.height;
+    sample.crf          = m_settings.crf;
+    sample.threads      = threads;
+    sample.complexity   = EncodeModel::complexityOf(m_source);
+    sample.fps          = frames / seconds;
+    sample.bitsPerPixel = QFileInfo(QDir(m_workDir).filePath(encodedName(index))).size() * 8.0
+                          / (frames * m_source.width * m_source.height);
+    EncodeModel::record(sample);
+}
+
+void ChunkedEncodeJob::reportProgress() {
+    double done = 0, total = 0;
+    for (const Chunk& c : std::as_const(m_chunks)) {
+        done  += qMin(c.encoded, c.duration);
+        total += c.duration;
+    }
+    emit progressUpdated(done, total);
+}
+
+void ChunkedEncodeJob::fail(const QString& message) {
+    emit logLine("Error: " + message);
+    if (!m_chunks.isEmpty()) emit logLine("Finished chunks are kept in " + m_workDir + "; start the same encode again to resume.");
+    stopAll();
+    complete(false);
+}
+
+void ChunkedEncodeJob::complete(bool success) {
+    if (!m_running) return;
+    m_running = false;
+    emit finished(success);
+}
+
+void ChunkedEncodeJob::stopAll() {
+    m_steps.stopAll();
+    m_activeChunks = 0;
+}
+
+// --- Resume manifest ---
+
+bool ChunkedEncodeJob::loadManifest() {
+    QFile file(QDir(m_workDir).filePath(ManifestName));
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    // Only an encode of the same, unchanged input with the same settings can be resumed
+    const QFileInfo input(m_settings.input);
+    if (root.value("version").toInt() != ManifestVersion
+        || root.value("input").toString() != input.canonicalFilePath()
+        || root.value("inputSize").toDouble() != double(input.size())
+        || root.value("inputModified").toString() != input.lastModified().toString(Qt::ISODateWithMs)
+        || root.value("encoder").toString() != m_settings.encoder
+        || root.value("preset").toString() != m_settings.preset
+        || root.value("crf").toDouble() != m_settings.crf)
+        return false;
+
+    QDir dir(m_workDir);
+    m_chunks.clear();
+    for (const QJsonValue& v : root.value("chunks").toArray()) {
+        const QJsonObject o = v.toObject();
+        Chunk chunk;
+        chunk.source   = o.value("source").toString();
+        chunk.start    = o.value("start").toDouble();
+        chunk.duration = o.value("duration").toDouble();
+        chunk.done     = o.value("done").toBool() && QFileInfo(dir.filePath(encodedName(int(m_chunks.size())))).size() > 0;
+        chunk.encoded  = chunk.done ? chunk.duration : 0;
+        if (!QFileInfo::exists(dir.filePath(chunk.source))) return false;
+        m_chunks << chunk;
+    }
+    return !m_chunks.isEmpty();
+}
+
+void ChunkedEncodeJob::saveManifest() const {
+    QJsonArray chunks;
+    for (const Chunk& c : m_chunks)
+        chunks.append(QJsonObject{{"source", c.source}, {"start", c.start}, {"duration", c.duration}, {"done", c.done}});
+    const QFileInfo input(m_settings.input);
+    const QJsonObject root{
+        {"version", ManifestVersion},
+        {"input", input.canonicalFilePath()},
+        {"inputSize", double(input.size())},
+        {"inputModified", input.lastModified().toString(Qt::ISODateWithMs)},
+        {"encoder", m_settings.encoder}, {"preset", m_settings.preset}, {"crf", m_settings.crf},
+        {"output", m_settings.output},
+        {"chunks", chunks}
+    };
+    QSaveFile file(QDir(m_workDir).filePath(ManifestName));
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson());
+        file.commit();
+    }
+}
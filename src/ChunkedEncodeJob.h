@@ -0,0 +1,101 @@
+#ifndef CHUNKEDENCODEJOB_H
+#define CHUNKEDENCODEJOB_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include "ScheduledProcesses.h"
+#include "VideoUtils.h"
+
+// Final encode of a whole title at a fixed CRF, split into chunks that are encoded in
+// parallel. Software AV1 encoders use many cores poorly within one process, so a pool
+// of single-chunk encodes keeps a large machine busy instead.
+//
+//   1. scenes:  ffmpeg's scene score on a downscaled decode finds the cuts
+//   2. split:   the video stream is cut there losslessly (-c copy, segment muxer),
+//               so each chunk starts on a source keyframe at or after its cut
+//   3. encode:  every chunk is a JobScheduler job; at most `workers` run at once,
+//               each with its share of the thread budget
+//   4. join:    the encoded chunks are concatenated without re-encoding, and the
+//               source's audio is copied in
+//
+// Progress is kept in a manifest in the work directory (<output>.chunks), so a
+// cancelled or failed encode resumes with the chunks that were still missing.
+class ChunkedEncodeJob : public QObject {
+    Q_OBJECT
+
+public:
+    struct Settings {
+        QString input, output;
+        QString encoder, preset;
+        double crf = 30;
+        int workers = 4;
+        double sceneThreshold = 0.3;    // ffmpeg scene score (0-1) that counts as a cut
+        double minChunkSeconds = 10;    // shorter scenes are merged into their neighbours
+        double maxChunkSeconds = 120;   // longer scenes are split evenly
+    };
+
+    explicit ChunkedEncodeJob(QObject *parent = nullptr);
+    ~ChunkedEncodeJob();
+
+    // Resumes from the work directory when its manifest matches these settings
+    void start(const Settings& settings);
+    // Stops every process; finished chunks are kept for a later resume
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    static QString workDirectory(const QString& output) { return output + ".chunks"; }
+    // Rate-control options that apply `crf` the way ab-av1 does for each encoder family
+    static QStringList qualityArguments(const QString& encoder, const QString& preset, double crf);
+    // Limits the encoder to `threads` in the option each encoder family honours
+    static QStringList threadArguments(const QString& encoder, int threads);
+    // Chunk start times (after 0) from scene cuts, merging and splitting to the bounds
+    static QList<double> planCuts(const QList<double>& scenes, double duration,
+                                  double minChunk, double maxChunk);
+
+signals:
+    void logLine(const QString& line);
+    // "Detecting scenes", "Splitting", "Encoding", "Joining"
+    void stageChanged(const QString& stage);
+    // Seconds of video the current stage has processed (encoded, for "Encoding")
+    void progressUpdated(double doneSeconds, double totalSeconds);
+    void chunkFinished(int doneCount, int chunkCount);
+    void finished(bool success);
+
+private:
+    struct Chunk {
+        QString source;          // lossless cut of the input, in the work directory
+        double start = 0, duration = 0;
+        bool done = false;
+        double encoded = 0;      // seconds encoded so far while running
+    };
+    void detectScenes();
+    void split(const QList<double>& cuts);
+    bool readSegmentList();
+    void encodeNext();
+    void join();
+    void fail(const QString& message);
+    void complete(bool success);
+    void stopAll();
+    bool loadManifest();
+    void saveManifest() const;
+    QString encodedName(int index) const { return QString("enc%1.mkv").arg(index, 5, 10, QChar('0')); }
+    void reportProgress();
+    void recordMeasurement(int index, double seconds, int threads) const;
+
+    Settings m_settings;
+    QString m_workDir;
+    double m_duration = 0;
+    VideoUtils::VideoFormat m_source;   // for the EncodeModel measurements
+    QVector<Chunk> m_chunks;
+    int m_nextChunk = 0;
+    int m_activeChunks = 0;
+    bool m_running = false;
+
+    ScheduledProcesses m_steps;   // ffmpeg steps, run in the work directory
+};
+
+#endif // CHUNKEDENCODEJOB_H
@@ -0,0 +1,162 @@
+#include "EncodeModel.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <array>
+#include <cmath>
+
+static constexpr int StoreVersion = 1;
+
+namespace {
+
+constexpr int Features = 4;   // log2 pixels, log2 complexity, CRF, log2 threads
+using Row = std::array<double, Features>;
+
+Row featuresOf(int width, int height, double crf, int threads, double complexity) {
+    return {std::log2(qMax(1.0, double(width) * height)), std::log2(qMax(1e-4, complexity)),
+            crf, std::log2(double(qMax(1, threads)))};
+}
+
+struct Fit {
+    Row mean{}, beta{};
+    double intercept = 0;
+    double rms = 0;   // residual, in log2 units
+
+    double predict(const Row& x) const {
+        double y = intercept;
+        for (int j = 0; j < Features; ++j) y += beta[j] * (x[j] - mean[j]);
+        return y;
+    }
+};
+
+// Ridge regression on centred features, so the intercept is not shrunk. The penalty
+// keeps the fit sane with a handful of samples or a feature that never varied (for
+// example every encode at the same CRF), whose coefficient then stays at zero.
+Fit fitRidge(const QVector<Row>& x, const QVector<double>& y, double lambda = 1.0) {
+    Fit fit;
+    const int n = x.size();
+    double yMean = 0;
+    for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < Features; ++j) fit.mean[j] += x[i][j] / n;
+        yMean += y[i] / n;
+    }
+
+    // Normal equations (XᵀX + λI) β = Xᵀy, augmented with the right-hand side
+    double a[Features][Features + 1] = {};
+    for (int i = 0; i < n; ++i) {
+        for (int r = 0; r < Features; ++r) {
+            const double xr = x[i][r] - fit.mean[r];
+            for (int c = 0; c < Features; ++c) a[r][c] += xr * (x[i][c] - fit.mean[c]);
+            a[r][Features] += xr * (y[i] - yMean);
+        }
+    }
+    for (int r = 0; r < Features; ++r) a[r][r] += lambda;
+
+    // Gaussian elimination with partial pivoting; the matrix is positive definite
+    for (int col = 0; col < Features; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < Features; ++r)
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col])) pivot = r;
+        for (int c = 0; c <= Features; ++c) std::swap(a[col][c], a[pivot][c]);
+        for (int r = 0; r < Features; ++r) {
+            if (r == col) continue;
+            const double f = a[r][col] / a[col][col];
+            for (int c = col; c <= Features; ++c) a[r][c] -= f * a[col][c];
+        }
+    }
+    for (int j = 0; j < Features; ++j) fit.beta[j] = a[j][Features] / a[j][j];
+    fit.intercept = yMean;
+
+    double squares = 0;
+    for (int i = 0; i < n; ++i) squares += std::pow(fit.predict(x[i]) - y[i], 2);
+    fit.rms = std::sqrt(squares / n);
+    return fit;
+}
+
+} // namespace
+
+QString EncodeModel::storePath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/encode-measurements.json";
+}
+
+QVector<EncodeSample> EncodeModel::load() {
+    QFile file(storePath());
+    if (!file.open(QIODevice::ReadOnly)) return {};
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != StoreVersion) return {};
+
+    QVector<EncodeSample> samples;
+    for (const QJsonValue& v : root.value("samples").toArray()) {
+        const QJsonObject o = v.toObject();
+        EncodeSample s;
+        s.encoder      = o.value("encoder").toString();
+        s.preset       = o.value("preset").toString();
+        s.width        = o.value("width").toInt();
+        s.height       = o.value("height").toInt();
+        s.crf          = o.value("crf").toDouble();
+        s.threads      = o.value("threads").toInt();
+        s.complexity   = o.value("complexity").toDouble();
+        s.fps          = o.value("fps").toDouble();
+        s.bitsPerPixel = o.value("bitsPerPixel").toDouble();
+        if (s.fps > 0 && s.bitsPerPixel > 0) samples << s;
+    }
+    return samples;
+}
+
+void EncodeModel::record(const EncodeSample& sample) {
+    if (sample.fps <= 0 || sample.bitsPerPixel <= 0 || sample.width <= 0 || sample.height <= 0) return;
+    QVector<EncodeSample> samples = load();
+    samples << sample;
+    if (samples.size() > MaxSamples) samples.remove(0, samples.size() - MaxSamples);
+
+    QJsonArray array;
+    for (const EncodeSample& s : std::as_const(samples)) {
+        array.append(QJsonObject{
+            {"encoder", s.encoder}, {"preset", s.preset}, {"width", s.width}, {"height", s.height},
+            {"crf", s.crf}, {"threads", s.threads}, {"complexity", s.complexity},
+            {"fps", s.fps}, {"bitsPerPixel", s.bitsPerPixel}
+        });
+    }
+    QDir().mkpath(QFileInfo(storePath()).absolutePath());
+    QSaveFile file(storePath());
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(QJsonDocument(QJsonObject{{"version", StoreVersion}, {"samples", array}}).toJson(QJsonDocument::Compact));
+    file.commit();
+}
+
+void EncodeModel::clear() {
+    QFile::remove(storePath());
+}
+
+EncodeEstimate EncodeModel::estimate(const QString& encoder, const QString& preset,
+                                     int width, int height, double crf, int threads, double complexity) {
+    QVector<Row> x;
+    QVector<double> fps, bpp;
+    for (const EncodeSample& s : load()) {
+        if (s.encoder != encoder || s.preset != preset) continue;
+        x << featuresOf(s.width, s.height, s.crf, s.threads, s.complexity);
+        fps << std::log2(s.fps);
+        bpp << std::log2(s.bitsPerPixel);
+    }
+    EncodeEstimate estimate;
+    estimate.samples = x.size();
+    if (x.size() < MinSamples) return estimate;
+
+    const Row query = featuresOf(width, height, crf, threads, complexity);
+    const Fit speed = fitRidge(x, fps), size = fitRidge(x, bpp);
+    estimate.fps          = std::exp2(speed.predict(query));
+    estimate.bitsPerPixel = std::exp2(size.predict(query));
+    estimate.fpsError     = std::exp2(speed.rms) - 1;
+    estimate.sizeError    = std::exp2(size.rms) - 1;
+    return estimate;
+}
+
+double EncodeModel::complexityOf(const VideoUtils::VideoFormat& format) {
+    const double pixelRate = double(format.width) * format.height * format.frameRate;
+    return pixelRate > 0 && format.bitrateKbps > 0 ? format.bitrateKbps * 1000 / pixelRate : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef ENCODEMODEL_H
+#define ENCODEMODEL_H
+
+#include <QString>
+#include <QVector>
+#include "VideoUtils.h"
+
+// One measured encode on this machine
+struct EncodeSample {
+    QString encoder, preset;
+    int width = 0, height = 0;     // encoded frame size
+    double crf = 0;
+    int threads = 0;
+    double complexity = 0;         // source bits per pixel (EncodeModel::complexityOf)
+    double fps = 0;                // frames encoded per wall-clock second
+    double bitsPerPixel = 0;       // of the encoded stream
+};
+
+// What the model expects for an encode; valid() is false without enough history
+struct EncodeEstimate {
+    double fps = 0;
+    double bitsPerPixel = 0;
+    int samples = 0;               // measurements the fit was made from
+    double fpsError = 0;           // typical relative error of fps/size in the fit's own
+    double sizeError = 0;          // history (0.15 = ±15%)
+
+    bool valid() const { return fps > 0; }
+    double seconds(double frames) const { return fps > 0 ? frames / fps : 0; }
+    qint64 bytes(double frames, int width, int height) const {
+        return qint64(bitsPerPixel * width * height * frames / 8);
+    }
+};
+
+// Encode speed and size learned from the encodes VidMetric has run (chunked final
+// encodes, ladder probes). Every measurement is kept in a small JSON store; an
+// estimate fits a ridge regression per encoder and preset on the fly:
+//
+//   log2 fps, log2 bits/pixel  ~  log2 pixels + log2 complexity + CRF + log2 threads
+//
+// Content complexity is the source's own bits per pixel, which costs one ffprobe
+// instead of a decode. With fewer than MinSamples measurements there is no estimate.
+class EncodeModel {
+public:
+    static constexpr int MinSamples = 4;
+
+    static QString storePath();
+    static QVector<EncodeSample> load();
+    // Appends a measurement; the store keeps the newest MaxSamples
+    static void record(const EncodeSample& sample);
+    static void clear();
+
+    static EncodeEstimate estimate(const QString& encoder, const QString& preset,
+                                   int width, int height, double crf, int threads, double complexity);
+    // Container bit rate per pixel per frame; 0 when the format doesn't report them
+    static double complexityOf(const VideoUtils::VideoFormat& format);
+
+private:
+    static constexpr int MaxSamples = 5000;
+};
+
+#endif // ENCODEMODEL_H
@@ -0,0 +1,291 @@
+#include "EncoderProbe.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QTimer>
+
+bool EncoderCapability::acceptsPreset(const QString& value) const {
+    bool isInt = false;
+    int n = value.toInt(&isInt);
+    if (isInt && hasPresetRange)
+        return n >= presetMin && n <= presetMax;
+    if (!presetNames.isEmpty())
+        return presetNames.contains(value);
+    return true;
+}
+
+EncoderProbe::EncoderProbe(QObject *parent) : QObject(parent) {}
+
+EncoderProbe::~EncoderProbe() {
+    killAll();
+}
+
+bool EncoderProbe::isRunning() const {
+    return m_running;
+}
+
+void EncoderProbe::start(const QStringList& encoders, bool forceRefresh) {
+    if (m_running) return;
+
+    m_requested = encoders;
+    m_pending.clear();
+    m_results.clear();
+    m_active  = 0;
+    m_running = true;
+    m_startFailed = false;
+
+    m_ffmpegPath = QStandardPaths::findExecutable("ffmpeg");
+    if (m_ffmpegPath.isEmpty()) {
+        emit logLine("Encoder probe: ffmpeg not found on PATH, skipping.");
+        // Stay asynchronous so callers can connect after start()
+        QTimer::singleShot(0, this, [this]() { m_running = false; emit finished(); });
+        return;
+    }
+
+    m_cacheKey = binaryKey(m_ffmpegPath);
+    if (!forceRefresh && loadCache()) {
+        emit logLine("Encoder probe: using cached results for " + m_ffmpegPath);
+        QTimer::singleShot(0, this, [this]() {
+            for (const EncoderCapability& cap : std::as_const(m_results))
+                emit encoderProbed(cap);
+            m_running = false;
+            emit finished();
+        });
+        return;
+    }
+
+    startListing();
+}
+
+QProcess* EncoderProbe::spawn(const QStringList& args) {
+    QProcess *process = new QProcess(this);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    m_processes.append(process);
+
+    // Hardware encoders can hang while initialising a missing device; don't wait forever
+    QTimer::singleShot(TestTimeoutMs, process, [process]() {
+        if (process->state() != QProcess::NotRunning) process->kill();
+    });
+    // A binary that can't be started never emits finished(); report it as a failed
+    // run instead, queued so the caller has connected its handler by then
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) return;
+        if (!m_startFailed) emit logLine("Encoder probe: could not start " + m_ffmpegPath + ": " + process->errorString());
+        m_startFailed = true;
+        QMetaObject::invokeMethod(process, [process]() { emit process->finished(-1, QProcess::CrashExit); },
+                                  Qt::QueuedConnection);
+    });
+
+    process->start(m_ffmpegPath, args);
+    return process;
+}
+
+void EncoderProbe::startListing() {
+    QProcess *process = spawn({"-hide_banner", "-encoders"});
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, process](int, QProcess::ExitStatus) {
+        const QString text = QString::fromLocal8Bit(process->readAll());
+        m_processes.removeOne(process);
+        process->deleteLater();
+
+        // Lines look like: " V....D libx264              libx264 H.264 / AVC ..."
+        static QRegularExpression encoderRx(R"(^\s*V[A-Z.]{5}\s+(\S+))",
+                                            QRegularExpression::MultilineOption);
+        QStringList listed;
+        auto it = encoderRx.globalMatch(text);
+        while (it.hasNext()) listed << it.next().captured(1);
+
+        for (const QString& name : std::as_const(m_requested)) {
+            EncoderCapability cap;
+            cap.name   = name;
+            cap.listed = listed.contains(name);
+            m_results.insert(name, cap);
+            if (cap.listed) m_pending << name;
+            else            emit encoderProbed(cap);
+        }
+
+        emit logLine(QString("Encoder probe: %1 of %2 encoders listed by ffmpeg, test-encoding...")
+                     .arg(m_pending.size()).arg(m_requested.size()));
+        if (m_pending.isEmpty()) finishAll();
+        else                     startNextTests();
+    });
+}
+
+void EncoderProbe::startNextTests() {
+    while (m_active < MaxParallel && !m_pending.isEmpty()) {
+        ++m_active;
+        runTestEncode(m_pending.takeFirst());
+    }
+}
+
+void EncoderProbe::runTestEncode(const QString& encoder) {
+    // A few frames of black at a size every hardware encoder accepts
+    QStringList args;
+    args << "-hide_banner" << "-v" << "error"
+         << "-f" << "lavfi" << "-i" << "color=c=black:s=256x256:r=25:d=1"
+         << "-frames:v" << "3" << "-pix_fmt" << "yuv420p"
+         << "-c:v" << encoder << "-f" << "null" << "-";
+
+    QProcess *process = spawn(args);
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, process, encoder](int exitCode, QProcess::ExitStatus status) {
+        const QString output = QString::fromLocal8Bit(process->readAll()).trimmed();
+        m_processes.removeOne(process);
+        process->deleteLater();
+
+        if (status == QProcess::NormalExit && exitCode == 0) {
+            m_results[encoder].working = true;
+            runHelpQuery(encoder);
+        } else {
+            emit logLine(QString("Encoder probe: %1 unavailable (%2)").arg(encoder, output));
+            completeEncoder(encoder);
+        }
+    });
+}
+
+void EncoderProbe::runHelpQuery(const QString& encoder) {
+    QProcess *process = spawn({"-hide_banner", "-h", "encoder=" + encoder});
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, process, encoder](int, QProcess::ExitStatus) {
+        const QString help = QString::fromLocal8Bit(process->readAll());
+        m_processes.removeOne(process);
+        process->deleteLater();
+        parsePresetHelp(help, m_results[encoder]);
+        completeEncoder(encoder);
+    });
+}
+
+void EncoderProbe::completeEncoder(const QString& encoder) {
+    --m_active;
+    emit encoderProbed(m_results.value(encoder));
+    if (m_active == 0 && m_pending.isEmpty()) finishAll();
+    else                                       startNextTests();
+}
+
+void EncoderProbe::finishAll() {
+    // Results from an ffmpeg that wouldn't start say nothing about its encoders
+    if (!m_startFailed) saveCache();
+    m_running = false;
+    emit finished();
+}
+
+void EncoderProbe::killAll() {
+    for (QProcess *process : std::as_const(m_processes)) {
+        process->disconnect(this);
+        process->kill();
+        process->waitForFinished(1000);
+        delete process;
+    }
+    m_processes.clear();
+}
+
+// Parses the -preset option block of `ffmpeg -h encoder=<name>`, e.g.
+//   -preset            <int>        E..V....... Set the encoding preset (from 0 to 18) (default p4)
+//      p1              12           E..V....... fastest (lowest quality)
+void EncoderProbe::parsePresetHelp(const QString& text, EncoderCapability& cap) {
+    static QRegularExpression optionRx(R"(^\s{2}-preset\s+<(\w+)>(?:.*\(from (-?\d+) to (-?\d+)\))?)");
+    static QRegularExpression constRx(R"(^\s{4,}(\S+)\s+-?\d*\s+[E.][.A-Z]{6,})");
+
+    bool inPreset = false;
+    const QStringList lines = text.split('\n');
+    for (const QString& line : lines) {
+        if (!inPreset) {
+            QRegularExpressionMatch m = optionRx.match(line);
+            if (!m.hasMatch()) continue;
+            inPreset = true;
+            if (m.captured(1) == "int" && !m.captured(2).isEmpty()) {
+                cap.hasPresetRange = true;
+                cap.presetMin = m.captured(2).toInt();
+                cap.presetMax = m.captured(3).toInt();
+            }
+            continue;
+        }
+        QRegularExpressionMatch c = constRx.match(line);
+        if (!c.hasMatch()) break;  // next option: the preset block is over
+        cap.presetNames << c.captured(1);
+    }
+}
+
+// --- Disk cache ---
+
+// Identifies the ffmpeg binary by path, size, mtime and a hash of its head and tail.
+// Cheap enough to run on every launch, yet changes whenever ffmpeg is replaced.
+QString EncoderProbe::binaryKey(const QString& ffmpegPath) {
+    QFileInfo info(ffmpegPath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+
+    QFile file(ffmpegPath);
+    if (file.open(QIODevice::ReadOnly)) {
+        const qint64 chunk = 64 * 1024;
+        hash.addData(file.read(chunk));
+        if (file.size() > chunk && file.seek(file.size() - chunk))
+            hash.addData(file.read(chunk));
+    }
+    return QString::fromLatin1(hash.result().toHex().left(16));
+}
+
+QString EncoderProbe::cachePath() const {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+           + "/encoder-probe-" + m_cacheKey + ".json";
+}
+
+bool EncoderProbe::loadCache() {
+    QFile file(cachePath());
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    QMap<QString, EncoderCapability> cached;
+    for (const QJsonValue& v : root.value("encoders").toArray()) {
+        const QJsonObject o = v.toObject();
+        EncoderCapability cap;
+        cap.name           = o.value("name").toString();
+        cap.listed         = o.value("listed").toBool();
+        cap.working        = o.value("working").toBool();
+        cap.hasPresetRange = o.value("hasPresetRange").toBool();
+        cap.presetMin      = o.value("presetMin").toInt();
+        cap.presetMax      = o.value("presetMax").toInt();
+        for (const QJsonValue& n : o.value("presetNames").toArray())
+            cap.presetNames << n.toString();
+        cached.insert(cap.name, cap);
+    }
+
+    // A cache written for a different encoder list is treated as a miss
+    for (const QString& name : std::as_const(m_requested))
+        if (!cached.contains(name)) return false;
+
+    m_results = cached;
+    return true;
+}
+
+void EncoderProbe::saveCache() const {
+    QJsonArray encoders;
+    for (const EncoderCapability& cap : m_results) {
+        QJsonObject o;
+        o["name"]           = cap.name;
+        o["listed"]         = cap.listed;
+        o["working"]        = cap.working;
+        o["hasPresetRange"] = cap.hasPresetRange;
+        o["presetMin"]      = cap.presetMin;
+        o["presetMax"]      = cap.presetMax;
+        o["presetNames"]    = QJsonArray::fromStringList(cap.presetNames);
+        encoders.append(o);
+    }
+    QJsonObject root;
+    root["ffmpeg"]   = m_ffmpegPath;
+    root["encoders"] = encoders;
+
+    QDir().mkpath(QFileInfo(cachePath()).absolutePath());
+    QFile file(cachePath());
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QJsonDocument(root).toJson());
+}
@@ -0,0 +1,78 @@
+#ifndef ENCODERPROBE_H
+#define ENCODERPROBE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QList>
+
+struct EncoderCapability {
+    QString name;
+    bool listed  = false;   // appears in `ffmpeg -encoders`
+    bool working = false;   // a tiny test encode succeeded on this machine
+    // Range of the -preset option when ffmpeg reports it as an integer option
+    bool hasPresetRange = false;
+    int presetMin = 0, presetMax = 0;
+    // Named -preset values reported by `ffmpeg -h encoder=<name>` (empty if none)
+    QStringList presetNames;
+
+    // True if `value` is a preset this encoder accepts. Unknown ranges accept everything.
+    bool acceptsPreset(const QString& value) const;
+};
+
+// Probes which encoders actually work with the ffmpeg on PATH.
+// Lists `ffmpeg -encoders`, then runs a tiny lavfi test encode and a `-h encoder=` query
+// per candidate, several at a time. Results are cached on disk per ffmpeg binary, so
+// subsequent launches finish immediately without spawning any processes.
+class EncoderProbe : public QObject {
+    Q_OBJECT
+
+public:
+    explicit EncoderProbe(QObject *parent = nullptr);
+    ~EncoderProbe();
+
+    // Probes the given encoder names. forceRefresh ignores (and rewrites) the cache.
+    void start(const QStringList& encoders, bool forceRefresh = false);
+    bool isRunning() const;
+    QMap<QString, EncoderCapability> results() const { return m_results; }
+
+signals:
+    void logLine(const QString& line);
+    void encoderProbed(const EncoderCapability& capability);
+    // Emitted once every requested encoder has been checked (or ffmpeg was not found)
+    void finished();
+
+private:
+    void startListing();
+    void startNextTests();
+    void runTestEncode(const QString& encoder);
+    void runHelpQuery(const QString& encoder);
+    void completeEncoder(const QString& encoder);
+    QProcess* spawn(const QStringList& args);
+    void finishAll();
+    void killAll();
+
+    static QString binaryKey(const QString& ffmpegPath);
+    QString cachePath() const;
+    bool loadCache();
+    void saveCache() const;
+
+    static void parsePresetHelp(const QString& text, EncoderCapability& cap);
+
+    static constexpr int MaxParallel   = 4;
+    static constexpr int TestTimeoutMs = 15000;
+
+    QString m_ffmpegPath;
+    QString m_cacheKey;
+    QStringList m_requested;
+    QStringList m_pending;
+    int m_active = 0;
+    bool m_running = false;
+    bool m_startFailed = false;   // some ffmpeg process could not be started
+    QList<QProcess*> m_processes;
+    QMap<QString, EncoderCapability> m_results;
+};
+
+#endif // ENCODERPROBE_H
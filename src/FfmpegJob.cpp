@@ -1,24 +1,125 @@
 #include "FfmpegJob.h"
+#include "JobProtocol.h"
+#include "JobScheduler.h"
+#include "ProcessStats.h"
+#include "ProcessSupervisor.h"
+#include "ReferenceCache.h"
+#include "VideoUtils.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QMap>
 #include <QRegularExpression>
+#include <QTime>
+#include <cmath>
+#include <limits>
 
-FfmpegJob::FfmpegJob(QObject *parent) : QObject(parent) {}
+// CPU/RSS sampling period while ffmpeg runs
+static constexpr int SampleIntervalMs = 250;
+
+FfmpegJob::FfmpegJob(QObject *parent) : QObject(parent) {
+    m_sampleTimer.setInterval(SampleIntervalMs);
+    connect(&m_sampleTimer, &QTimer::timeout, this, &FfmpegJob::sampleProcess);
+    m_gateTimer.setInterval(500);
+    connect(&m_gateTimer, &QTimer::timeout, this, &FfmpegJob::pollGates);
+}
 
 FfmpegJob::~FfmpegJob() {
+    if (m_ticket) JobScheduler::instance()->withdraw(m_ticket);
     if (m_process) {
-        m_process->kill();
+        m_process->disconnect(this);
+        ProcessSupervisor::killTree(m_process);
         m_process->waitForFinished();
         delete m_process;
     }
+    ReferenceCache::discard(m_cachePending);
+    releaseTicket();
 }
 
 bool FfmpegJob::isRunning() const {
-    return m_process && m_process->state() != QProcess::NotRunning;
+    return m_remoteActive
+        || (m_process && m_process->state() != QProcess::NotRunning)
+        || (m_ticket && JobScheduler::instance()->isQueued(m_ticket));
 }
 
 void FfmpegJob::cancel() {
+    if (m_remoteActive) {
+        if (m_remote && m_remoteJobId) m_remote->call("cancel", {{"jobId", m_remoteJobId}});
+        return;
+    }
+    // Still waiting for a slot: drop it from the queue and report it like a failed run
+    if (m_ticket && JobScheduler::instance()->withdraw(m_ticket)) {
+        m_ticket = 0;
+        emit logLine("Cancelled before start.");
+        emit finished(false, -1);
+        return;
+    }
     if (m_process && m_process->state() != QProcess::NotRunning) {
-        m_process->kill();
+        ProcessSupervisor::killTree(m_process);
+    }
+}
+
+void FfmpegJob::releaseTicket() {
+    if (m_ticket) {
+        JobScheduler::instance()->release(m_ticket);
+        m_ticket = 0;
+    }
+}
+
+QVector<MetricScore> ComparisonResult::scores() const {
+    QVector<MetricScore> list;
+    if (hasSsim) list << MetricScore{"ssim", "SSIM", QString(), ssim.all, 4};
+    if (hasPsnr && psnr.avgDb != "inf") list << MetricScore{"psnr", "PSNR", "dB", psnr.avgDb.toDouble(), 2};
+    if (hasVmaf) list << MetricScore{"vmaf", "VMAF", QString(), vmaf, 2};
+    return list + extra;
+}
+
+QString ComparisonResult::formatLabel() const {
+    if (pixelFormat.isEmpty()) return QString();
+    return QString("%1-bit %2, %3").arg(bitDepth).arg(pixelFormat, VideoUtils::transferLabel(transfer));
+}
+
+QString TimeWindow::label() const {
+    return QString("%1 +%2s").arg(QTime(0, 0).addMSecs(qint64(start * 1000)).toString("HH:mm:ss"))
+                             .arg(duration, 0, 'g', 6);
+}
+
+QList<TimeWindow> TimeWindow::parseList(const QString& text, QString *errorMessage) {
+    auto fail = [errorMessage](const QString& message) {
+        if (errorMessage) *errorMessage = message;
+        return QList<TimeWindow>();
+    };
+    // HH:MM:SS[.ms], MM:SS[.ms] or seconds
+    auto toSeconds = [](const QString& t, bool *ok) {
+        double seconds = 0;
+        *ok = true;
+        for (const QString& part : t.trimmed().split(':')) {
+            bool partOk = false;
+            const double v = part.toDouble(&partOk);
+            *ok = *ok && partOk && v >= 0;
+            seconds = seconds * 60 + v;
+        }
+        return seconds;
+    };
+
+    static QRegularExpression itemRx(R"(^([\d:.]+)\s*([+-])\s*([\d:.]+)$)");
+    QList<TimeWindow> windows;
+    for (const QString& item : text.split(QRegularExpression("[,;\\n]"), Qt::SkipEmptyParts)) {
+        const QString trimmed = item.trimmed();
+        if (trimmed.isEmpty()) continue;
+        const QRegularExpressionMatch m = itemRx.match(trimmed);
+        bool startOk = false, endOk = false;
+        const double start = m.hasMatch() ? toSeconds(m.captured(1), &startOk) : 0;
+        const double other = m.hasMatch() ? toSeconds(m.captured(3), &endOk) : 0;
+        if (!startOk || !endOk)
+            return fail(QString("Cannot parse window \"%1\" (use start+duration or start-end)").arg(trimmed));
+        TimeWindow w;
+        w.start    = start;
+        w.duration = m.captured(2) == "+" ? other : other - start;
+        if (w.duration <= 0) return fail(QString("Window \"%1\" is empty").arg(trimmed));
+        windows << w;
     }
+    return windows;
 }
 
 // static helper
@@ -28,49 +129,820 @@ double FfmpegJob::hmsToSeconds(const QString& h, const QString& m, const QString
 
 void FfmpegJob::start(const QString& originalFile, const QString& comparisonFile,
                       const QString& startTime, const QString& duration) {
+    startMulti(originalFile, QStringList{comparisonFile}, startTime, duration);
+}
+
+void FfmpegJob::startMulti(const QString& originalFile, const QStringList& comparisonFiles,
+                           const QString& startTime, const QString& duration) {
+    prepareRun(originalFile, comparisonFiles, startTime, duration);
+
+    double start = 0.0;
+    const QStringList parts = startTime.split(":");
+    if (parts.size() == 3) start = hmsToSeconds(parts[0], parts[1], parts[2]);
+    m_inputs << Input{originalFile, startTime, duration};
+    for (int i = 0; i < comparisonFiles.size(); ++i) {
+        m_inputs << Input{comparisonFiles[i], startTime, duration};
+        m_slots << Slot{0, i + 1, start};
+    }
+
+    // If duration was provided explicitly, pre-seed totalDuration so progress works immediately.
+    if (!duration.isEmpty()) {
+        QStringList parts = duration.split(":");
+        if (parts.size() == 3)
+            m_totalDuration = hmsToSeconds(parts[0], parts[1], parts[2]);
+    }
+
+    submit(comparisonFiles.size() == 1 ? QFileInfo(comparisonFiles.first()).fileName()
+                                       : QString("%1 files").arg(comparisonFiles.size()));
+}
+
+void FfmpegJob::startWindows(const QString& originalFile, const QString& comparisonFile,
+                             const QList<TimeWindow>& windows) {
+    prepareRun(originalFile, QStringList{comparisonFile}, QString(), QString());
+    m_windows = windows;
+
+    m_results.clear();
+    for (int w = 0; w < windows.size(); ++w) {
+        const TimeWindow& window = windows[w];
+        const QString seek   = QString::number(window.start, 'f', 3);
+        const QString length = QString::number(window.duration, 'f', 3);
+        m_inputs << Input{originalFile, seek, length} << Input{comparisonFile, seek, length};
+        m_slots << Slot{2 * w, 2 * w + 1, window.start};
+
+        ComparisonResult r;
+        r.file   = comparisonFile;
+        r.proxy  = proxyLabel();
+        r.window = window.label();
+        m_results << r;
+        // Every window's timestamps restart at 0, so progress runs to the longest one
+        m_totalDuration = qMax(m_totalDuration, window.duration);
+    }
+
+    submit(QString("%1 (%2 windows)").arg(QFileInfo(comparisonFile).fileName()).arg(windows.size()));
+}
+
+void FfmpegJob::prepareRun(const QString& originalFile, const QStringList& comparisonFiles,
+                           const QString& startTime, const QString& duration) {
     if (m_process) {
         m_process->deleteLater();
         m_process = nullptr;
     }
+    if (m_ticket && JobScheduler::instance()->withdraw(m_ticket)) m_ticket = 0;
+    releaseTicket();
+
+    m_originalFile    = originalFile;
+    m_comparisonFiles = comparisonFiles;
+    m_startTime       = startTime;
+    m_duration        = duration;
+    m_windows.clear();
+    m_inputs.clear();
+    m_slots.clear();
+    m_lineBuffer.clear();
+
+    m_results.clear();
+    for (const QString& file : comparisonFiles) {
+        ComparisonResult r;
+        r.file  = file;
+        r.proxy = proxyLabel();
+        m_results << r;
+    }
 
     m_totalDuration = 0.0;
     m_currentTime   = 0.0;
+    m_gates.clear();
+    m_gateAborted = false;
 
-    // If duration was provided explicitly, pre-seed totalDuration so progress works immediately.
-    if (!duration.isEmpty()) {
-        QStringList parts = duration.split(":");
-        if (parts.size() == 3)
-            m_totalDuration = hmsToSeconds(parts[0], parts[1], parts[2]);
+    m_stats = JobStats();
+    m_clock.start();
+    m_launchUs = 0;
+    m_firstProgressUs = m_lastProgressUs = -1;
+}
+
+void FfmpegJob::submit(const QString& label) {
+    if (m_remote && m_remote->isConnected()) {
+        startRemote();
+        return;
+    }
+
+    JobScheduler *scheduler = JobScheduler::instance();
+    m_ticket = scheduler->submit("Comparison: " + label,
+                                 m_priority, m_threads,
+                                 [this](int threads) { launch(threads); });
+    if (scheduler->isQueued(m_ticket) && scheduler->runningCount() > 0)
+        emit logLine(QString("Queued behind %1 running job(s)...").arg(scheduler->runningCount()));
+}
+
+void FfmpegJob::setProxyMode(bool enabled, const QSize& size, bool vmaf) {
+    m_proxy     = enabled;
+    m_proxySize = QSize(qMax(16, size.width() & ~1), qMax(16, size.height() & ~1));
+    m_proxyVmaf = vmaf;
+}
+
+QString FfmpegJob::proxyLabel() const {
+    return m_proxy ? QString("%1x%2").arg(m_proxySize.width()).arg(m_proxySize.height()) : QString();
+}
+
+void FfmpegJob::setRemote(JobClient *client) {
+    if (m_remote) m_remote->disconnect(this);
+    m_remote = client;
+    if (!client) return;
+
+    connect(client, &JobClient::notification, this, &FfmpegJob::handleRemoteNotification);
+    connect(client, &JobClient::disconnected, this, [this]() {
+        if (!m_remoteActive) return;
+        m_remoteActive = false;
+        m_remoteJobId  = 0;
+        emit logLine("Lost connection to the job server.");
+        emit finished(false, -1);
+    });
+}
+
+void FfmpegJob::startRemote() {
+    m_remoteActive = true;
+    m_remoteJobId  = 0;
+    emit logLine("Submitting comparison to job server " + m_remote->address() + "...");
+
+    const QJsonValue distorted = m_comparisonFiles.size() == 1
+        ? QJsonValue(m_comparisonFiles.first())
+        : QJsonValue(QJsonArray::fromStringList(m_comparisonFiles));
+    QJsonObject params{
+        {"reference", m_originalFile}, {"distorted", distorted},
+        {"startTime", m_startTime},    {"duration",  m_duration},
+        {"priority",  m_priority},     {"threads",   m_threads},
+        {"stageTiming", m_stageTiming}, {"frameMetrics", m_collectFrameMetrics}
+    };
+    if (!m_gateRules.isEmpty()) params["gates"] = QualityGate::format(m_gateRules);
+    if (!m_windows.isEmpty()) {
+        QJsonArray windows;
+        for (const TimeWindow& w : std::as_const(m_windows))
+            windows.append(QJsonObject{{"start", w.start}, {"duration", w.duration}});
+        params["windows"] = windows;
+    }
+    if (m_autoCrop) params["autoCrop"] = true;
+    if (m_snapToKeyframes) params["snapToKeyframes"] = true;
+    if (m_referenceCache) params["referenceCache"] = true;
+    if (m_hashCheck != NoHashCheck) params["hashCheck"] = m_hashCheck == PacketAndFrameHash ? "frames" : "packets";
+    if (!m_extraMetrics.isEmpty()) params["metrics"] = QJsonArray::fromStringList(m_extraMetrics);
+    if (m_proxy) {
+        params["proxy"] = QJsonObject{{"width", m_proxySize.width()}, {"height", m_proxySize.height()},
+                                      {"vmaf", m_proxyVmaf}};
+    }
+    QPointer<FfmpegJob> self(this);
+    m_remote->call("compare", params, [self](const QJsonValue& result, const QString& error) {
+        if (!self) return;
+        if (!error.isEmpty()) {
+            self->m_remoteActive = false;
+            emit self->logLine("Job server error: " + error);
+            emit self->finished(false, -1);
+            return;
+        }
+        self->m_remoteJobId = result.toObject().value("jobId").toInt();
+    });
+}
+
+// Replays the server's notifications for our job through the usual signals
+void FfmpegJob::handleRemoteNotification(const QString& method, const QJsonObject& params) {
+    if (!m_remoteActive || params.value("jobId").toInt() != m_remoteJobId) return;
+
+    if (method == "job.log") {
+        emit logLine(params.value("line").toString());
+    } else if (method == "job.progress") {
+        m_currentTime   = params.value("current").toDouble();
+        m_totalDuration = params.value("total").toDouble();
+        emit progressUpdated(m_currentTime, m_totalDuration);
+    } else if (method == "job.ssim") {
+        emit ssimResult(JobProtocol::ssimFromJson(params.value("result").toObject()));
+    } else if (method == "job.psnr") {
+        emit psnrResult(JobProtocol::psnrFromJson(params.value("result").toObject()));
+    } else if (method == "job.vmaf") {
+        emit vmafResult(params.value("score").toDouble());
+    } else if (method == "job.comparison") {
+        const int index = params.value("index").toInt();
+        if (index >= 0 && index < m_results.size()) {
+            m_results[index] = JobProtocol::comparisonFromJson(params.value("result").toObject());
+            emit comparisonResult(index, m_results[index]);
+        }
+    } else if (method == "job.frames") {
+        emit frameMetricsReady(params.value("index").toInt(),
+                               JobProtocol::frameMetricsFromJson(params.value("metrics").toObject()));
+    } else if (method == "job.stats") {
+        emit statsReady(JobProtocol::jobStatsFromJson(params.value("stats").toObject()));
+    } else if (method == "job.finished") {
+        m_gateAborted  = params.value("gateAborted").toBool();
+        m_remoteActive = false;
+        m_remoteJobId  = 0;
+        emit finished(params.value("success").toBool(), params.value("exitCode").toInt());
+    }
+}
+
+// One reference decode feeds every comparison (slot) that uses it: the reference is
+// split M×N ways (M metrics, N slots), each distorted input M ways. Metric filters
+// are named "<filter>@c<i>" so their log lines ("[ssim@c1 @ 0x...] SSIM ...") can
+// be attributed to the right slot.
+QString FfmpegJob::buildFilterGraph(int threads, QStringList& outputs) const {
+    const int n = m_slots.size();
+    const bool vmaf = !m_proxy || m_proxyVmaf;
+    const int ways = vmaf ? 3 : 2;
+    QStringList chains;
+
+    // Proxy mode scales both sides before the split, so everything downstream runs at proxy size.
+    // The pixel format is pinned there too: one conversion per input (none when it already
+    // matches) instead of ffmpeg negotiating a conversion in every metric branch.
+    // The automatic crop comes first, so the proxy scale and every metric see only the picture.
+    QString prepare = m_crop.isEmpty() ? QString()
+        : QString("crop=%1:%2:%3:%4,").arg(m_crop.width()).arg(m_crop.height()).arg(m_crop.x()).arg(m_crop.y());
+    if (m_proxy)
+        prepare += QString("scale=%1:%2:flags=bilinear,").arg(m_proxySize.width()).arg(m_proxySize.height());
+    if (!m_workFormat.isEmpty()) prepare += QString("format=%1,").arg(m_workFormat);
+
+    QMap<int, QList<int>> slotsByReference;
+    for (int i = 0; i < n; ++i) slotsByReference[m_slots[i].reference] << i;
+    for (auto it = slotsByReference.cbegin(); it != slotsByReference.cend(); ++it) {
+        QString source = QString("[%1:v]").arg(it.key());
+        // The cached proxy gets the decoded frames as they are, before crop, scale or format
+        if (!m_cachePending.isEmpty() && it.key() == 0) {
+            chains << source + "split=2[rsrc][refcache]";
+            source = "[rsrc]";
+        }
+        QString refSplit = QString("%1%2split=%3").arg(source, prepare).arg(ways * it.value().size());
+        for (int i : it.value()) {
+            refSplit += QString("[r%1s][r%1p]").arg(i);
+            if (vmaf) refSplit += QString("[r%1v]").arg(i);
+        }
+        chains << refSplit;
+    }
+
+    // Per-frame logs use bare file names: ffmpeg runs inside the stats directory,
+    // which avoids escaping drive-letter colons in filter arguments
+    const bool stats = m_statsDir != nullptr;
+    // The phone model suits low-resolution pictures better than the 1080p default
+    const QString vmafModel = m_proxy ? QString(R"(:model='version=vmaf_v0.6.1\:enable_transform=true')") : QString();
+    // Extra feature extractors share libvmaf's frames; their scores only reach the csv log
+    const QString features = stats && !m_extraMetrics.isEmpty()
+        ? QString(":feature='%1'").arg(MetricSet::featureOption(m_extraMetrics)) : QString();
+
+    // Lower-resolution encodes are brought up to the reference's size before anything else
+    const QString upscale = m_distortedSize.isEmpty() ? QString()
+        : QString("scale=%1:%2:flags=bicubic,").arg(m_distortedSize.width()).arg(m_distortedSize.height());
+
+    for (int i = 0; i < n; ++i) {
+        const QString ssimOpts = stats ? QString("=stats_file=ssim%1.log").arg(i) : QString();
+        const QString psnrOpts = stats ? QString("=stats_file=psnr%1.log").arg(i) : QString();
+        const QString vmafLog  = stats ? QString(":log_fmt=csv:log_path=vmaf%1.csv").arg(i) : QString();
+        chains << QString("[%1:v]%2split=%3[d%4s][d%4p]%5")
+                      .arg(m_slots[i].distorted).arg(upscale + prepare).arg(ways).arg(i).arg(vmaf ? QString("[d%1v]").arg(i) : QString());
+        chains << QString("[d%1s][r%1s]ssim@c%1%2[ssim%1]").arg(i).arg(ssimOpts);
+        chains << QString("[d%1p][r%1p]psnr@c%1%2[psnr%1]").arg(i).arg(psnrOpts);
+        outputs << QString("[ssim%1]").arg(i) << QString("[psnr%1]").arg(i);
+        if (vmaf) {
+            chains << QString("[d%1v][r%1v]libvmaf@c%1=n_threads=%2%3%4%5[vmaf%1]")
+                          .arg(i).arg(threads).arg(vmafModel, features, vmafLog);
+            outputs << QString("[vmaf%1]").arg(i);
+        }
+    }
+    return chains.join(";");
+}
+
+void FfmpegJob::launch(int threads) {
+    m_launchUs = elapsedUs();
+    m_stats.threads = threads;
+    m_stats.queuedSeconds = m_launchUs / 1e6;
+
+    m_crop = QRect();
+    m_keyframesPlaced = false;
+
+    // Every later stage reads the inputs' formats from m_formats instead of blocking on ffprobe
+    m_formats.clear();
+    m_formatQueue.clear();
+    for (const Input& input : std::as_const(m_inputs))
+        if (!VideoUtils::isPipe(input.file) && !m_formatQueue.contains(input.file)) m_formatQueue << input.file;
+    probeNextFormat(threads);
+}
+
+// --- Format probe ---
+
+void FfmpegJob::probeNextFormat(int threads) {
+    if (m_formatQueue.isEmpty()) {
+        startHashCheck(threads);
+        return;
+    }
+    const QString file = m_formatQueue.takeFirst();
+
+    m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, threads, file](int exitCode, QProcess::ExitStatus status) {
+        const QByteArray output = m_process->readAllStandardOutput();
+        m_process->deleteLater();
+        m_process = nullptr;
+        if (prePassStopped(exitCode, status)) return;
+        // A file that can't be probed only loses what its format would have told
+        if (exitCode == 0) m_formats.insert(file, VideoUtils::parseFormatProbe(output));
+        probeNextFormat(threads);
+    });
+
+    m_process->start("ffprobe", VideoUtils::formatProbeArguments(file));
+    if (!m_process->waitForStarted()) {
+        m_process->deleteLater();
+        m_process = nullptr;
+        emit logLine("Warning: could not run ffprobe; input formats are unknown.");
+        m_formatQueue.clear();
+        startHashCheck(threads);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+// Remaining pre-passes run in order, each resuming here when it is done
+void FfmpegJob::launchScoring(int threads) {
+    if (m_snapToKeyframes && !m_keyframesPlaced) {
+        indexKeyframes();
+        indexNextFile(threads);
+        return;
+    }
+    if (m_autoCrop && !pipeInput().isEmpty()) {
+        emit logLine("Not cropping: " + pipeInput() + " is a pipe and can't be sampled ahead of the run.");
+        launchComparison(threads);
+    } else if (m_autoCrop) {
+        detectCrop(threads);
+    } else {
+        launchComparison(threads);
+    }
+}
+
+// First input that is a named pipe; pre-passes would consume its data
+QString FfmpegJob::pipeInput() const {
+    for (const Input& input : std::as_const(m_inputs))
+        if (VideoUtils::isPipe(input.file)) return input.file;
+    return QString();
+}
+
+// A pre-pass killed by cancel() or stopped by the supervisor ends the whole job. A
+// timeout sends SIGTERM, after which ffmpeg exits "normally" with 255, so the exit
+// status alone doesn't tell; the supervisor does.
+bool FfmpegJob::prePassStopped(int exitCode, QProcess::ExitStatus status) {
+    const bool timedOut = m_supervisor && m_supervisor->timedOut();
+    if (status == QProcess::NormalExit && !timedOut) return false;
+    if (timedOut) emit logLine("\nStopping ffmpeg: " + m_supervisor->stopReason());
+    releaseTicket();
+    emit finished(false, exitCode);
+    return true;
+}
+
+// --- Keyframe placement ---
+
+// Seeks further back than this are left alone: the extra frames would cost more
+// than the pre-roll they save
+static constexpr double MaxKeyframeSnapSeconds = 10.0;
+
+static double seekSeconds(const QString& seek) {
+    if (!seek.contains(':')) return seek.toDouble();
+    double seconds = 0;
+    for (const QString& part : seek.split(':')) seconds = seconds * 60 + part.toDouble();
+    return seconds;
+}
+
+void FfmpegJob::indexKeyframes() {
+    m_keyframeIndexes.clear();
+    m_indexQueue.clear();
+    for (const Input& input : std::as_const(m_inputs)) {
+        if (input.seek.isEmpty() || m_keyframeIndexes.contains(input.file) || m_indexQueue.contains(input.file))
+            continue;
+        // Indexing scans the whole file, which for a stream means reading all of it first
+        if (VideoUtils::isStreamInput(input.file)) continue;
+        KeyframeIndex index;
+        if (KeyframeIndex::load(input.file, index)) m_keyframeIndexes.insert(input.file, index);
+        else m_indexQueue << input.file;
+    }
+    if (!m_indexQueue.isEmpty())
+        emit logLine(QString("Indexing keyframes of %1 file(s); the index is kept for later runs...")
+                         .arg(m_indexQueue.size()));
+}
+
+void FfmpegJob::indexNextFile(int threads) {
+    if (m_indexQueue.isEmpty()) {
+        placeOnKeyframes();
+        m_keyframesPlaced = true;
+        launchScoring(threads);
+        return;
+    }
+    const QString file = m_indexQueue.takeFirst();
+
+    m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, threads, file](int exitCode, QProcess::ExitStatus status) {
+        const QByteArray output = m_process->readAllStandardOutput();
+        m_process->deleteLater();
+        m_process = nullptr;
+        if (prePassStopped(exitCode, status)) return;
+        const KeyframeIndex index = KeyframeIndex::fromProbeOutput(file, output);
+        if (exitCode == 0 && index.isValid()) {
+            index.save();
+            m_keyframeIndexes.insert(file, index);
+            emit logLine(QString("  %1: %2 keyframes in %3 packets")
+                             .arg(QFileInfo(file).fileName()).arg(index.keyframes.size()).arg(index.packetCount));
+        } else {
+            emit logLine("Warning: could not index keyframes of " + QFileInfo(file).fileName());
+        }
+        indexNextFile(threads);
+    });
+
+    m_process->start("ffprobe", KeyframeIndex::probeArguments(file));
+    if (!m_process->waitForStarted()) {
+        m_process->deleteLater();
+        m_process = nullptr;
+        emit logLine("Warning: could not run ffprobe; seeking without the keyframe index.");
+        m_indexQueue.clear();
+        m_keyframeIndexes.clear();
+        indexNextFile(threads);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+// Inputs with the same seek form one range (the reference and the encodes of a plain
+// run, or one window's pair); each range moves as a whole so its inputs stay aligned.
+void FfmpegJob::placeOnKeyframes() {
+    QMap<QString, QList<int>> ranges;
+    for (int i = 0; i < m_inputs.size(); ++i)
+        if (!m_inputs[i].seek.isEmpty()) ranges[m_inputs[i].seek] << i;
+
+    for (auto it = ranges.cbegin(); it != ranges.cend(); ++it) {
+        const double seek = seekSeconds(it.key());
+        QList<KeyframeIndex> indexes;
+        for (int i : it.value()) {
+            if (!m_keyframeIndexes.contains(m_inputs[i].file)) { indexes.clear(); break; }
+            indexes << m_keyframeIndexes.value(m_inputs[i].file);
+        }
+        if (indexes.isEmpty()) continue;
+
+        const double keyframe = KeyframeIndex::commonKeyframeBefore(indexes, seek, MaxKeyframeSnapSeconds);
+        if (keyframe < 0) {
+            emit logLine(QString("No shared keyframe within %1 s before %2; seeking as requested.")
+                             .arg(MaxKeyframeSnapSeconds).arg(seek, 0, 'f', 3));
+            continue;
+        }
+        const double shift = seek - keyframe;
+        if (shift < 0.001) continue;
+
+        for (int i : it.value()) {
+            Input& input = m_inputs[i];
+            input.seek = QString::number(keyframe, 'f', 3);
+            if (!input.length.isEmpty()) input.length = QString::number(seekSeconds(input.length) + shift, 'f', 3);
+        }
+        for (int s = 0; s < m_slots.size(); ++s) {
+            if (!it.value().contains(m_slots[s].distorted)) continue;
+            m_slots[s].start = keyframe;
+            if (s < m_windows.size()) {
+                m_windows[s].start = keyframe;
+                m_windows[s].duration += shift;
+                m_results[s].window = m_windows[s].label();
+                m_totalDuration = qMax(m_totalDuration, m_windows[s].duration);
+            }
+        }
+        if (m_windows.isEmpty() && m_totalDuration > 0) m_totalDuration += shift;
+        emit logLine(QString("Starting at keyframe %1 s instead of %2 s (no pre-roll to discard)")
+                         .arg(keyframe, 0, 'f', 3).arg(seek, 0, 'f', 3));
+    }
+}
+
+// --- Hash pre-check ---
+
+void FfmpegJob::startHashCheck(int threads) {
+    if (m_hashCheck != NoHashCheck && !pipeInput().isEmpty()) {
+        emit logLine("Skipping the identical-input check: " + pipeInput() + " is a pipe and can only be read once.");
+    } else if (m_hashCheck != NoHashCheck) {
+        emit logLine("Checking whether the inputs are identical to the reference...");
+        m_hashingFrames = false;
+        m_inputHashes.clear();
+        hashNextInput(threads);
+        return;
+    }
+    launchScoring(threads);
+}
+
+// Hashes m_inputs one at a time over the same -ss/-t range the comparison uses.
+// Stream copy leaves timestamps out of the hash, so a remux into another container
+// still matches as long as the packets themselves are unchanged.
+void FfmpegJob::hashNextInput(int threads) {
+    const int index = m_inputHashes.size();
+    if (index == m_inputs.size()) {
+        finishHashCheck(threads);
+        return;
     }
+    const Input& input = m_inputs[index];
+    QStringList arguments{"-v", "error", "-threads", QString::number(threads)};
+    if (!input.seek.isEmpty())   arguments << "-ss" << input.seek;
+    if (!input.length.isEmpty()) arguments << "-t"  << input.length;
+    arguments << VideoUtils::inputOptions(input.file) << "-i" << input.file << "-map" << "0:v:0";
+    if (!m_hashingFrames) arguments << "-c" << "copy";
+    arguments << "-f" << "hash" << "-hash" << "sha256" << "-";
 
+    m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, threads](int exitCode, QProcess::ExitStatus status) {
+        // Output is a single "SHA256=<hex>" line written at the end
+        const QString output = QString::fromLocal8Bit(m_process->readAllStandardOutput()).trimmed();
+        m_process->deleteLater();
+        m_process = nullptr;
+        if (prePassStopped(exitCode, status)) return;
+        m_inputHashes << (exitCode == 0 && output.startsWith("SHA256=") ? output.mid(7) : QString());
+        hashNextInput(threads);
+    });
+
+    m_process->start("ffmpeg", arguments);
+    if (!m_process->waitForStarted()) {
+        m_process->deleteLater();
+        m_process = nullptr;
+        emit logLine("Warning: could not run the hash check; scoring normally.");
+        launchScoring(threads);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+void FfmpegJob::finishHashCheck(int threads) {
+    int identical = 0;
+    for (const Slot& slot : std::as_const(m_slots)) {
+        const QString reference = m_inputHashes.value(slot.reference);
+        if (!reference.isEmpty() && reference == m_inputHashes.value(slot.distorted)) ++identical;
+    }
+    if (identical == m_slots.size()) {
+        emitIdenticalResults();
+        return;
+    }
+    if (!m_hashingFrames && m_hashCheck == PacketAndFrameHash) {
+        emit logLine("Video packets differ; comparing decoded frame hashes...");
+        m_hashingFrames = true;
+        m_inputHashes.clear();
+        hashNextInput(threads);
+        return;
+    }
+    // Slots can't be dropped from the shared graph, so a partial match still scores everything
+    if (identical > 0)
+        emit logLine(QString("%1 of %2 inputs are identical to the reference; scoring all of them.")
+                         .arg(identical).arg(m_slots.size()));
+    else
+        emit logLine("Inputs differ from the reference; running the full comparison.");
+    launchScoring(threads);
+}
+
+// Identical streams score perfectly by definition: SSIM 1, PSNR infinite, VMAF 100
+void FfmpegJob::emitIdenticalResults() {
+    const QString how = m_hashingFrames ? QString("identical decoded frames") : QString("bit-identical video packets");
+    emit logLine("Every input has " + how + "; skipping the metrics.");
+    if (!m_extraMetrics.isEmpty()) emit logLine("Note: extra metrics are not reported for identical streams.");
+
+    const SsimResult ssim{1.0, 1.0, 1.0, 1.0, "inf", "inf", "inf", "inf"};
+    const PsnrResult psnr{"inf", "inf", "inf", "inf"};
+    const bool vmaf = !m_proxy || m_proxyVmaf;
+    for (int i = 0; i < m_results.size(); ++i) {
+        ComparisonResult& r = m_results[i];
+        r.hasSsim = r.hasPsnr = true;
+        r.ssim = ssim;
+        r.psnr = psnr;
+        r.hasVmaf = vmaf;
+        r.vmaf = 100.0;
+        r.identical = how;
+        r.bitrateKbps = m_formats.value(m_inputs.value(m_slots.value(i).distorted).file).bitrateKbps;
+        if (!m_gateRules.isEmpty()) {
+            r.hasGate = true;
+            r.gatePassed = true;
+            r.gateDetail = "identical to the reference";
+        }
+    }
+
+    releaseTicket();
+    finishStats(elapsedUs());
+    if (m_results.size() == 1) {
+        emit ssimResult(ssim);
+        emit psnrResult(psnr);
+        if (vmaf) emit vmafResult(100.0);
+    }
+    emitComparisonResults();
+    emitCombinedWindows();
+    emit statsReady(m_stats);
+    emit finished(true, 0);
+}
+
+// --- Automatic cropping ---
+
+// Samples of the reference handed to cropdetect, and how long each one is
+static constexpr int CropSamples = 3;
+static constexpr double CropSampleSeconds = 2.0;
+
+// One ffmpeg run seeks to every sample of the reference and runs a cropdetect per
+// sample; reset=0 makes each report the bounding box of everything it has seen.
+// Runs on the comparison's scheduler slot, before the comparison itself.
+void FfmpegJob::detectCrop(int threads) {
+    const QString reference = m_inputs.value(m_slots.value(0).reference).file;
+
+    // Sample where the comparison will look: inside each window, or spread over the range
+    QList<double> starts;
+    if (!m_windows.isEmpty()) {
+        const int step = qMax(1, int(m_windows.size()) / CropSamples);
+        for (int w = 0; w < m_windows.size() && starts.size() < CropSamples; w += step)
+            starts << m_windows[w].start + qMax(0.0, m_windows[w].duration / 2 - CropSampleSeconds / 2);
+    } else {
+        const double base = m_slots.value(0).start;
+        double length = m_totalDuration;
+        if (length <= 0) length = m_formats.value(reference).durationSeconds - base;
+        if (length <= CropSampleSeconds * CropSamples) starts << base;
+        else for (int k = 1; k <= CropSamples; ++k) starts << base + length * k / (CropSamples + 1);
+    }
+
+    const QString threadArg = QString::number(threads);
+    QStringList arguments;
+    QStringList chains;
+    for (int k = 0; k < starts.size(); ++k) {
+        arguments << "-threads" << threadArg
+                  << "-ss" << QString::number(starts[k], 'f', 3)
+                  << "-t" << QString::number(CropSampleSeconds, 'f', 3)
+                  << VideoUtils::inputOptions(reference) << "-i" << reference;
+        chains << QString("[%1:v]cropdetect@s%1=limit=24:round=2:reset=0[s%1]").arg(k);
+    }
+    arguments << "-filter_complex" << chains.join(";");
+    for (int k = 0; k < starts.size(); ++k) arguments << "-map" << QString("[s%1]").arg(k);
+    arguments << "-f" << "null" << "-";
+
+    emit logLine(QString("Detecting black bars in %1 sample(s) of the reference...").arg(starts.size()));
+    emit logLine("ffmpeg " + arguments.join(" "));
+
+    m_cropOutput.clear();
+    m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_process, &QProcess::readyReadStandardError, this, [this]() {
+        m_cropOutput += QString::fromLocal8Bit(m_process->readAllStandardError());
+    });
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this, threads](int exitCode, QProcess::ExitStatus status) {
+        finishCropDetection(threads, exitCode, status);
+    });
+
+    m_process->start("ffmpeg", arguments);
+    if (!m_process->waitForStarted()) {
+        m_process->deleteLater();
+        m_process = nullptr;
+        emit logLine("Warning: could not run cropdetect; scoring the full frame.");
+        launchComparison(threads);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+void FfmpegJob::finishCropDetection(int threads, int exitCode, QProcess::ExitStatus status) {
+    m_process->deleteLater();
+    m_process = nullptr;
+    if (prePassStopped(exitCode, status)) return;
+
+    // Last report of each sample, e.g. "[cropdetect@s1 @ 0x...] x1:0 ... crop=1920:800:0:140"
+    static const QRegularExpression cropRx(R"(cropdetect@s(\d+) @ [^\]]*\].*crop=(\d+):(\d+):(\d+):(\d+))");
+    QMap<int, QRect> samples;
+    for (const QString& line : m_cropOutput.split('\n')) {
+        const QRegularExpressionMatch m = cropRx.match(line);
+        if (m.hasMatch())
+            samples[m.captured(1).toInt()] = QRect(m.captured(4).toInt(), m.captured(5).toInt(),
+                                                   m.captured(2).toInt(), m.captured(3).toInt());
+    }
+    m_cropOutput.clear();
+
+    // The samples agree on their union: nothing any of them saw as picture is cut
+    QRect crop;
+    for (const QRect& rect : std::as_const(samples)) crop = crop.united(rect);
+
+    // Crop rectangles only mean the same thing on inputs of the same size. Sizes come from
+    // the format pre-pass; an input it couldn't probe counts as a different size.
+    auto sizeOf = [this](const QString& file) {
+        const VideoUtils::VideoFormat format = m_formats.value(file);
+        return QSize(format.width, format.height);
+    };
+    const QSize frame = sizeOf(m_inputs.value(m_slots.value(0).reference).file);
+
+    QString skip;
+    if (exitCode != 0 || crop.isEmpty() || !frame.isValid())
+        skip = "cropdetect found nothing usable";
+    else if (double(crop.width()) * crop.height() > 0.98 * frame.width() * frame.height())
+        skip = "no significant black bars";
+    for (int i = 0; i < m_inputs.size() && skip.isEmpty(); ++i) {
+        if (m_inputs[i].file != m_inputs[0].file && sizeOf(m_inputs[i].file) != frame)
+            skip = "inputs differ in resolution";
+    }
+
+    if (skip.isEmpty()) {
+        m_crop = crop;
+        const QString label = QString("%1x%2+%3+%4").arg(crop.width()).arg(crop.height()).arg(crop.x()).arg(crop.y());
+        emit logLine(QString("Cropping every input to %1 (%2% of the frame)")
+                         .arg(label).arg(100.0 * crop.width() * crop.height() / (frame.width() * frame.height()), 0, 'f', 1));
+        for (ComparisonResult& r : m_results) r.crop = label;
+    } else {
+        emit logLine("Not cropping: " + skip + ".");
+    }
+    launchComparison(threads);
+}
+
+// Cached proxies replace their masters as inputs. Without one, a run that decodes the
+// whole reference writes its proxy on the side; windowed or seeked runs only see part
+// of it, so they never write one.
+void FfmpegJob::useReferenceCache() {
+    QList<int> references;
+    for (const Slot& slot : std::as_const(m_slots))
+        if (!references.contains(slot.reference)) references << slot.reference;
+
+    bool cached = false;
+    for (int i : references) {
+        const QString proxy = ReferenceCache::lookup(m_inputs[i].file);
+        if (proxy.isEmpty()) continue;
+        if (!cached) emit logLine("Reading the reference from its cached lossless proxy: " + proxy);
+        // FFV1 in passthrough keeps the master's pixel format and transfer
+        m_formats.insert(proxy, m_formats.value(m_inputs[i].file));
+        m_inputs[i].file = proxy;
+        cached = true;
+    }
+    const Input& reference = m_inputs.value(0);
+    if (cached || !m_windows.isEmpty() || !reference.seek.isEmpty() || !reference.length.isEmpty()
+        || !QFileInfo(reference.file).isFile())
+        return;
+
+    m_cachePending = ReferenceCache::reservePending(reference.file);
+    if (m_cachePending.isEmpty()) {
+        emit logLine("Not caching the reference: another job is already writing its proxy.");
+        return;
+    }
+    m_cacheSource = reference.file;
+    emit logLine("Writing a lossless proxy of the reference to the cache during this run.");
+}
+
+void FfmpegJob::launchComparison(int threads) {
     // Build ffmpeg argument list
+    const QString threadArg = QString::number(threads);
     QStringList arguments;
 
-    if (!startTime.isEmpty()) arguments << "-ss" << startTime;
-    if (!duration.isEmpty())  arguments << "-t"  << duration;
-    arguments << "-i" << originalFile;
+    ReferenceCache::discard(m_cachePending);
+    m_cacheSource.clear();
+    m_cachePending.clear();
+    if (m_referenceCache) useReferenceCache();
+
+    // -benchmark adds a CPU/maxrss summary at exit; -benchmark_all adds per-frame stage lines
+    arguments << "-benchmark";
+    if (m_stageTiming) arguments << "-benchmark_all";
+
+    m_statsDir.reset();
+    m_frameRate = 0.0;
+    const bool extras = !m_extraMetrics.isEmpty() && (!m_proxy || m_proxyVmaf);
+    if (!m_extraMetrics.isEmpty() && !extras)
+        emit logLine("Note: extra metrics need VMAF, which this proxy run leaves out; skipping them.");
+    // Gates and the extra metrics read the per-frame stats files too
+    if (m_collectFrameMetrics || !m_gateRules.isEmpty() || extras) {
+        m_statsDir = std::make_unique<QTemporaryDir>();
+        if (!m_statsDir->isValid()) {
+            emit logLine("Warning: no temporary directory for per-frame metrics; collecting averages only.");
+            m_statsDir.reset();
+        }
+    }
+
+    m_ssimTails.clear();
+    m_psnrTails.clear();
+    if (m_statsDir && !m_gateRules.isEmpty()) {
+        for (int i = 0; i < m_slots.size(); ++i) {
+            m_ssimTails << StatsFileTail(m_statsDir->filePath(QString("ssim%1.log").arg(i)));
+            m_psnrTails << StatsFileTail(m_statsDir->filePath(QString("psnr%1.log").arg(i)));
+        }
+    }
 
-    if (!startTime.isEmpty()) arguments << "-ss" << startTime;
-    if (!duration.isEmpty())  arguments << "-t"  << duration;
-    arguments << "-i" << comparisonFile;
+    for (const Input& input : std::as_const(m_inputs)) {
+        arguments << "-threads" << threadArg;
+        // Proxy pictures are downscaled anyway; deblocking is wasted decode work
+        if (m_proxy) arguments << "-skip_loop_filter" << "all";
+        if (!input.seek.isEmpty())   arguments << "-ss" << input.seek;
+        if (!input.length.isEmpty()) arguments << "-t"  << input.length;
+        arguments << VideoUtils::inputOptions(input.file);
+        // The process may run in the stats directory, so relative paths must be resolved here
+        arguments << "-i" << (QFileInfo::exists(input.file) ? QFileInfo(input.file).absoluteFilePath() : input.file);
+    }
 
-    QString filterComplex =
-        "[0:v]split=3[ref1][ref2][ref3];"
-        "[1:v]split=3[main1][main2][main3];"
-        "[main1][ref1]ssim[stats_ssim];"
-        "[main2][ref2]psnr[stats_psnr];"
-        "[main3][ref3]libvmaf";
+    chooseWorkFormat();
+    QStringList outputs;
+    const QString filterComplex = buildFilterGraph(threads, outputs);
 
-    arguments << "-filter_complex" << filterComplex
-              << "-map" << "[stats_ssim]"
-              << "-map" << "[stats_psnr]"
-              << "-f"   << "null" << "-";
+    arguments << "-filter_complex_threads" << threadArg
+              << "-filter_complex" << filterComplex;
+    for (const QString& output : outputs) arguments << "-map" << output;
+    arguments << "-f" << "null" << "-";
+    if (!m_cachePending.isEmpty())
+        arguments << "-map" << "[refcache]" << ReferenceCache::encoderArguments(threads) << "-y" << m_cachePending;
 
     emit logLine("Running command:");
     emit logLine("ffmpeg " + arguments.join(" "));
     emit logLine("\n" + QString("-").repeated(80) + "\n");
 
     m_process = new QProcess(this);
+    m_supervisor = JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_supervisor, &ProcessSupervisor::timeoutExpired, this, [this](const QString& reason) {
+        emit logLine("\nStopping ffmpeg: " + reason);
+    });
+    if (m_statsDir) m_process->setWorkingDirectory(m_statsDir->path());
 
     connect(m_process, &QProcess::readyReadStandardOutput, this, [this]() {
         emit logLine(QString::fromLocal8Bit(m_process->readAllStandardOutput()));
@@ -81,21 +953,361 @@ void FfmpegJob::start(const QString& originalFile, const QString& comparisonFile
     connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this, [this](int exitCode, QProcess::ExitStatus status) {
         bool success = (status == QProcess::NormalExit && exitCode == 0);
-        emit finished(success, exitCode);
+        const qint64 exitUs = elapsedUs();
+        m_sampleTimer.stop();
+        m_gateTimer.stop();
+        // Whole-tree figures where /proc sampling isn't available (Windows Job Objects)
+        if (m_stats.sampledCpuSeconds < 0) m_stats.sampledCpuSeconds = m_supervisor->cpuSeconds();
+        if (m_stats.sampledPeakRssKiB < 0) m_stats.sampledPeakRssKiB = m_supervisor->peakRssKiB();
+        // Detach first: a finished() handler may immediately start() the next run
         m_process->deleteLater();
         m_process = nullptr;
+        releaseTicket();
+        if (!m_lineBuffer.isEmpty()) parseLine(m_lineBuffer);
+        m_lineBuffer.clear();
+        // A run stopped by its gates still has per-frame data up to the failure
+        QVector<FrameMetrics> frames;
+        if (success || m_gateAborted) frames = loadFrameMetrics();
+        if (m_collectFrameMetrics) {
+            for (int i = 0; i < frames.size(); ++i)
+                if (!frames[i].isEmpty()) emit frameMetricsReady(i, frames[i]);
+        }
+        if (success || m_gateAborted) finishGates(frames);
+        if (!m_cachePending.isEmpty()) {
+            // A run stopped early (gates, cancel, timeout) has only part of the reference
+            QString message = "the comparison did not finish";
+            if (success && !m_gateAborted && ReferenceCache::commit(m_cacheSource, m_cachePending, &message))
+                emit logLine("Reference proxy cached (" + message + ").");
+            else
+                emit logLine("Reference proxy not cached: " + message + ".");
+            ReferenceCache::discard(m_cachePending);
+            m_cachePending.clear();
+        }
+        if (success) loadExtraMetrics();
+        m_statsDir.reset();
+        finishStats(exitUs);
+        emitComparisonResults();
+        emitCombinedWindows();
+        emit statsReady(m_stats);
+        emit finished(success, exitCode);
     });
 
     m_process->start("ffmpeg", arguments);
     if (!m_process->waitForStarted()) {
-        emit finished(false, -1);
         m_process->deleteLater();
         m_process = nullptr;
+        releaseTicket();
+        emit finished(false, -1);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+    m_lastSampleUs  = elapsedUs();
+    m_lastSampleCpu = 0;
+    m_sampleTimer.start();
+    if (!m_ssimTails.isEmpty()) m_gateTimer.start();
+    emit processStarted(m_process->processId());
+}
+
+void FfmpegJob::sampleProcess() {
+    if (!m_process) return;
+    ProcessStats::Sample sample;
+    if (!ProcessStats::sample(m_process->processId(), sample)) {
+        m_sampleTimer.stop();   // unsupported platform: don't keep trying
+        return;
+    }
+    const qint64 now = elapsedUs();
+    if (sample.cpuSeconds >= 0) {
+        const double interval = (now - m_lastSampleUs) / 1e6;
+        ResourceSample r;
+        r.timeUs     = now;
+        r.cpuPercent = interval > 0 ? 100.0 * (sample.cpuSeconds - m_lastSampleCpu) / interval : 0.0;
+        r.rssKiB     = sample.rssKiB;
+        m_stats.samples << r;
+        m_stats.sampledCpuSeconds = sample.cpuSeconds;
+        m_lastSampleCpu = sample.cpuSeconds;
+        m_lastSampleUs  = now;
+    }
+    m_stats.sampledPeakRssKiB = qMax(m_stats.sampledPeakRssKiB, sample.peakRssKiB);
+}
+
+// Turns the clock marks into phases. Phase events go in front of the stage events
+// so they survive the MaxTraceEvents cap.
+void FfmpegJob::finishStats(qint64 exitUs) {
+    const qint64 first = m_firstProgressUs >= 0 ? m_firstProgressUs : exitUs;
+    const qint64 last  = m_lastProgressUs  >= 0 ? m_lastProgressUs  : exitUs;
+    const qint64 done  = elapsedUs();
+    m_stats.wallSeconds       = (exitUs - m_launchUs) / 1e6;
+    m_stats.startupSeconds    = (first - m_launchUs) / 1e6;
+    m_stats.processingSeconds = (last - first) / 1e6;
+    m_stats.finalizeSeconds   = (exitUs - last) / 1e6;
+    m_stats.postSeconds       = (done - exitUs) / 1e6;
+
+    const QVector<TraceEvent> phases{
+        {"queued",           "job", 0,          m_launchUs},
+        {"startup",          "job", m_launchUs, first - m_launchUs},
+        {"processing",       "job", first,      last - first},
+        {"finalize",         "job", last,       exitUs - last},
+        {"read frame logs",  "job", exitUs,     done - exitUs},
+    };
+    m_stats.events = phases + m_stats.events;
+}
+
+void FfmpegJob::emitComparisonResults() {
+    for (int i = 0; i < m_results.size(); ++i)
+        emit comparisonResult(i, m_results[i]);
+}
+
+// Metrics run in planar YUV at the highest bit depth of any input and the reference's
+// chroma subsampling, so 10/12-bit sources are never truncated to 8 bits. ssim, psnr and
+// libvmaf all take 8/10/12/16-bit planar YUV natively. Formats come from the probe
+// pre-pass; a file that couldn't be probed only loses the explicit format.
+void FfmpegJob::chooseWorkFormat() {
+    auto formatOf = [this](const QString& file) { return m_formats.value(file); };
+
+    VideoUtils::VideoFormat reference;
+    int depth = 8;
+    bool transferMismatch = false;
+    for (const Slot& slot : std::as_const(m_slots)) {
+        const VideoUtils::VideoFormat ref  = formatOf(m_inputs[slot.reference].file);
+        const VideoUtils::VideoFormat dist = formatOf(m_inputs[slot.distorted].file);
+        if (!reference.isValid()) reference = ref;
+        depth = qMax(depth, qMax(ref.bitDepth, dist.bitDepth));
+        if (ref.isValid() && dist.isValid() && ref.transfer != dist.transfer) transferMismatch = true;
+    }
+
+    for (int i = 0; i < m_results.size() && i < m_slots.size(); ++i)
+        m_results[i].bitrateKbps = formatOf(m_inputs[m_slots[i].distorted].file).bitrateKbps;
+
+    m_workFormat.clear();
+    if (!reference.isValid()) {
+        emit logLine("Warning: could not probe the reference pixel format; leaving format conversion to ffmpeg.");
+        return;
+    }
+    // 9- and 14-bit sources are rounded up to a depth the metric filters accept
+    depth = depth <= 8 ? 8 : depth <= 10 ? 10 : depth <= 12 ? 12 : 16;
+    m_workFormat = VideoUtils::planarYuvFormat(reference.chroma, depth);
+
+    emit logLine(QString("Metrics computed in %1 (%2-bit), transfer %3")
+                     .arg(m_workFormat).arg(depth).arg(VideoUtils::transferLabel(reference.transfer)));
+    for (auto it = probed.cbegin(); it != probed.cend(); ++it) {
+        if (it.value().isValid() && it.value().pixelFormat != m_workFormat)
+            emit logLine(QString("  %1: %2 converted once before the metrics")
+                             .arg(QFileInfo(it.key()).fileName(), it.value().pixelFormat));
+    }
+    if (transferMismatch)
+        emit logLine("Warning: reference and comparison use different transfer characteristics; "
+                     "scores compare the coded signals as they are.");
+    if (reference.isHdr())
+        emit logLine("Note: HDR input is scored on the " + VideoUtils::transferLabel(reference.transfer) +
+                     "-coded signal; VMAF models are trained on SDR content.");
+
+    for (ComparisonResult& r : m_results) {
+        r.pixelFormat = m_workFormat;
+        r.bitDepth    = depth;
+        r.transfer    = reference.transfer;
+    }
+}
+
+// Duration-weighted combination of the windows: SSIM and VMAF are averaged, PSNR is
+// pooled through MSE (as ffmpeg averages frames), so a window with inf dB counts as
+// error-free rather than making the whole result inf.
+void FfmpegJob::emitCombinedWindows() {
+    if (m_windows.size() < 2 || m_results.size() != m_windows.size()) return;
+
+    auto toMse = [](const QString& db) { return db == "inf" ? 0.0 : std::pow(10.0, -db.toDouble() / 10.0); };
+    auto toDb  = [](double mse) { return mse <= 0 ? QString("inf") : QString::number(-10.0 * std::log10(mse), 'f', 6); };
+    auto ssimDb = [](double ssim) { return ssim >= 1.0 ? QString("inf") : QString::number(-10.0 * std::log10(1.0 - ssim), 'f', 6); };
+
+    double ssimWeight = 0, psnrWeight = 0, vmafWeight = 0;
+    SsimResult ssim;
+    double mseY = 0, mseU = 0, mseV = 0, mseAvg = 0, vmaf = 0;
+    for (int i = 0; i < m_results.size(); ++i) {
+        const ComparisonResult& r = m_results[i];
+        const double w = m_windows[i].duration;
+        if (r.hasSsim) {
+            ssim.y += w * r.ssim.y; ssim.u += w * r.ssim.u; ssim.v += w * r.ssim.v; ssim.all += w * r.ssim.all;
+            ssimWeight += w;
+        }
+        if (r.hasPsnr) {
+            mseY += w * toMse(r.psnr.yDb); mseU += w * toMse(r.psnr.uDb);
+            mseV += w * toMse(r.psnr.vDb); mseAvg += w * toMse(r.psnr.avgDb);
+            psnrWeight += w;
+        }
+        if (r.hasVmaf) {
+            vmaf += w * r.vmaf;
+            vmafWeight += w;
+        }
+    }
+    if (ssimWeight > 0) {
+        ssim.y /= ssimWeight; ssim.u /= ssimWeight; ssim.v /= ssimWeight; ssim.all /= ssimWeight;
+        ssim.yDb = ssimDb(ssim.y); ssim.uDb = ssimDb(ssim.u); ssim.vDb = ssimDb(ssim.v); ssim.allDb = ssimDb(ssim.all);
+        emit ssimResult(ssim);
+    }
+    if (psnrWeight > 0) {
+        PsnrResult psnr;
+        psnr.yDb = toDb(mseY / psnrWeight); psnr.uDb = toDb(mseU / psnrWeight);
+        psnr.vDb = toDb(mseV / psnrWeight); psnr.avgDb = toDb(mseAvg / psnrWeight);
+        emit psnrResult(psnr);
+    }
+    if (vmafWeight > 0) emit vmafResult(vmaf / vmafWeight);
+}
+
+QVector<FrameMetrics> FfmpegJob::loadFrameMetrics() const {
+    QVector<FrameMetrics> frames(m_results.size());
+    if (!m_statsDir) return frames;
+    const QString dir = m_statsDir->path() + "/";
+
+    for (int i = 0; i < m_results.size(); ++i) {
+        FrameMetrics& metrics = frames[i];
+        metrics.ssim      = FrameMetricsIO::loadSsimStats(dir + QString("ssim%1.log").arg(i));
+        metrics.psnr      = FrameMetricsIO::loadPsnrStats(dir + QString("psnr%1.log").arg(i));
+        metrics.vmaf      = FrameMetricsIO::loadVmafCsv(dir + QString("vmaf%1.csv").arg(i));
+        metrics.frameRate = m_frameRate;
+        metrics.startTime = m_slots.value(i).start;
+    }
+    return frames;
+}
+
+// Means of the extra libvmaf features, read from each input's csv log
+void FfmpegJob::loadExtraMetrics() {
+    if (!m_statsDir || m_extraMetrics.isEmpty()) return;
+    QStringList columns;
+    for (const QString& id : std::as_const(m_extraMetrics))
+        if (const ExtraMetric *m = MetricSet::find(id)) columns << m->column;
+
+    for (int i = 0; i < m_results.size(); ++i) {
+        const QMap<QString, double> means =
+            FrameMetricsIO::csvColumnMeans(m_statsDir->filePath(QString("vmaf%1.csv").arg(i)), columns);
+        ComparisonResult& r = m_results[i];
+        r.extra.clear();
+        for (const QString& id : std::as_const(m_extraMetrics)) {
+            const ExtraMetric *m = MetricSet::find(id);
+            if (!m || !means.contains(m->column)) continue;
+            r.extra << MetricScore{m->id, m->label, m->unit, means.value(m->column), m->decimals};
+        }
+        if (r.extra.size() < columns.size())
+            emit logLine(QString("Warning: libvmaf did not report every requested metric for %1 "
+                                 "(needs a libvmaf build with those feature extractors).")
+                             .arg(QFileInfo(r.file).fileName()));
+    }
+}
+
+// Feeds the stats lines written since the last poll into each input's gate and
+// stops the run once every input has failed.
+void FfmpegJob::pollGates() {
+    if (!m_process || m_gateAborted) return;
+    if (m_gates.isEmpty()) {
+        // Window lengths are in seconds; ffmpeg prints the frame rate before the first frame
+        if (m_frameRate <= 0) return;
+        for (int i = 0; i < m_results.size(); ++i) m_gates << QualityGate(m_gateRules, m_frameRate, m_slots.value(i).start);
+    }
+
+    int failed = 0;
+    for (int i = 0; i < m_gates.size(); ++i) {
+        QualityGate& gate = m_gates[i];
+        const bool wasFailed = gate.failed();
+        const double length = m_windows.isEmpty() ? m_totalDuration : m_windows.value(i).duration;
+        gate.setExpectedFrames(int(length * m_frameRate));
+        float v = 0;
+        for (const QByteArray& line : m_ssimTails[i].readLines())
+            if (FrameMetricsIO::parseSsimLine(line, v)) gate.addFrame(FrameMetrics::Ssim, v);
+        for (const QByteArray& line : m_psnrTails[i].readLines())
+            if (FrameMetricsIO::parsePsnrLine(line, v)) gate.addFrame(FrameMetrics::Psnr, v);
+        if (gate.failed() && !wasFailed)
+            emit logLine(QString("Quality gate %1: %2").arg(QFileInfo(m_results[i].file).fileName(),
+                                                            gate.verdict().message()));
+        if (gate.failed()) ++failed;
+    }
+
+    if (failed == m_gates.size()) {
+        m_gateAborted = true;
+        m_gateTimer.stop();
+        emit logLine("Every input has failed a quality gate; stopping early.");
+        // SIGTERM lets ffmpeg close its filters, so the per-frame logs are complete
+        if (m_supervisor) m_supervisor->terminate("quality gate failed");
+        else ProcessSupervisor::killTree(m_process);
+    }
+}
+
+void FfmpegJob::finishGates(const QVector<FrameMetrics>& frames) {
+    if (m_gateRules.isEmpty()) return;
+    for (int i = m_gates.size(); i < m_results.size(); ++i)
+        m_gates << QualityGate(m_gateRules, m_frameRate, m_slots.value(i).start);
+
+    for (int i = 0; i < m_results.size(); ++i) {
+        QualityGate& gate = m_gates[i];
+        ComparisonResult& r = m_results[i];
+        if (r.hasSsim) gate.setOverall(FrameMetrics::Ssim, r.ssim.all);
+        if (r.hasPsnr) gate.setOverall(FrameMetrics::Psnr, r.psnr.avgDb == "inf"
+                                       ? std::numeric_limits<double>::infinity() : r.psnr.avgDb.toDouble());
+        if (r.hasVmaf) gate.setOverall(FrameMetrics::Vmaf, r.vmaf);
+        const GateVerdict& verdict = gate.finish(frames.value(i));
+        r.hasGate    = true;
+        r.gatePassed = !verdict.failed;
+        r.gateDetail = verdict.message();
     }
 }
 
 void FfmpegJob::parseStderr(const QString& text) {
-    emit logLine(text);
+    if (m_stageTiming) {
+        // Per-frame stage lines would bury the rest of the log; they are summarized in statsReady()
+        static QRegularExpression stageLineRx(R"(^bench: +\d+ user[^\n]*\n?)",
+                                              QRegularExpression::MultilineOption);
+        QString shown = text;
+        shown.remove(stageLineRx);
+        if (!shown.isEmpty()) emit logLine(shown);
+    } else {
+        emit logLine(text);
+    }
+
+    // Reassemble lines across reads; progress lines end in '\r', the rest in '\n'
+    m_lineBuffer += text;
+    int start = 0;
+    for (int i = 0; i < m_lineBuffer.size(); ++i) {
+        const QChar c = m_lineBuffer.at(i);
+        if (c == '\n' || c == '\r') {
+            if (i > start) parseLine(m_lineBuffer.mid(start, i - start));
+            start = i + 1;
+        }
+    }
+    m_lineBuffer.remove(0, start);
+}
+
+bool FfmpegJob::parseBenchmarkLine(const QString& text) {
+    // --- -benchmark_all: "bench:     812 user      40 sys    1203 real decode_video 1.0" (µs deltas) ---
+    static QRegularExpression stageRx(R"(^bench:\s+(\d+) user\s+(\d+) sys\s+(\d+) real (.+?)\s*$)");
+    QRegularExpressionMatch m = stageRx.match(text);
+    if (m.hasMatch()) {
+        const qint64 real = m.captured(3).toLongLong();
+        const QString name = m.captured(4);
+        m_stats.addStage(name, m.captured(1).toLongLong() / 1e6, m.captured(2).toLongLong() / 1e6, real / 1e6);
+        // The line is printed as the stage ends, so it started `real` µs ago
+        const qint64 now = elapsedUs();
+        m_stats.addEvent(name.section(' ', 0, 0), name, now - real, real);
+        return true;
+    }
+
+    // --- -benchmark summary: "bench: utime=1.234s stime=0.056s rtime=2.345s" ---
+    static QRegularExpression summaryRx(R"(bench: utime=([\d.]+)s stime=([\d.]+)s)");
+    m = summaryRx.match(text);
+    if (m.hasMatch()) {
+        m_stats.userSeconds   = m.captured(1).toDouble();
+        m_stats.systemSeconds = m.captured(2).toDouble();
+        return true;
+    }
+
+    // --- "bench: maxrss=123456KiB" (older builds print "kB") ---
+    static QRegularExpression rssRx(R"(bench: maxrss=(\d+)\s*(?:KiB|kB))");
+    m = rssRx.match(text);
+    if (m.hasMatch()) {
+        m_stats.maxRssKiB = m.captured(1).toLongLong();
+        return true;
+    }
+    return false;
+}
+
+void FfmpegJob::parseLine(const QString& text) {
+    if (text.startsWith("bench:") && parseBenchmarkLine(text)) return;
 
     // --- Duration (ffmpeg header) ---
     if (m_totalDuration == 0.0) {
@@ -105,14 +1317,38 @@ void FfmpegJob::parseStderr(const QString& text) {
             m_totalDuration = hmsToSeconds(m.captured(1), m.captured(2), m.captured(3));
     }
 
+    // --- Frame rate of the reference: "Stream #0:0...: Video: ..., 23.98 fps, ..." ---
+    if (m_frameRate == 0.0) {
+        static QRegularExpression fpsRx(R"(Stream #0:\d+.*Video:.*?([\d.]+) fps)");
+        QRegularExpressionMatch m = fpsRx.match(text);
+        if (m.hasMatch()) m_frameRate = m.captured(1).toDouble();
+    }
+
     // --- Progress: "time=HH:MM:SS.xx" ---
     static QRegularExpression progressRx(R"(time=(\d{2}):(\d{2}):(\d{2})\.(\d{2}))");
     QRegularExpressionMatch progMatch = progressRx.match(text);
+    if (progMatch.hasMatch()) {
+        const qint64 now = elapsedUs();
+        if (m_firstProgressUs < 0) m_firstProgressUs = now;
+        m_lastProgressUs = now;
+        static QRegularExpression frameRx(R"(frame=\s*(\d+))");
+        QRegularExpressionMatch frameMatch = frameRx.match(text);
+        if (frameMatch.hasMatch()) m_stats.frames = frameMatch.captured(1).toLongLong();
+    }
     if (progMatch.hasMatch() && m_totalDuration > 0.0) {
         m_currentTime = hmsToSeconds(progMatch.captured(1), progMatch.captured(2), progMatch.captured(3));
         emit progressUpdated(m_currentTime, m_totalDuration);
+        return;
     }
 
+    // --- Which comparison: "[ssim@c2 @ 0x...]" ---
+    static QRegularExpression tagRx(R"(@c(\d+) @ )");
+    QRegularExpressionMatch tagMatch = tagRx.match(text);
+    const int index = tagMatch.hasMatch() ? tagMatch.captured(1).toInt() : 0;
+    if (index < 0 || index >= m_results.size()) return;
+    ComparisonResult& result = m_results[index];
+    const bool single = m_results.size() == 1;
+
     // --- SSIM: "SSIM Y:X.XXXX (db) U:... V:... All:X.XXXX (db)" ---
     static QRegularExpression ssimRx(
         R"(SSIM Y:([\d.]+) \(([\d.]+|inf)\) U:([\d.]+) \(([\d.]+|inf)\) V:([\d.]+) \(([\d.]+|inf)\) All:([\d.]+) \(([\d.]+|inf)\))");
@@ -123,7 +1359,9 @@ void FfmpegJob::parseStderr(const QString& text) {
         r.u    = ssimMatch.captured(3).toDouble(); r.uDb  = ssimMatch.captured(4);
         r.v    = ssimMatch.captured(5).toDouble(); r.vDb  = ssimMatch.captured(6);
         r.all  = ssimMatch.captured(7).toDouble(); r.allDb = ssimMatch.captured(8);
-        emit ssimResult(r);
+        result.ssim = r;
+        result.hasSsim = true;
+        if (single) emit ssimResult(r);
     }
 
     // --- PSNR: "PSNR ... y:X u:X v:X average:X ..." ---
@@ -134,12 +1372,17 @@ void FfmpegJob::parseStderr(const QString& text) {
         PsnrResult r;
         r.yDb = psnrMatch.captured(1); r.uDb  = psnrMatch.captured(2);
         r.vDb = psnrMatch.captured(3); r.avgDb = psnrMatch.captured(4);
-        emit psnrResult(r);
+        result.psnr = r;
+        result.hasPsnr = true;
+        if (single) emit psnrResult(r);
     }
 
     // --- VMAF: "VMAF score: X.XX" (or "VMAF score = X.XX") ---
     static QRegularExpression vmafRx(R"(VMAF score[:\s=]+([\d.]+))");
     QRegularExpressionMatch vmafMatch = vmafRx.match(text);
-    if (vmafMatch.hasMatch())
-        emit vmafResult(vmafMatch.captured(1).toDouble());
+    if (vmafMatch.hasMatch()) {
+        result.vmaf = vmafMatch.captured(1).toDouble();
+        result.hasVmaf = true;
+        if (single) emit vmafResult(result.vmaf);
+    }
 }
@@ -4,6 +4,26 @@
 #include <QObject>
 #include <QProcess>
 #include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+#include <QPointer>
+#include <QSize>
+#include <QRect>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <memory>
+#include "FrameMetrics.h"
+#include "MetricSet.h"
+#include "QualityGate.h"
+#include "JobStats.h"
+#include "JobClient.h"
+#include "KeyframeIndex.h"
+#include "VideoUtils.h"
+
+class ProcessSupervisor;
 
 struct SsimResult {
     double y = 0, u = 0, v = 0, all = 0;
@@ -14,39 +34,288 @@ struct PsnrResult {
     QString yDb, uDb, vDb, avgDb;
 };
 
+// Everything measured for one distorted input of a run
+struct ComparisonResult {
+    QString file;
+    bool hasSsim = false, hasPsnr = false, hasVmaf = false;
+    SsimResult ssim;
+    PsnrResult psnr;
+    double vmaf = 0;
+    // Proxy resolution ("640x360") when scored in proxy mode; empty for full-resolution scores
+    QString proxy;
+    // Time window ("00:12:00 +60s") in windowed runs; empty otherwise
+    QString window;
+    // How the input was found identical to the reference by the hash pre-check
+    // ("bit-identical video packets"); the scores are then perfect by definition
+    QString identical;
+    // Picture area scored after automatic black-bar cropping ("1920x800+0+140"); empty if uncropped
+    QString crop;
+    // Pixel format the metrics ran in, and the reference's transfer characteristics
+    QString pixelFormat;
+    int bitDepth = 0;
+    QString transfer;
+    // Overall bit rate of the distorted file, for rate-quality reports; 0 if unknown
+    double bitrateKbps = 0;
+    // Quality gates (setQualityGates): whether they were checked, and the verdict
+    bool hasGate = false;
+    bool gatePassed = true;
+    QString gateDetail;
+    // Extra libvmaf metrics (setExtraMetrics), in MetricSet::available() order
+    QVector<MetricScore> extra;
+
+    // Every pooled score of the run (SSIM, PSNR, VMAF, then the extras)
+    QVector<MetricScore> scores() const;
+    // "10-bit yuv420p10le, PQ"; empty when the format is unknown
+    QString formatLabel() const;
+};
+
+// A section of the inputs to score, in seconds
+struct TimeWindow {
+    double start = 0;
+    double duration = 0;
+
+    QString label() const;
+    // "start+duration" or "start-end" items separated by ',' or ';', where times are
+    // HH:MM:SS[.ms] or plain seconds, e.g. "00:00:00+30, 00:12:00-00:13:00"
+    static QList<TimeWindow> parseList(const QString& text, QString *errorMessage = nullptr);
+};
+
 // Encapsulates running an ffmpeg SSIM/PSNR/VMAF comparison as a background process.
 // The tab connects to the signals to drive UI updates; it never touches QProcess directly.
 class FfmpegJob : public QObject {
     Q_OBJECT
 
 public:
+    // Pre-check before scoring (setHashCheck)
+    enum HashCheck {
+        NoHashCheck,
+        PacketHash,           // hash the compressed video packets (no decoding)
+        PacketAndFrameHash    // if the packets differ, also hash the decoded frames
+    };
+
     explicit FfmpegJob(QObject *parent = nullptr);
     ~FfmpegJob();
 
+    // Inputs may be local files, http(s)/ftp URLs (read in place, see VideoUtils::
+    // inputOptions) or named pipes. A pipe is read once, by the comparison itself: the
+    // hash check, keyframe index and crop detection pre-passes are skipped for it.
     // startTime / duration: pass a non-empty HH:MM:SS string to apply -ss / -t flags.
     // Pass empty strings to omit them.
+    // The job is queued on the JobScheduler and launched when its thread budget allows.
     void start(const QString& originalFile, const QString& comparisonFile,
                const QString& startTime = QString(), const QString& duration = QString());
+    // Scores several distorted files against one reference in a single ffmpeg run.
+    // The reference is decoded once and split to every comparison; results arrive
+    // per input through comparisonResult(), indexed like comparisonFiles.
+    void startMulti(const QString& originalFile, const QStringList& comparisonFiles,
+                    const QString& startTime = QString(), const QString& duration = QString());
+    // Scores several time windows of one encode in a single ffmpeg run. Each window
+    // opens both files with its own input seek (-ss/-t), so only the windows are
+    // decoded (and named pipes, read only once, can't be used). comparisonResult()
+    // arrives per window (indexed like `windows`), and ssimResult()/psnrResult()/
+    // vmafResult() carry the duration-weighted combination.
+    void startWindows(const QString& originalFile, const QString& comparisonFile,
+                      const QList<TimeWindow>& windows);
     void cancel();
+    // True while queued or running
     bool isRunning() const;
 
+    // Scheduling parameters for the next start(); threads <= 0 asks for the whole budget
+    void setPriority(int priority) { m_priority = priority; }
+    void setThreads(int threads) { m_threads = threads; }
+    // Also record per-frame SSIM/PSNR/VMAF (via the filters' stats/log files) and emit
+    // frameMetricsReady() for each input when the run succeeds.
+    void setCollectFrameMetrics(bool enabled) { m_collectFrameMetrics = enabled; }
+    // Adds ffmpeg's -benchmark_all per-frame decode/encode timings to statsReady().
+    // Prints several lines per frame, so it is off by default.
+    void setStageTiming(bool enabled) { m_stageTiming = enabled; }
+    // Quick triage: both inputs are scaled to `size` right after decode (and in-loop
+    // deblocking is skipped), so the metrics run on far fewer pixels. VMAF is left out
+    // unless `vmaf` is set, in which case the phone model is used. Results are
+    // marked with ComparisonResult::proxy and are not comparable to full-res scores.
+    void setProxyMode(bool enabled, const QSize& size = QSize(640, 360), bool vmaf = false);
+    bool isProxyMode() const { return m_proxy; }
+    QString proxyLabel() const;
+    // Scale every distorted input to `size` (bicubic, as a player would) before the
+    // metrics, so encodes made at a lower resolution are scored against the full-size
+    // reference. An empty size leaves the inputs as they are.
+    void setScaleDistortedTo(const QSize& size) { m_distortedSize = size; }
+    // Before scoring, run cropdetect on a few short samples of the reference and crop
+    // the black bars (letterbox/pillarbox) they agree on from every input, so the
+    // metrics neither spend time on the bars nor count them as perfect matches.
+    // Skipped when the inputs differ in size or the bars are negligible.
+    void setAutoCrop(bool enabled) { m_autoCrop = enabled; }
+    bool autoCrop() const { return m_autoCrop; }
+    // Hash the video streams of the reference and every input over the scored range
+    // before scoring. When every input matches its reference (a remux or copy), the
+    // run reports perfect scores with ComparisonResult::identical set, without running
+    // the metrics. Packet hashing demuxes only; frame hashing decodes but skips the
+    // metrics, and catches re-muxes that changed the bitstream packaging.
+    void setHashCheck(HashCheck mode) { m_hashCheck = mode; }
+    HashCheck hashCheck() const { return m_hashCheck; }
+    // Move each seeked range (start time or window) back to the nearest earlier
+    // keyframe that all of its inputs share, lengthening it to keep the same end, so
+    // every decode starts on a keyframe instead of decoding and discarding pre-roll.
+    // Uses each file's KeyframeIndex, scanned once and cached on disk.
+    void setSnapToKeyframes(bool enabled) { m_snapToKeyframes = enabled; }
+    bool snapToKeyframes() const { return m_snapToKeyframes; }
+    // Read the reference from its lossless proxy in the ReferenceCache when there is
+    // one; otherwise a full-length run also writes the proxy from the frames it decodes.
+    void setReferenceCache(bool enabled) { m_referenceCache = enabled; }
+    bool referenceCache() const { return m_referenceCache; }
+    // Pass/fail rules checked for every input while the run progresses. Per-frame
+    // SSIM/PSNR is tailed from the filters' stats files as ffmpeg writes them, and the
+    // run is stopped as soon as every input has failed a gate for good. libvmaf writes
+    // its per-frame log only when it closes, so VMAF gates are decided at the end.
+    // Verdicts arrive in ComparisonResult::hasGate/gatePassed/gateDetail.
+    void setQualityGates(const QList<GateRule>& rules) { m_gateRules = rules; }
+    // Extra metrics (MetricSet ids) computed by the run's libvmaf filter alongside VMAF.
+    // They need libvmaf in the graph, so proxy runs without VMAF skip them. Means arrive
+    // in ComparisonResult::extra.
+    void setExtraMetrics(const QStringList& ids) { m_extraMetrics = MetricSet::normalize(ids); }
+    QStringList extraMetrics() const { return m_extraMetrics; }
+    QList<GateRule> qualityGates() const { return m_gateRules; }
+    // The last run was stopped early because its gates had already failed
+    bool abortedByGate() const { return m_gateAborted; }
+    // Runs subsequent start() calls on a JobServer instead of locally; nullptr runs locally
+    void setRemote(JobClient *client);
+    bool isRemote() const { return m_remote && m_remote->isConnected(); }
+
 signals:
     // Raw text line from the process
     void logLine(const QString& line);
+    // The local ffmpeg process is running (not emitted for remote runs)
+    void processStarted(qint64 pid);
     // Progress: currentTime and totalDuration in seconds
     void progressUpdated(double currentTime, double totalDuration);
-    // Parsed quality metric results
+    // Parsed quality metric results: single-input runs, or all windows of a
+    // startWindows() run combined
     void ssimResult(const SsimResult& result);
     void psnrResult(const PsnrResult& result);
     void vmafResult(double score);
+    // Emitted for every distorted input, in order, just before finished()
+    void comparisonResult(int index, const ComparisonResult& result);
+    // Per-frame series for one input (only with setCollectFrameMetrics(true))
+    void frameMetricsReady(int index, const FrameMetrics& metrics);
+    // Timing and resource usage of the run, just before finished()
+    void statsReady(const JobStats& stats);
     // Process exited; success == (NormalExit && exitCode == 0)
     void finished(bool success, int exitCode);
 
 private:
+    void prepareRun(const QString& originalFile, const QStringList& comparisonFiles,
+                    const QString& startTime, const QString& duration);
+    void submit(const QString& label);
+    void emitCombinedWindows();
+    void chooseWorkFormat();
+    void launch(int threads);
+    void probeNextFormat(int threads);
+    void startHashCheck(int threads);
+    void hashNextInput(int threads);
+    void finishHashCheck(int threads);
+    void emitIdenticalResults();
+    void launchScoring(int threads);
+    void indexKeyframes();
+    void indexNextFile(int threads);
+    void placeOnKeyframes();
+    void detectCrop(int threads);
+    void finishCropDetection(int threads, int exitCode, QProcess::ExitStatus status);
+    void launchComparison(int threads);
+    void useReferenceCache();
+    QString pipeInput() const;
+    bool prePassStopped(int exitCode, QProcess::ExitStatus status);
+    void releaseTicket();
+    void startRemote();
+    void handleRemoteNotification(const QString& method, const QJsonObject& params);
+    QString buildFilterGraph(int threads, QStringList& outputs) const;
     void parseStderr(const QString& text);
+    void parseLine(const QString& line);
+    void emitComparisonResults();
+    QVector<FrameMetrics> loadFrameMetrics() const;
+    void loadExtraMetrics();
+    void pollGates();
+    void finishGates(const QVector<FrameMetrics>& frames);
+    bool parseBenchmarkLine(const QString& line);
+    void sampleProcess();
+    void finishStats(qint64 exitUs);
+    qint64 elapsedUs() const { return m_clock.nsecsElapsed() / 1000; }
     static double hmsToSeconds(const QString& h, const QString& m, const QString& s);
 
     QProcess *m_process = nullptr;
+    QPointer<ProcessSupervisor> m_supervisor;   // owned by m_process
+    int m_ticket   = 0;
+    int m_priority = 1;   // JobScheduler::Normal
+    int m_threads  = 0;
+
+    QPointer<JobClient> m_remote;
+    bool m_remoteActive = false;
+    int m_remoteJobId   = 0;
+
+    QString m_originalFile, m_startTime, m_duration;
+    QStringList m_comparisonFiles;
+    QList<TimeWindow> m_windows;
+
+    // ffmpeg inputs, and the comparisons ("slots") the graph makes between them.
+    // Plain runs: input 0 is the reference for every slot; windowed runs open the
+    // reference and the encode once per window.
+    struct Input {
+        QString file;
+        QString seek, length;   // -ss / -t values; empty to omit
+    };
+    struct Slot {
+        int reference = 0, distorted = 1;   // input indices
+        double start = 0;                   // source time of the slot's first frame
+    };
+    QVector<Input> m_inputs;
+    QVector<Slot> m_slots;
+    QVector<ComparisonResult> m_results;
+    QString m_lineBuffer;
+
+    bool m_collectFrameMetrics = false;
+    QStringList m_extraMetrics;
+    bool m_proxy = false;
+    QSize m_proxySize = QSize(640, 360);
+    bool m_proxyVmaf = false;
+    QSize m_distortedSize;
+    std::unique_ptr<QTemporaryDir> m_statsDir;
+    // Hash pre-check: one sha256 per m_inputs entry ("" if hashing failed), and the stage
+    HashCheck m_hashCheck = NoHashCheck;
+    QStringList m_inputHashes;
+    bool m_hashingFrames = false;
+    // Keyframe placement: indexes of the seeked files, and files still to be scanned
+    bool m_snapToKeyframes = false;
+    bool m_keyframesPlaced = false;
+    QHash<QString, KeyframeIndex> m_keyframeIndexes;
+    QStringList m_indexQueue;
+    // Reference cache: the master whose proxy this run writes, and where it goes meanwhile
+    bool m_referenceCache = false;
+    QString m_cacheSource, m_cachePending;
+    // Automatic cropping: the cropdetect pre-pass output, and the agreed rectangle
+    bool m_autoCrop = false;
+    QString m_cropOutput;
+    QRect m_crop;
+    // Formats of the inputs (by file; pipes are never probed), and files still to probe
+    QHash<QString, VideoUtils::VideoFormat> m_formats;
+    QStringList m_formatQueue;
+    // Planar YUV format every metric branch receives; empty to leave it to ffmpeg
+    QString m_workFormat;
+    double m_frameRate = 0.0;
+
+    // Quality gates; one evaluator and one pair of stats-file tails per input
+    QList<GateRule> m_gateRules;
+    QVector<QualityGate> m_gates;
+    QVector<StatsFileTail> m_ssimTails, m_psnrTails;
+    QTimer m_gateTimer;
+    bool m_gateAborted = false;
+
+    // Timing; all marks are microseconds on m_clock, which starts at submission
+    bool m_stageTiming = false;
+    JobStats m_stats;
+    QElapsedTimer m_clock;
+    qint64 m_launchUs = 0, m_firstProgressUs = -1, m_lastProgressUs = -1;
+    QTimer m_sampleTimer;
+    qint64 m_lastSampleUs = 0;
+    double m_lastSampleCpu = 0;
     double m_totalDuration = 0.0;
     double m_currentTime   = 0.0;
 };
@@ -0,0 +1,199 @@
+#include "FrameArchive.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtEndian>
+#include <cstring>
+
+static constexpr char Magic[4] = {'V', 'M', 'F', 'A'};
+static constexpr int HeaderSize = 64;
+static constexpr int ColumnEntrySize = 32;
+
+// Arrays are written and mapped as native floats, which must be little-endian
+static constexpr bool HostIsLittleEndian = Q_BYTE_ORDER == Q_LITTLE_ENDIAN;
+
+static qint64 alignTo4(qint64 offset) {
+    return (offset + 3) & ~qint64(3);
+}
+
+static int levelSizeFor(int frameCount, int level) {
+    int n = frameCount;
+    for (int k = 0; k < level; ++k) n = (n + 1) / 2;
+    return n;
+}
+
+FrameArchive::~FrameArchive() {
+    close();
+}
+
+QString FrameArchive::defaultDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/frame-archives";
+}
+
+QString FrameArchive::newArchivePath(const QString& distortedFile, int index) {
+    QString name = QFileInfo(distortedFile).completeBaseName();
+    name.replace(QRegularExpression("[^A-Za-z0-9._-]"), "_");
+    return QDir(defaultDirectory()).filePath(
+        QString("%1_%2_%3.%4").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"))
+                              .arg(index).arg(name.left(60), Suffix));
+}
+
+int FrameArchive::levelSize(int level) const {
+    return levelSizeFor(m_frameCount, level);
+}
+
+bool FrameArchive::write(const QString& path, const FrameMetrics& metrics,
+                         const QJsonObject& metadata, QString *errorMessage) {
+    auto fail = [errorMessage](const QString& message) {
+        if (errorMessage) *errorMessage = message;
+        return false;
+    };
+    if (!HostIsLittleEndian) return fail("Frame archives are only supported on little-endian hosts");
+
+    // Columns share one frame count; a series that came up short truncates the rest
+    QList<FrameMetrics::Metric> stored;
+    int frameCount = -1;
+    for (FrameMetrics::Metric m : {FrameMetrics::Ssim, FrameMetrics::Psnr, FrameMetrics::Vmaf}) {
+        const int size = int(metrics.series(m).size());
+        if (size == 0) continue;
+        stored << m;
+        frameCount = frameCount < 0 ? size : qMin(frameCount, size);
+    }
+    if (stored.isEmpty()) return fail("No per-frame data to write");
+
+    const QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
+    QList<MinMaxPyramid> pyramids;
+    for (FrameMetrics::Metric m : stored)
+        pyramids << FrameMetricsIO::buildPyramid(metrics.series(m).mid(0, frameCount));
+
+    // Lay out the columns after the header, column table and metadata
+    qint64 offset = alignTo4(HeaderSize + ColumnEntrySize * stored.size() + meta.size());
+    QByteArray table;
+    QList<qint64> valueOffsets;
+    for (int c = 0; c < stored.size(); ++c) {
+        const int levels = pyramids[c].levelCount();
+        const qint64 valuesOffset  = offset;
+        const qint64 pyramidOffset = valuesOffset + qint64(frameCount) * 4;
+        offset = pyramidOffset;
+        for (int k = 1; k < levels; ++k) offset += qint64(levelSizeFor(frameCount, k)) * 8;
+        valueOffsets << valuesOffset;
+
+        char entry[ColumnEntrySize] = {};
+        qToLittleEndian<quint16>(quint16(stored[c]), entry);
+        qToLittleEndian<quint16>(quint16(levels), entry + 2);
+        qToLittleEndian<quint64>(quint64(valuesOffset), entry + 8);
+        qToLittleEndian<quint64>(quint64(pyramidOffset), entry + 16);
+        table.append(entry, ColumnEntrySize);
+    }
+
+    char header[HeaderSize] = {};
+    std::memcpy(header, Magic, 4);
+    qToLittleEndian<quint16>(Version, header + 4);
+    qToLittleEndian<quint16>(quint16(stored.size()), header + 6);
+    qToLittleEndian<quint32>(quint32(frameCount), header + 8);
+    qToLittleEndian<quint32>(quint32(meta.size()), header + 12);
+    std::memcpy(header + 16, &metrics.frameRate, 8);
+    std::memcpy(header + 24, &metrics.startTime, 8);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return fail(file.errorString());
+    file.write(header, HeaderSize);
+    file.write(table);
+    file.write(meta);
+    for (int c = 0; c < stored.size(); ++c) {
+        file.write(QByteArray(int(valueOffsets[c] - file.pos()), '\0'));   // alignment padding
+        // Values are stored as measured (inf included); the pyramid holds capped values
+        const QVector<float>& values = metrics.series(stored[c]);
+        file.write(reinterpret_cast<const char*>(values.constData()), qint64(frameCount) * 4);
+        for (int k = 1; k < pyramids[c].levelCount(); ++k) {
+            file.write(reinterpret_cast<const char*>(pyramids[c].min[k].constData()), pyramids[c].min[k].size() * 4);
+            file.write(reinterpret_cast<const char*>(pyramids[c].max[k].constData()), pyramids[c].max[k].size() * 4);
+        }
+    }
+    if (!file.commit()) return fail(file.errorString());
+    return true;
+}
+
+bool FrameArchive::open(const QString& path, QString *errorMessage) {
+    close();
+    auto fail = [this, errorMessage](const QString& message) {
+        close();
+        if (errorMessage) *errorMessage = message;
+        return false;
+    };
+    if (!HostIsLittleEndian) return fail("Frame archives are only supported on little-endian hosts");
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) return fail(m_file.errorString());
+    m_size = m_file.size();
+    if (m_size < HeaderSize) return fail("Not a frame archive (too short)");
+    m_data = m_file.map(0, m_size);
+    if (!m_data) return fail("Cannot map file: " + m_file.errorString());
+
+    const uchar *h = m_data;
+    if (std::memcmp(h, Magic, 4) != 0) return fail("Not a frame archive");
+    const quint16 version = qFromLittleEndian<quint16>(h + 4);
+    if (version > Version) return fail(QString("Unsupported frame archive version %1").arg(version));
+    const int columns       = qFromLittleEndian<quint16>(h + 6);
+    m_frameCount            = int(qFromLittleEndian<quint32>(h + 8));
+    const qint64 metaSize   = qFromLittleEndian<quint32>(h + 12);
+    std::memcpy(&m_frameRate, h + 16, 8);
+    std::memcpy(&m_startTime, h + 24, 8);
+
+    const qint64 metaOffset = HeaderSize + qint64(ColumnEntrySize) * columns;
+    if (metaOffset + metaSize > m_size) return fail("Truncated frame archive");
+    m_metadata = QJsonDocument::fromJson(QByteArray::fromRawData(
+        reinterpret_cast<const char*>(m_data + metaOffset), int(metaSize))).object();
+
+    for (int c = 0; c < columns; ++c) {
+        const uchar *e = m_data + HeaderSize + c * ColumnEntrySize;
+        const int metric          = qFromLittleEndian<quint16>(e);
+        const int levels          = qFromLittleEndian<quint16>(e + 2);
+        const qint64 valuesOffset = qint64(qFromLittleEndian<quint64>(e + 8));
+        qint64 offset             = qint64(qFromLittleEndian<quint64>(e + 16));
+        if (metric < FrameMetrics::Ssim || metric > FrameMetrics::Vmaf) continue;   // newer column type
+
+        if (valuesOffset % 4 || offset % 4 || valuesOffset + qint64(m_frameCount) * 4 > m_size)
+            return fail("Corrupt frame archive column table");
+        Column& col = m_columns[metric];
+        col.values = reinterpret_cast<const float*>(m_data + valuesOffset);
+        col.mins << col.values;
+        col.maxs << col.values;
+        for (int k = 1; k < levels; ++k) {
+            const qint64 n = levelSize(k);
+            if (offset + n * 8 > m_size) return fail("Truncated frame archive pyramid");
+            col.mins << reinterpret_cast<const float*>(m_data + offset);
+            col.maxs << reinterpret_cast<const float*>(m_data + offset + n * 4);
+            offset += n * 8;
+        }
+    }
+    return true;
+}
+
+void FrameArchive::close() {
+    if (m_data) m_file.unmap(m_data);
+    m_data = nullptr;
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_frameCount = 0;
+    m_frameRate = m_startTime = 0;
+    m_metadata = QJsonObject();
+    for (Column& c : m_columns) c = Column();
+}
+
+FrameMetrics FrameArchive::toFrameMetrics() const {
+    FrameMetrics metrics;
+    metrics.frameRate = m_frameRate;
+    metrics.startTime = m_startTime;
+    QVector<float>* series[3] = {&metrics.ssim, &metrics.psnr, &metrics.vmaf};
+    for (int m = 0; m < 3; ++m) {
+        if (!m_columns[m].values) continue;
+        *series[m] = QVector<float>(m_columns[m].values, m_columns[m].values + m_frameCount);
+    }
+    return metrics;
+}
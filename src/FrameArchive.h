@@ -0,0 +1,77 @@
+#ifndef FRAMEARCHIVE_H
+#define FRAMEARCHIVE_H
+
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+#include "FrameMetrics.h"
+
+// Per-frame metric archive (.vmfa): a versioned, little-endian columnar file that
+// is opened with mmap, so even a feature-length title is ready to plot at once.
+//
+//   FileHeader     64 bytes: magic "VMFA", version, frame count, frame rate, start time
+//   ColumnEntry    32 bytes per stored metric: offsets of its values and pyramid
+//   metadata       UTF-8 JSON (reference, distorted file, proxy, ...)
+//   per column     float32[frameCount] values, then for pyramid levels 1..L-1
+//                  float32 min[n_k] followed by float32 max[n_k]
+//
+// Every array starts on a 4-byte boundary. Readers reject a newer major version;
+// unknown metric ids are skipped, so columns can be added without a version bump.
+class FrameArchive {
+public:
+    static constexpr quint16 Version = 1;
+    static constexpr const char *Suffix = "vmfa";
+
+    FrameArchive() = default;
+    ~FrameArchive();
+    FrameArchive(const FrameArchive&) = delete;
+    FrameArchive& operator=(const FrameArchive&) = delete;
+
+    // Writes every non-empty series of `metrics`, with its min/max pyramid.
+    static bool write(const QString& path, const FrameMetrics& metrics,
+                      const QJsonObject& metadata, QString *errorMessage = nullptr);
+    // Where the app keeps archives linked from the history
+    static QString defaultDirectory();
+    // A fresh file name in defaultDirectory() for the series of `distortedFile`
+    static QString newArchivePath(const QString& distortedFile, int index = 0);
+
+    bool open(const QString& path, QString *errorMessage = nullptr);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+
+    int frameCount() const { return m_frameCount; }
+    double frameRate() const { return m_frameRate; }
+    double startTime() const { return m_startTime; }
+    QJsonObject metadata() const { return m_metadata; }
+
+    bool hasMetric(FrameMetrics::Metric metric) const { return column(metric).values != nullptr; }
+    // Raw series, pointing into the mapping (valid until close())
+    const float* values(FrameMetrics::Metric metric) const { return column(metric).values; }
+    // Pyramid levels including level 0 (which is values() with inf left as stored)
+    int levelCount(FrameMetrics::Metric metric) const { return int(column(metric).mins.size()); }
+    const float* levelMin(FrameMetrics::Metric metric, int level) const { return column(metric).mins.value(level); }
+    const float* levelMax(FrameMetrics::Metric metric, int level) const { return column(metric).maxs.value(level); }
+    int levelSize(int level) const;
+
+    // Copies the series out, e.g. for worst-segment search
+    FrameMetrics toFrameMetrics() const;
+
+private:
+    struct Column {
+        const float *values = nullptr;
+        QVector<const float*> mins, maxs;
+    };
+    const Column& column(FrameMetrics::Metric metric) const { return m_columns[metric]; }
+
+    QFile m_file;
+    uchar *m_data = nullptr;
+    qint64 m_size = 0;
+    int m_frameCount = 0;
+    double m_frameRate = 0;
+    double m_startTime = 0;
+    QJsonObject m_metadata;
+    Column m_columns[3];
+};
+
+#endif // FRAMEARCHIVE_H
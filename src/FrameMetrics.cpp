@@ -0,0 +1,197 @@
+#include "FrameMetrics.h"
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+const QVector<float>& FrameMetrics::series(Metric metric) const {
+    switch (metric) {
+    case Ssim: return ssim;
+    case Psnr: return psnr;
+    case Vmaf: return vmaf;
+    }
+    return vmaf;
+}
+
+int FrameMetrics::frameCount() const {
+    return int(std::max({ssim.size(), psnr.size(), vmaf.size()}));
+}
+
+double FrameMetrics::timeOfFrame(int frame) const {
+    return startTime + (frameRate > 0 ? frame / frameRate : 0.0);
+}
+
+QList<QByteArray> StatsFileTail::readLines() {
+    QList<QByteArray> lines;
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly) || file.size() <= m_offset || !file.seek(m_offset)) return lines;
+    const QByteArray chunk = file.readAll();
+    m_offset += chunk.size();
+    m_partial += chunk;
+    int start = 0;
+    for (int nl = m_partial.indexOf('\n'); nl >= 0; nl = m_partial.indexOf('\n', start)) {
+        lines << m_partial.mid(start, nl - start);
+        start = nl + 1;
+    }
+    m_partial.remove(0, start);
+    return lines;
+}
+
+namespace FrameMetricsIO {
+
+// Value following `key` up to the next space, e.g. key "All:" in "... All:0.98 (17.5)"
+static bool valueAfter(const QByteArray& line, const char *key, float& value) {
+    const int pos = line.indexOf(key);
+    if (pos < 0) return false;
+    const int begin = pos + int(qstrlen(key));
+    int end = line.indexOf(' ', begin);
+    if (end < 0) end = line.size();
+    const QByteArray token = line.mid(begin, end - begin).trimmed();
+    if (token == "inf") {
+        value = std::numeric_limits<float>::infinity();
+        return true;
+    }
+    bool ok = false;
+    value = token.toFloat(&ok);
+    return ok;
+}
+
+bool parseSsimLine(const QByteArray& line, float& all) {
+    return valueAfter(line, "All:", all);
+}
+
+bool parsePsnrLine(const QByteArray& line, float& average) {
+    return valueAfter(line, "psnr_avg:", average);
+}
+
+template <typename Parser>
+static QVector<float> loadStats(const QString& path, Parser parse) {
+    QVector<float> values;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return values;
+    while (!file.atEnd()) {
+        float v = 0;
+        if (parse(file.readLine(), v)) values.append(v);
+    }
+    return values;
+}
+
+QVector<float> loadSsimStats(const QString& path) {
+    return loadStats(path, parseSsimLine);
+}
+
+QVector<float> loadPsnrStats(const QString& path) {
+    return loadStats(path, parsePsnrLine);
+}
+
+QVector<float> loadVmafCsv(const QString& path) {
+    QVector<float> values;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return values;
+
+    const QList<QByteArray> header = file.readLine().trimmed().split(',');
+    const int column = header.indexOf("vmaf");
+    if (column < 0) return values;
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split(',');
+        if (fields.size() <= column) continue;
+        bool ok = false;
+        const float v = fields[column].toFloat(&ok);
+        if (ok) values.append(v);
+    }
+    return values;
+}
+
+QMap<QString, double> csvColumnMeans(const QString& path, const QStringList& columns) {
+    QMap<QString, double> means;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return means;
+
+    const QList<QByteArray> header = file.readLine().trimmed().split(',');
+    QList<int> indices;
+    for (const QString& column : columns) indices << int(header.indexOf(column.toUtf8()));
+    QVector<double> sums(columns.size(), 0.0);
+    QVector<int> counts(columns.size(), 0);
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split(',');
+        for (int c = 0; c < indices.size(); ++c) {
+            if (indices[c] < 0 || fields.size() <= indices[c]) continue;
+            bool ok = false;
+            const double v = fields[indices[c]].toDouble(&ok);
+            if (ok && std::isfinite(v)) {
+                sums[c] += v;
+                ++counts[c];
+            }
+        }
+    }
+    for (int c = 0; c < columns.size(); ++c)
+        if (counts[c] > 0) means.insert(columns[c], sums[c] / counts[c]);
+    return means;
+}
+
+MinMaxPyramid buildPyramid(const QVector<float>& values) {
+    MinMaxPyramid pyramid;
+    if (values.isEmpty()) return pyramid;
+
+    QVector<float> base(values.size());
+    for (int i = 0; i < values.size(); ++i)
+        base[i] = std::isfinite(values[i]) ? values[i] : PyramidCeiling;
+    pyramid.min << base;
+    pyramid.max << base;
+
+    // Halve until a single bucket remains; total size is ~2x the series
+    while (pyramid.min.last().size() > 1) {
+        const QVector<float>& prevMin = pyramid.min.last();
+        const QVector<float>& prevMax = pyramid.max.last();
+        const int prevSize = int(prevMin.size());
+        const int n = (prevSize + 1) / 2;
+        QVector<float> nextMin(n), nextMax(n);
+        for (int i = 0; i < n; ++i) {
+            const int a = 2 * i, b = qMin(2 * i + 1, prevSize - 1);
+            nextMin[i] = qMin(prevMin[a], prevMin[b]);
+            nextMax[i] = qMax(prevMax[a], prevMax[b]);
+        }
+        pyramid.min << nextMin;
+        pyramid.max << nextMax;
+    }
+    return pyramid;
+}
+
+QList<FrameSegment> worstSegments(const QVector<float>& values, int windowFrames, int count) {
+    QList<FrameSegment> result;
+    const int n = values.size();
+    if (n == 0 || count <= 0) return result;
+    windowFrames = qBound(1, windowFrames, n);
+
+    // Prefix sums; inf (identical frames) is scored as a perfect 100
+    QVector<double> prefix(n + 1, 0.0);
+    for (int i = 0; i < n; ++i)
+        prefix[i + 1] = prefix[i] + (std::isfinite(values[i]) ? values[i] : 100.0);
+
+    // Candidate windows on a quarter-window stride, lowest mean first
+    const int stride = qMax(1, windowFrames / 4);
+    QVector<FrameSegment> candidates;
+    for (int start = 0; start + windowFrames <= n; start += stride) {
+        FrameSegment s;
+        s.firstFrame = start;
+        s.frameCount = windowFrames;
+        s.mean = (prefix[start + windowFrames] - prefix[start]) / windowFrames;
+        candidates.append(s);
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const FrameSegment& a, const FrameSegment& b) { return a.mean < b.mean; });
+
+    for (const FrameSegment& c : std::as_const(candidates)) {
+        const bool overlaps = std::any_of(result.begin(), result.end(), [&c](const FrameSegment& r) {
+            return c.firstFrame < r.firstFrame + r.frameCount && r.firstFrame < c.firstFrame + c.frameCount;
+        });
+        if (overlaps) continue;
+        result.append(c);
+        if (result.size() >= count) break;
+    }
+    return result;
+}
+
+} // namespace FrameMetricsIO
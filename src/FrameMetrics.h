@@ -0,0 +1,78 @@
+#ifndef FRAMEMETRICS_H
+#define FRAMEMETRICS_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QList>
+#include <QMap>
+
+// Per-frame quality series for one comparison. Any series may be empty if that
+// metric wasn't collected. Values are stored as float to keep long titles compact.
+struct FrameMetrics {
+    QVector<float> ssim;   // SSIM "All" per frame (0-1)
+    QVector<float> psnr;   // PSNR average per frame in dB (inf for identical frames)
+    QVector<float> vmaf;   // VMAF per frame (0-100)
+    double frameRate = 0;  // frames per second of the scored stream (0 if unknown)
+    double startTime = 0;  // seconds; offset of frame 0 in the source (the -ss value)
+
+    enum Metric { Ssim, Psnr, Vmaf };
+    const QVector<float>& series(Metric metric) const;
+    int frameCount() const;
+    bool isEmpty() const { return frameCount() == 0; }
+    // Source timestamp of a frame, in seconds
+    double timeOfFrame(int frame) const;
+};
+
+// A contiguous window of frames and its mean score
+struct FrameSegment {
+    int firstFrame = 0;
+    int frameCount = 0;
+    double mean = 0;
+};
+
+// Min/max pyramid of one series: level k holds the min and max of each run of 2^k
+// frames, down to a single bucket. Level 0 is the series itself, with non-finite
+// values (inf PSNR of identical frames) capped at PyramidCeiling.
+struct MinMaxPyramid {
+    QVector<QVector<float>> min, max;
+    int levelCount() const { return int(min.size()); }
+};
+
+// Reads a stats file that ffmpeg is still writing. Each call returns the lines
+// completed since the previous call; a trailing partial line is kept for later.
+class StatsFileTail {
+public:
+    explicit StatsFileTail(const QString& path = QString()) : m_path(path) {}
+    QList<QByteArray> readLines();
+
+private:
+    QString m_path;
+    qint64 m_offset = 0;
+    QByteArray m_partial;
+};
+
+namespace FrameMetricsIO {
+    constexpr float PyramidCeiling = 100.0f;
+
+    MinMaxPyramid buildPyramid(const QVector<float>& values);
+
+    // ssim stats_file line: "n:1 Y:0.98 U:0.99 V:0.99 All:0.98 (17.5)"
+    bool parseSsimLine(const QByteArray& line, float& all);
+    // psnr stats_file line: "n:1 mse_avg:1.2 ... psnr_avg:47.3 psnr_y:..."
+    bool parsePsnrLine(const QByteArray& line, float& average);
+
+    QVector<float> loadSsimStats(const QString& path);
+    QVector<float> loadPsnrStats(const QString& path);
+    // libvmaf log_fmt=csv: reads the "vmaf" column
+    QVector<float> loadVmafCsv(const QString& path);
+    // Mean of each of `columns` over all frames of a libvmaf csv log; missing columns are left out
+    QMap<QString, double> csvColumnMeans(const QString& path, const QStringList& columns);
+
+    // The `count` lowest-scoring, non-overlapping windows of windowFrames frames,
+    // worst first. Non-finite values (inf PSNR of identical frames) are scored as 100.
+    QList<FrameSegment> worstSegments(const QVector<float>& values, int windowFrames, int count);
+}
+
+#endif // FRAMEMETRICS_H
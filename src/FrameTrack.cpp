@@ -0,0 +1,201 @@
+#include "FrameTrack.h"
+#include "JobScheduler.h"
+#include "ProcessSupervisor.h"
+#include "VideoUtils.h"
+#include <QFileInfo>
+#include <QProcess>
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+double FrameTrack::bitrateKbps(int first, int last, double frameRate) const {
+    first = qMax(0, first);
+    last = qMin(frameCount(), last);
+    if (last <= first || frameRate <= 0) return 0;
+    double bytes = 0;
+    for (int i = first; i < last; ++i) bytes += sizes[i];
+    return bytes * 8 / ((last - first) / frameRate) / 1000;
+}
+
+QVector<int> FrameTrack::gopLengths() const {
+    QVector<int> lengths;
+    int previous = -1;
+    for (int i = 0; i < frameCount(); ++i) {
+        if (!isKeyframe(i)) continue;
+        if (previous >= 0) lengths << i - previous;
+        previous = i;
+    }
+    return lengths;
+}
+
+// --- FrameTrackProbe ---
+
+FrameTrackProbe::FrameTrackProbe(QObject *parent) : QObject(parent) {}
+
+FrameTrackProbe::~FrameTrackProbe() {
+    cancel();
+}
+
+void FrameTrackProbe::start(const QString& file, double startTime, double duration, Mode mode) {
+    cancel();
+    m_file = file;
+    m_start = startTime;
+    m_duration = duration;
+    m_mode = mode;
+    m_track = FrameTrack();
+    m_partial.clear();
+    m_ticket = JobScheduler::instance()->submit("Bitrate track: " + QFileInfo(file).fileName(),
+                                                JobScheduler::Low, 1, [this](int) { launch(); });
+}
+
+void FrameTrackProbe::cancel() {
+    if (!m_ticket) return;
+    if (m_process) {
+        m_process->disconnect(this);
+        ProcessSupervisor::killTree(m_process);
+        m_process->waitForFinished(3000);
+        delete m_process;
+        JobScheduler::instance()->release(m_ticket);
+    } else {
+        JobScheduler::instance()->withdraw(m_ticket);
+    }
+    m_ticket = 0;
+}
+
+void FrameTrackProbe::launch() {
+    // -ss counts from the stream's start time, so the scored range begins there too.
+    // Read it first, without blocking; a probe that fails leaves it at 0.
+    m_streamStart = 0;
+    QStringList args{"-v", "error", "-select_streams", "v:0", "-show_entries", "stream=start_time", "-of", "csv=p=0"};
+    args << VideoUtils::inputOptions(m_file) << m_file;
+
+    m_process = new QProcess(this);
+    JobScheduler::instance()->prepareProcess(m_process);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this](int exitCode, QProcess::ExitStatus status) {
+        if (status == QProcess::NormalExit && exitCode == 0)
+            m_streamStart = QString::fromLatin1(m_process->readAllStandardOutput()).trimmed().toDouble();
+        m_process->deleteLater();
+        m_process = nullptr;
+        launchTrack();
+    });
+    m_process->start("ffprobe", args);
+    if (!m_process->waitForStarted()) {
+        m_process->deleteLater();
+        m_process = nullptr;
+        launchTrack();
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+void FrameTrackProbe::launchTrack() {
+    // ffprobe prints csv fields in its own order, which for both sections is time, size, type
+    QStringList args{"-v", "error", "-select_streams", "v:0", "-show_entries"};
+    args << (m_mode == Packets ? "packet=pts_time,size,flags" : "frame=best_effort_timestamp_time,pkt_size,pict_type");
+    args << "-of" << "csv=p=0";
+    if (m_start > 0 || m_duration > 0) {
+        // Seeks to the keyframe before the range; earlier entries are dropped while parsing.
+        // A little extra at the end covers frames the decoder holds back for reordering.
+        args << "-read_intervals" << QString("%1%%2").arg(m_streamStart + m_start, 0, 'f', 3)
+                                         .arg(m_duration > 0 ? QString("+%1").arg(m_duration + 1, 0, 'f', 3) : QString());
+    }
+    args << VideoUtils::inputOptions(m_file) << m_file;
+
+    m_process = new QProcess(this);
+    JobScheduler::instance()->prepareProcess(m_process);
+    m_process->setProcessChannelMode(QProcess::SeparateChannels);
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &FrameTrackProbe::readOutput);
+    connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, [this](int exitCode, QProcess::ExitStatus status) {
+        readOutput();
+        finish(status == QProcess::NormalExit && exitCode == 0);
+    });
+    m_process->start("ffprobe", args);
+    if (!m_process->waitForStarted()) {
+        finish(false);
+        return;
+    }
+    JobScheduler::instance()->applyToStartedProcess(m_process);
+}
+
+static bool parseDecimal(const char *&p, const char *end, double& value) {
+    const bool negative = p < end && *p == '-';
+    if (negative) ++p;
+    double v = 0;
+    bool digits = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, digits = true) v = v * 10 + (*p - '0');
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, digits = true, scale *= 0.1) v += (*p - '0') * scale;
+    }
+    value = negative ? -v : v;
+    return digits;
+}
+
+bool FrameTrackProbe::parseLine(const char *begin, const char *end, double& time, quint32& size, char& type) {
+    const char *p = begin;
+    if (!parseDecimal(p, end, time) || p >= end || *p++ != ',') return false;   // "N/A" times fail here
+    double bytes = 0;
+    if (!parseDecimal(p, end, bytes) || p >= end || *p++ != ',') return false;
+    if (p >= end) return false;
+    size = quint32(bytes);
+    // Packet flags are "K_" / "__" (plus more flags); frames give the picture type letter
+    if (*p == 'K') type = 'K';
+    else if (*p == 'I' || *p == 'P' || *p == 'B') type = *p;
+    else if (*p == 'S') type = 'P';   // S(witching)/SP pictures predict like P
+    else type = '-';
+    return true;
+}
+
+void FrameTrackProbe::readOutput() {
+    if (!m_process) return;
+    m_partial += m_process->readAllStandardOutput();
+
+    const double first = m_streamStart + m_start - 0.0005;
+    const double last = m_duration > 0 ? m_streamStart + m_start + m_duration - 0.0005 : 1e300;
+    const char *data = m_partial.constData();
+    const char *end = data + m_partial.size();
+    const char *line = data;
+    double latest = -1;
+    for (const char *nl; (nl = static_cast<const char*>(std::memchr(line, '\n', end - line))); line = nl + 1) {
+        double time;
+        quint32 size;
+        char type;
+        if (!parseLine(line, nl, time, size, type) || time < first || time >= last) continue;
+        m_track.pts << time;
+        m_track.sizes << size;
+        m_track.types.append(type);
+        latest = qMax(latest, time);
+    }
+    m_partial.remove(0, int(line - data));
+    if (latest >= 0) emit progressUpdated(latest - m_streamStart - m_start);
+}
+
+void FrameTrackProbe::finish(bool success) {
+    if (m_process) {
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    if (m_ticket) {
+        JobScheduler::instance()->release(m_ticket);
+        m_ticket = 0;
+    }
+
+    // Packets arrive in decode order; put the track in presentation order
+    const int n = m_track.frameCount();
+    QVector<int> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return m_track.pts[a] < m_track.pts[b]; });
+    FrameTrack sorted;
+    sorted.pts.reserve(n);
+    sorted.sizes.reserve(n);
+    sorted.types.reserve(n);
+    for (int i : std::as_const(order)) {
+        sorted.pts << m_track.pts[i];
+        sorted.sizes << m_track.sizes[i];
+        sorted.types.append(m_track.types[i]);
+    }
+    m_track = std::move(sorted);
+    emit finished(success && !m_track.isEmpty());
+}
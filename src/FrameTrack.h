@@ -0,0 +1,77 @@
+#ifndef FRAMETRACK_H
+#define FRAMETRACK_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+
+class QProcess;
+
+// Compressed size and picture type of every frame of a video stream, in presentation
+// order, aligned with a FrameMetrics series (frame i here is frame i there). Kept as
+// parallel arrays so a multi-hour title costs ~13 bytes per frame.
+struct FrameTrack {
+    QVector<double> pts;      // presentation time, seconds
+    QVector<quint32> sizes;   // bytes
+    QByteArray types;         // 'I', 'P', 'B'; 'K' (keyframe) / '-' when only packet flags are known
+
+    int frameCount() const { return int(sizes.size()); }
+    bool isEmpty() const { return sizes.isEmpty(); }
+    bool isKeyframe(int frame) const { const char t = types.at(frame); return t == 'I' || t == 'K'; }
+    // Mean bit rate over frames [first, last), in kbit/s at the given frame rate
+    double bitrateKbps(int first, int last, double frameRate) const;
+    // Keyframe-to-keyframe distances in frames
+    QVector<int> gopLengths() const;
+};
+
+// Streams ffprobe's per-packet or per-frame output and fills a FrameTrack. Lines are
+// parsed straight from the pipe as they arrive (no QString per line, no buffering of
+// the whole output), so memory stays at the track itself however long the file is.
+class FrameTrackProbe : public QObject {
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Packets,   // demux only: fast, but only tells keyframes from the rest
+        Frames     // decodes: exact I/P/B picture types
+    };
+
+    explicit FrameTrackProbe(QObject *parent = nullptr);
+    ~FrameTrackProbe();
+
+    // Reads the range [startTime, startTime + duration) of `file`'s first video stream;
+    // duration <= 0 reads to the end. Runs as a low-priority JobScheduler job. Not for
+    // named pipes, whose data belongs to the comparison that reads them.
+    void start(const QString& file, double startTime, double duration, Mode mode);
+    void cancel();
+    bool isRunning() const { return m_ticket != 0; }
+
+    const FrameTrack& track() const { return m_track; }
+
+    // One ffprobe csv line: "<time>,<size>,<flags or pict_type>"; false for anything else
+    static bool parseLine(const char *begin, const char *end, double& time, quint32& size, char& type);
+
+signals:
+    // Source seconds read so far
+    void progressUpdated(double seconds);
+    void finished(bool success);
+
+private:
+    void launch();
+    void launchTrack();
+    void readOutput();
+    void finish(bool success);
+
+    QPointer<QProcess> m_process;
+    int m_ticket = 0;
+    QString m_file;
+    double m_start = 0, m_duration = 0;
+    Mode m_mode = Packets;
+    double m_streamStart = 0;
+    QByteArray m_partial;
+    FrameTrack m_track;
+};
+
+#endif // FRAMETRACK_H
@@ -1,10 +1,28 @@
 #include "HistoryTab.h"
+#include "BatchReport.h"
+#include "FrameArchive.h"
+#include "QualityTimeline.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
 #include <QHeaderView>
 #include <QDateTime>
 #include <QStandardPaths>
 #include <QFile>
+#include <QFileInfo>
 #include <QTextStream>
+#include <QComboBox>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QJsonDocument>
+#include <QLineEdit>
+#include <QSaveFile>
+#include <QThread>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QMessageBox>
+#include <algorithm>
 
 HistoryTab::HistoryTab(QWidget *parent) : QWidget(parent) {
     setupUI();
@@ -13,37 +31,65 @@ HistoryTab::HistoryTab(QWidget *parent) : QWidget(parent) {
 
 void HistoryTab::setupUI() {
     QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *toolbar = new QHBoxLayout();
+    reportBtn = new QPushButton("Export Report...", this);
+    reportBtn->setToolTip("VMAF/PSNR/SSIM statistics and BD-rate of the selected results\n"
+                          "(all results when nothing is selected), as HTML or JSON");
+    reportStatusLabel = new QLabel(this);
+    toolbar->addWidget(reportBtn);
+    toolbar->addWidget(reportStatusLabel, 1);
+    layout->addLayout(toolbar);
+
     historyTable = new QTableWidget(this);
-    historyTable->setColumnCount(4);
-    historyTable->setHorizontalHeaderLabels({"Date/Time", "Type", "Details", "Result"});
+    historyTable->setColumnCount(5);
+    historyTable->setHorizontalHeaderLabels({"Date/Time", "Type", "Details", "Result", "Per-Frame"});
     historyTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
     historyTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
     historyTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::Stretch);
     historyTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    historyTable->horizontalHeader()->setSectionResizeMode(4, QHeaderView::ResizeToContents);
+    historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    historyTable->setSelectionMode(QAbstractItemView::ExtendedSelection);
     layout->addWidget(historyTable);
+
+    connect(reportBtn, &QPushButton::clicked, this, &HistoryTab::exportReport);
+
+    connect(historyTable, &QTableWidget::cellDoubleClicked, this, [this](int row) { showFrameData(row); });
 }
 
-void HistoryTab::addEntry(const QString& type, const QString& details, const QString& result) {
-    int row = historyTable->rowCount();
-    historyTable->insertRow(row);
-    
+void HistoryTab::addEntry(const QString& type, const QString& details, const QString& result,
+                          const QString& frameArchive) {
     QString timestamp = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
-    
-    historyTable->setItem(row, 0, new QTableWidgetItem(timestamp));
-    historyTable->setItem(row, 1, new QTableWidgetItem(type));
-    historyTable->setItem(row, 2, new QTableWidgetItem(details));
-    historyTable->setItem(row, 3, new QTableWidgetItem(result));
+    appendRow({timestamp, type, details, result, frameArchive});
     
     // Save to CSV file
     QString path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/FFmpegComparisonTool_History.csv";
     QFile file(path);
     if (file.open(QIODevice::Append | QIODevice::Text)) {
         QTextStream out(&file);
-        // Use a custom delimiter ";,;" to avoid issues with commas in filenames/results
-        out << timestamp << ";,;" << type << ";,;" << details << ";,;" << result << "\n";
+        // Use a custom delimiter ";,;" to avoid issues with commas in filenames/results.
+        // The per-frame archive path is an optional fifth field.
+        out << timestamp << ";,;" << type << ";,;" << details << ";,;" << result;
+        if (!frameArchive.isEmpty()) out << ";,;" << frameArchive;
+        out << "\n";
     }
 }
 
+void HistoryTab::appendRow(const QStringList& fields) {
+    int row = historyTable->rowCount();
+    historyTable->insertRow(row);
+    for (int col = 0; col < 4; ++col)
+        historyTable->setItem(row, col, new QTableWidgetItem(fields.value(col)));
+
+    const QString archive = fields.value(4);
+    QTableWidgetItem *frameItem = new QTableWidgetItem(archive.isEmpty() ? QString() : QString("View"));
+    frameItem->setData(Qt::UserRole, archive);
+    if (!archive.isEmpty()) frameItem->setToolTip("Double-click to view per-frame data\n" + archive);
+    historyTable->setItem(row, 4, frameItem);
+}
+
 void HistoryTab::loadHistory() {
     QString path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/FFmpegComparisonTool_History.csv";
     QFile file(path);
@@ -52,14 +98,128 @@ void HistoryTab::loadHistory() {
         while (!in.atEnd()) {
             QString line = in.readLine();
             QStringList fields = line.split(";,;");
-            if (fields.size() >= 4) {
-                int row = historyTable->rowCount();
-                historyTable->insertRow(row);
-                historyTable->setItem(row, 0, new QTableWidgetItem(fields[0]));
-                historyTable->setItem(row, 1, new QTableWidgetItem(fields[1]));
-                historyTable->setItem(row, 2, new QTableWidgetItem(fields[2]));
-                historyTable->setItem(row, 3, new QTableWidgetItem(fields[3]));
-            }
+            if (fields.size() >= 4) appendRow(fields);
         }
     }
-}
\ No newline at end of file
+}
+
+void HistoryTab::showFrameData(int row) {
+    const QString path = historyTable->item(row, 4)->data(Qt::UserRole).toString();
+    if (path.isEmpty()) return;
+
+    QElapsedTimer timer;
+    timer.start();
+    auto archive = std::make_shared<FrameArchive>();
+    QString error;
+    if (!archive->open(path, &error)) {
+        QMessageBox::warning(this, "Per-Frame Data", "Could not open " + path + ":\n" + error);
+        return;
+    }
+    const qint64 openMs = timer.elapsed();
+
+    QDialog *dialog = new QDialog(this);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("Per-Frame Data - " + historyTable->item(row, 2)->text());
+    QVBoxLayout *layout = new QVBoxLayout(dialog);
+
+    const QJsonObject meta = archive->metadata();
+    QString info = QString("%1 frames").arg(archive->frameCount());
+    if (archive->frameRate() > 0) info += QString(" at %1 fps").arg(archive->frameRate(), 0, 'f', 3);
+    if (!meta.value("proxy").toString().isEmpty()) info += " - PROXY " + meta.value("proxy").toString();
+    info += QString(" (opened in %1 ms)").arg(openMs);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    QComboBox *metricCombo = new QComboBox(dialog);
+    const QList<QPair<QString, FrameMetrics::Metric>> metrics{
+        {"SSIM", FrameMetrics::Ssim}, {"PSNR", FrameMetrics::Psnr}, {"VMAF", FrameMetrics::Vmaf}};
+    for (const auto& m : metrics)
+        if (archive->hasMetric(m.second)) metricCombo->addItem(m.first, m.second);
+    controls->addWidget(new QLabel("Metric:", dialog));
+    controls->addWidget(metricCombo);
+    controls->addWidget(new QLabel(info, dialog), 1);
+    layout->addLayout(controls);
+
+    QualityTimeline *timeline = new QualityTimeline(dialog);
+    layout->addWidget(timeline);
+    auto applyMetric = [timeline, metricCombo]() {
+        timeline->setMetric(static_cast<FrameMetrics::Metric>(metricCombo->currentData().toInt()));
+    };
+    connect(metricCombo, &QComboBox::currentIndexChanged, dialog, applyMetric);
+    metricCombo->setCurrentIndex(metricCombo->count() - 1);   // VMAF when present
+    applyMetric();
+    timeline->setArchive(archive);
+
+    dialog->resize(900, 320);
+    dialog->show();
+}
+
+void HistoryTab::exportReport() {
+    // Rows are copied here; parsing, statistics and formatting run on a worker thread
+    QList<int> rows;
+    for (const QModelIndex& index : historyTable->selectionModel()->selectedRows()) rows << index.row();
+    if (rows.isEmpty())
+        for (int row = 0; row < historyTable->rowCount(); ++row) rows << row;
+    std::sort(rows.begin(), rows.end());
+    QList<QStringList> entries;
+    for (int row : std::as_const(rows)) {
+        QStringList fields;
+        for (int col = 0; col < 4; ++col) fields << historyTable->item(row, col)->text();
+        entries << fields;
+    }
+    if (entries.isEmpty()) return;
+
+    // Optional A/B comparison of two encoder configurations
+    QDialog dialog(this);
+    dialog.setWindowTitle("Export Report");
+    QFormLayout *form = new QFormLayout(&dialog);
+    QLineEdit *configAEdit = new QLineEdit(&dialog);
+    QLineEdit *configBEdit = new QLineEdit(&dialog);
+    configAEdit->setPlaceholderText("e.g. x264 (optional)");
+    configBEdit->setPlaceholderText("e.g. x265 (optional)");
+    form->addRow(new QLabel(QString("%1 results. To compute BD-rate, enter text that identifies each\n"
+                                    "configuration in the Details column:").arg(entries.size()), &dialog));
+    form->addRow("Configuration A (anchor):", configAEdit);
+    form->addRow("Configuration B (test):", configBEdit);
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    form->addRow(buttons);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    if (dialog.exec() != QDialog::Accepted) return;
+    const QString configA = configAEdit->text().trimmed();
+    const QString configB = configBEdit->text().trimmed();
+    if (configA.isEmpty() != configB.isEmpty()) {
+        QMessageBox::warning(this, "Export Report", "Enter both configurations, or neither.");
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Export Report",
+        QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/quality_report.html",
+        "HTML report (*.html);;JSON report (*.json)");
+    if (path.isEmpty()) return;
+    const bool json = path.endsWith(".json", Qt::CaseInsensitive);
+
+    reportBtn->setEnabled(false);
+    reportStatusLabel->setText(QString("Building report from %1 results...").arg(entries.size()));
+    auto error = std::make_shared<QString>();
+    QThread *worker = QThread::create([entries, configA, configB, path, json, error]() {
+        const BatchReport report = BatchReport::build(entries, configA, configB);
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            *error = file.errorString();
+            return;
+        }
+        file.write(json ? QJsonDocument(report.toJson()).toJson() : report.toHtml().toUtf8());
+        if (!file.commit()) *error = file.errorString();
+    });
+    connect(worker, &QThread::finished, this, [this, worker, path, error]() {
+        worker->deleteLater();
+        reportBtn->setEnabled(true);
+        if (error->isEmpty()) {
+            reportStatusLabel->setText("Report saved to " + path);
+        } else {
+            reportStatusLabel->clear();
+            QMessageBox::warning(this, "Export Report", "Could not write " + path + ":\n" + *error);
+        }
+    });
+    worker->start();
+}
@@ -3,19 +3,28 @@
 
 #include <QWidget>
 #include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
 
 class HistoryTab : public QWidget {
     Q_OBJECT
 
 public:
     explicit HistoryTab(QWidget *parent = nullptr);
-    void addEntry(const QString& type, const QString& details, const QString& result);
+    // frameArchive: optional FrameArchive with the entry's per-frame data
+    void addEntry(const QString& type, const QString& details, const QString& result,
+                  const QString& frameArchive = QString());
 
 private:
     void setupUI();
     void loadHistory();
+    void appendRow(const QStringList& fields);
+    void showFrameData(int row);
+    void exportReport();
     
     QTableWidget *historyTable;
+    QPushButton *reportBtn;
+    QLabel *reportStatusLabel;
 };
 
 #endif // HISTORYTAB_H
\ No newline at end of file
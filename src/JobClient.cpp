@@ -0,0 +1,98 @@
+#include "JobClient.h"
+#include "JobProtocol.h"
+#include <QJsonDocument>
+#include <QLocalSocket>
+#include <QTcpSocket>
+
+JobClient::JobClient(QObject *parent) : QObject(parent) {}
+
+JobClient::~JobClient() {
+    if (m_socket) m_socket->disconnect(this);
+}
+
+bool JobClient::connectToServer(const QString& address, int timeoutMs, QString *errorMessage) {
+    disconnectFromServer();
+    const JobProtocol::Address a = JobProtocol::parseAddress(address);
+
+    if (a.isLocal) {
+        QLocalSocket *socket = new QLocalSocket(this);
+        socket->connectToServer(a.localName);
+        if (!socket->waitForConnected(timeoutMs)) {
+            if (errorMessage) *errorMessage = socket->errorString();
+            delete socket;
+            return false;
+        }
+        connect(socket, &QLocalSocket::disconnected, this, &JobClient::disconnectFromServer);
+        m_socket = socket;
+    } else {
+        QTcpSocket *socket = new QTcpSocket(this);
+        socket->connectToHost(a.host, a.port);
+        if (!socket->waitForConnected(timeoutMs)) {
+            if (errorMessage) *errorMessage = socket->errorString();
+            delete socket;
+            return false;
+        }
+        connect(socket, &QTcpSocket::disconnected, this, &JobClient::disconnectFromServer);
+        m_socket = socket;
+    }
+
+    m_address = address;
+    connect(m_socket, &QIODevice::readyRead, this, [this]() {
+        m_buffer += m_socket->readAll();
+        int newline;
+        while ((newline = m_buffer.indexOf('\n')) >= 0) {
+            const QByteArray line = m_buffer.left(newline).trimmed();
+            m_buffer.remove(0, newline + 1);
+            if (!line.isEmpty()) handleLine(line);
+        }
+    });
+    return true;
+}
+
+void JobClient::disconnectFromServer() {
+    if (!m_socket) return;
+    m_socket->disconnect(this);
+    m_socket->close();
+    m_socket->deleteLater();
+    m_socket = nullptr;
+    m_buffer.clear();
+
+    // Fail outstanding calls so callers don't wait forever
+    const QMap<int, Callback> pending = m_pending;
+    m_pending.clear();
+    for (const Callback& callback : pending)
+        if (callback) callback(QJsonValue(), "Disconnected from server");
+    emit disconnected();
+}
+
+bool JobClient::isConnected() const {
+    return m_socket && m_socket->isOpen();
+}
+
+void JobClient::call(const QString& method, const QJsonObject& params, Callback callback) {
+    if (!isConnected()) {
+        if (callback) callback(QJsonValue(), "Not connected to a job server");
+        return;
+    }
+    const int id = m_nextId++;
+    if (callback) m_pending.insert(id, callback);
+    m_socket->write(JobProtocol::encode(JobProtocol::request(id, method, params)));
+}
+
+void JobClient::handleLine(const QByteArray& line) {
+    const QJsonObject message = QJsonDocument::fromJson(line).object();
+    if (message.isEmpty()) return;
+
+    // Notifications have a method and no id; responses have an id and no method
+    if (message.contains("method")) {
+        emit notification(message.value("method").toString(), message.value("params").toObject());
+        return;
+    }
+
+    const Callback callback = m_pending.take(message.value("id").toInt());
+    if (!callback) return;
+    if (message.contains("error"))
+        callback(QJsonValue(), message.value("error").toObject().value("message").toString());
+    else
+        callback(message.value("result"), QString());
+}
@@ -0,0 +1,47 @@
+#ifndef JOBCLIENT_H
+#define JOBCLIENT_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QMap>
+#include <QString>
+#include <functional>
+
+class QIODevice;
+
+// Client side of the JobServer protocol (see JobProtocol.h). FfmpegJob and AbAv1Job
+// use it to run remotely while keeping their usual signals, so tabs don't change.
+class JobClient : public QObject {
+    Q_OBJECT
+
+public:
+    using Callback = std::function<void(const QJsonValue& result, const QString& error)>;
+
+    explicit JobClient(QObject *parent = nullptr);
+    ~JobClient();
+
+    // Blocks for at most timeoutMs; address is "[host:]port" or "local:<name>".
+    bool connectToServer(const QString& address, int timeoutMs = 3000, QString *errorMessage = nullptr);
+    void disconnectFromServer();
+    bool isConnected() const;
+    QString address() const { return m_address; }
+
+    void call(const QString& method, const QJsonObject& params, Callback callback = Callback());
+
+signals:
+    void notification(const QString& method, const QJsonObject& params);
+    void disconnected();
+
+private:
+    void handleLine(const QByteArray& line);
+
+    QIODevice *m_socket = nullptr;
+    QString m_address;
+    QByteArray m_buffer;
+    QMap<int, Callback> m_pending;
+    int m_nextId = 1;
+};
+
+#endif // JOBCLIENT_H
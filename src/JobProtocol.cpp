@@ -0,0 +1,200 @@
+#include "JobProtocol.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QtEndian>
+
+namespace JobProtocol {
+
+Address parseAddress(const QString& text) {
+    Address address;
+    const QString t = text.trimmed();
+    if (t.startsWith("local:")) {
+        address.isLocal   = true;
+        address.localName = t.mid(6);
+        return address;
+    }
+    const int colon = t.lastIndexOf(':');
+    if (colon >= 0) {
+        if (colon > 0) address.host = t.left(colon);
+        address.port = static_cast<quint16>(t.mid(colon + 1).toUInt());
+    } else if (!t.isEmpty()) {
+        address.port = static_cast<quint16>(t.toUInt());
+    }
+    return address;
+}
+
+QByteArray encode(const QJsonObject& message) {
+    return QJsonDocument(message).toJson(QJsonDocument::Compact) + '\n';
+}
+
+QJsonObject request(int id, const QString& method, const QJsonObject& params) {
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", params}};
+}
+
+QJsonObject response(const QJsonValue& id, const QJsonValue& result) {
+    return {{"jsonrpc", "2.0"}, {"id", id}, {"result", result}};
+}
+
+QJsonObject error(const QJsonValue& id, int code, const QString& message) {
+    return {{"jsonrpc", "2.0"}, {"id", id},
+            {"error", QJsonObject{{"code", code}, {"message", message}}}};
+}
+
+QJsonObject notification(const QString& method, const QJsonObject& params) {
+    return {{"jsonrpc", "2.0"}, {"method", method}, {"params", params}};
+}
+
+QJsonObject toJson(const SsimResult& r) {
+    return {{"y", r.y}, {"u", r.u}, {"v", r.v}, {"all", r.all},
+            {"yDb", r.yDb}, {"uDb", r.uDb}, {"vDb", r.vDb}, {"allDb", r.allDb}};
+}
+
+QJsonObject toJson(const PsnrResult& r) {
+    return {{"yDb", r.yDb}, {"uDb", r.uDb}, {"vDb", r.vDb}, {"avgDb", r.avgDb}};
+}
+
+SsimResult ssimFromJson(const QJsonObject& o) {
+    SsimResult r;
+    r.y = o.value("y").toDouble();     r.yDb   = o.value("yDb").toString();
+    r.u = o.value("u").toDouble();     r.uDb   = o.value("uDb").toString();
+    r.v = o.value("v").toDouble();     r.vDb   = o.value("vDb").toString();
+    r.all = o.value("all").toDouble(); r.allDb = o.value("allDb").toString();
+    return r;
+}
+
+PsnrResult psnrFromJson(const QJsonObject& o) {
+    PsnrResult r;
+    r.yDb = o.value("yDb").toString(); r.uDb   = o.value("uDb").toString();
+    r.vDb = o.value("vDb").toString(); r.avgDb = o.value("avgDb").toString();
+    return r;
+}
+
+QJsonObject toJson(const ComparisonResult& r) {
+    QJsonObject o{{"file", r.file}};
+    if (r.hasSsim) o["ssim"] = toJson(r.ssim);
+    if (r.hasPsnr) o["psnr"] = toJson(r.psnr);
+    if (r.hasVmaf) o["vmaf"] = r.vmaf;
+    if (!r.proxy.isEmpty()) o["proxy"] = r.proxy;
+    if (!r.window.isEmpty()) o["window"] = r.window;
+    if (!r.crop.isEmpty()) o["crop"] = r.crop;
+    if (!r.identical.isEmpty()) o["identical"] = r.identical;
+    if (r.bitrateKbps > 0) o["bitrateKbps"] = r.bitrateKbps;
+    if (!r.pixelFormat.isEmpty())
+        o["format"] = QJsonObject{{"pixelFormat", r.pixelFormat}, {"bitDepth", r.bitDepth}, {"transfer", r.transfer}};
+    if (r.hasGate) o["gate"] = QJsonObject{{"passed", r.gatePassed}, {"detail", r.gateDetail}};
+    if (!r.extra.isEmpty()) {
+        QJsonObject extra;
+        for (const MetricScore& s : r.extra) extra[s.id] = s.value;
+        o["extra"] = extra;
+    }
+    return o;
+}
+
+ComparisonResult comparisonFromJson(const QJsonObject& o) {
+    ComparisonResult r;
+    r.file    = o.value("file").toString();
+    r.hasSsim = o.contains("ssim");
+    r.hasPsnr = o.contains("psnr");
+    r.hasVmaf = o.contains("vmaf");
+    if (r.hasSsim) r.ssim = ssimFromJson(o.value("ssim").toObject());
+    if (r.hasPsnr) r.psnr = psnrFromJson(o.value("psnr").toObject());
+    r.vmaf  = o.value("vmaf").toDouble();
+    r.proxy = o.value("proxy").toString();
+    r.window = o.value("window").toString();
+    r.crop   = o.value("crop").toString();
+    r.identical = o.value("identical").toString();
+    r.bitrateKbps = o.value("bitrateKbps").toDouble();
+    const QJsonObject format = o.value("format").toObject();
+    r.pixelFormat = format.value("pixelFormat").toString();
+    r.bitDepth    = format.value("bitDepth").toInt();
+    r.transfer    = format.value("transfer").toString();
+    r.hasGate = o.contains("gate");
+    if (r.hasGate) {
+        const QJsonObject gate = o.value("gate").toObject();
+        r.gatePassed = gate.value("passed").toBool();
+        r.gateDetail = gate.value("detail").toString();
+    }
+    // Labels and precision come from the local MetricSet; ids it doesn't know are dropped
+    const QJsonObject extra = o.value("extra").toObject();
+    for (const ExtraMetric& m : MetricSet::available()) {
+        if (extra.contains(m.id))
+            r.extra << MetricScore{m.id, m.label, m.unit, extra.value(m.id).toDouble(), m.decimals};
+    }
+    return r;
+}
+
+// Trace events are left out: they can run to thousands per job and only the
+// machine that ran the job can export a trace.
+QJsonObject toJson(const JobStats& s) {
+    QJsonArray stages;
+    for (const StageTiming& t : s.stages)
+        stages.append(QJsonObject{{"name", t.name}, {"calls", t.calls}, {"user", t.userSeconds},
+                                  {"system", t.systemSeconds}, {"real", t.realSeconds}});
+    return {{"threads", s.threads}, {"frames", s.frames},
+            {"queued", s.queuedSeconds}, {"startup", s.startupSeconds},
+            {"processing", s.processingSeconds}, {"finalize", s.finalizeSeconds},
+            {"post", s.postSeconds}, {"wall", s.wallSeconds},
+            {"user", s.userSeconds}, {"system", s.systemSeconds}, {"maxRssKiB", s.maxRssKiB},
+            {"sampledCpu", s.sampledCpuSeconds}, {"sampledPeakRssKiB", s.sampledPeakRssKiB},
+            {"stages", stages}};
+}
+
+static QString encodeSeries(const QVector<float>& series) {
+    QByteArray bytes(series.size() * int(sizeof(float)), Qt::Uninitialized);
+    for (int i = 0; i < series.size(); ++i)
+        qToLittleEndian(series[i], bytes.data() + i * sizeof(float));
+    return QString::fromLatin1(bytes.toBase64());
+}
+
+static QVector<float> decodeSeries(const QJsonValue& value) {
+    const QByteArray bytes = QByteArray::fromBase64(value.toString().toLatin1());
+    QVector<float> series(bytes.size() / int(sizeof(float)));
+    for (int i = 0; i < series.size(); ++i)
+        series[i] = qFromLittleEndian<float>(bytes.constData() + i * sizeof(float));
+    return series;
+}
+
+QJsonObject toJson(const FrameMetrics& m) {
+    return {{"ssim", encodeSeries(m.ssim)}, {"psnr", encodeSeries(m.psnr)}, {"vmaf", encodeSeries(m.vmaf)},
+            {"frameRate", m.frameRate}, {"startTime", m.startTime}};
+}
+
+FrameMetrics frameMetricsFromJson(const QJsonObject& o) {
+    FrameMetrics m;
+    m.ssim      = decodeSeries(o.value("ssim"));
+    m.psnr      = decodeSeries(o.value("psnr"));
+    m.vmaf      = decodeSeries(o.value("vmaf"));
+    m.frameRate = o.value("frameRate").toDouble();
+    m.startTime = o.value("startTime").toDouble();
+    return m;
+}
+
+JobStats jobStatsFromJson(const QJsonObject& o) {
+    JobStats s;
+    s.threads           = o.value("threads").toInt();
+    s.frames            = o.value("frames").toInteger();
+    s.queuedSeconds     = o.value("queued").toDouble();
+    s.startupSeconds    = o.value("startup").toDouble();
+    s.processingSeconds = o.value("processing").toDouble();
+    s.finalizeSeconds   = o.value("finalize").toDouble();
+    s.postSeconds       = o.value("post").toDouble();
+    s.wallSeconds       = o.value("wall").toDouble();
+    s.userSeconds       = o.value("user").toDouble(-1);
+    s.systemSeconds     = o.value("system").toDouble(-1);
+    s.maxRssKiB         = o.value("maxRssKiB").toInteger(-1);
+    s.sampledCpuSeconds = o.value("sampledCpu").toDouble(-1);
+    s.sampledPeakRssKiB = o.value("sampledPeakRssKiB").toInteger(-1);
+    for (const QJsonValue& v : o.value("stages").toArray()) {
+        const QJsonObject t = v.toObject();
+        StageTiming stage;
+        stage.name          = t.value("name").toString();
+        stage.calls         = t.value("calls").toInt();
+        stage.userSeconds   = t.value("user").toDouble();
+        stage.systemSeconds = t.value("system").toDouble();
+        stage.realSeconds   = t.value("real").toDouble();
+        s.stages << stage;
+    }
+    return s;
+}
+
+} // namespace JobProtocol
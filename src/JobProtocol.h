@@ -0,0 +1,54 @@
+#ifndef JOBPROTOCOL_H
+#define JOBPROTOCOL_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include "FfmpegJob.h"
+
+// Wire format shared by JobServer and JobClient: JSON-RPC 2.0, one compact JSON
+// object per line, over TCP or a local (Unix-domain / named-pipe) socket.
+//
+// Requests:       compare, crfSearch, cancel, subscribe, listJobs, ping
+// Notifications:  job.log, job.progress, job.ssim, job.psnr, job.vmaf,
+//                 job.comparison, job.frames, job.stats, job.prediction, job.finished
+//                 (all carry "jobId")
+namespace JobProtocol {
+    constexpr int DefaultPort = 7450;
+
+    enum ErrorCode {
+        ParseError     = -32700,
+        InvalidRequest = -32600,
+        MethodNotFound = -32601,
+        InvalidParams  = -32602
+    };
+
+    // "local:<name>" selects a local socket; anything else is "[host:]port" over TCP.
+    struct Address {
+        bool isLocal = false;
+        QString host = "127.0.0.1";
+        quint16 port = DefaultPort;
+        QString localName;
+    };
+    Address parseAddress(const QString& text);
+
+    QByteArray encode(const QJsonObject& message);
+    QJsonObject request(int id, const QString& method, const QJsonObject& params);
+    QJsonObject response(const QJsonValue& id, const QJsonValue& result);
+    QJsonObject error(const QJsonValue& id, int code, const QString& message);
+    QJsonObject notification(const QString& method, const QJsonObject& params);
+
+    QJsonObject toJson(const SsimResult& r);
+    QJsonObject toJson(const PsnrResult& r);
+    SsimResult ssimFromJson(const QJsonObject& o);
+    PsnrResult psnrFromJson(const QJsonObject& o);
+    QJsonObject toJson(const ComparisonResult& r);
+    ComparisonResult comparisonFromJson(const QJsonObject& o);
+    QJsonObject toJson(const JobStats& s);
+    JobStats jobStatsFromJson(const QJsonObject& o);
+    // Series travel as base64 little-endian float32, a quarter of their JSON number size
+    QJsonObject toJson(const FrameMetrics& m);
+    FrameMetrics frameMetricsFromJson(const QJsonObject& o);
+}
+
+#endif // JOBPROTOCOL_H
@@ -0,0 +1,224 @@
+#include "JobScheduler.h"
+#include "ProcessSupervisor.h"
+#include <QProcess>
+#include <QSettings>
+#include <QStringList>
+#include <QThread>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <csignal>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(Q_OS_LINUX)
+#include <sched.h>
+#include <sys/prctl.h>
+#endif
+#endif
+
+JobScheduler* JobScheduler::instance() {
+    static JobScheduler *scheduler = new JobScheduler();
+    return scheduler;
+}
+
+JobScheduler::JobScheduler(QObject *parent) : QObject(parent) {
+    m_budget = qMax(1, QThread::idealThreadCount());
+    loadSettings();
+}
+
+void JobScheduler::loadSettings() {
+    QSettings settings;
+    m_budget    = qMax(1, settings.value("scheduler/threadBudget", m_budget).toInt());
+    m_niceLevel = qBound(0, settings.value("scheduler/niceLevel", 0).toInt(), 19);
+    m_affinity  = parseCpuList(settings.value("scheduler/cpuAffinity").toString());
+    m_wallTimeout = qMax(0, settings.value("scheduler/wallTimeout", m_wallTimeout).toInt());
+    m_idleTimeout = qMax(0, settings.value("scheduler/idleTimeout", m_idleTimeout).toInt());
+}
+
+void JobScheduler::saveSettings() const {
+    QSettings settings;
+    settings.setValue("scheduler/threadBudget", m_budget);
+    settings.setValue("scheduler/niceLevel", m_niceLevel);
+    settings.setValue("scheduler/cpuAffinity", formatCpuList(m_affinity));
+    settings.setValue("scheduler/wallTimeout", m_wallTimeout);
+    settings.setValue("scheduler/idleTimeout", m_idleTimeout);
+}
+
+void JobScheduler::setThreadBudget(int threads) {
+    m_budget = qMax(1, threads);
+    saveSettings();
+    scheduleDispatch();
+}
+
+void JobScheduler::setNiceLevel(int level) {
+    m_niceLevel = qBound(0, level, 19);
+    saveSettings();
+}
+
+void JobScheduler::setCpuAffinity(const QList<int>& cpus) {
+    m_affinity = cpus;
+    saveSettings();
+}
+
+void JobScheduler::setWallTimeout(int seconds) {
+    m_wallTimeout = qMax(0, seconds);
+    saveSettings();
+}
+
+void JobScheduler::setIdleTimeout(int seconds) {
+    m_idleTimeout = qMax(0, seconds);
+    saveSettings();
+}
+
+int JobScheduler::submit(const QString& label, int priority, int requestedThreads,
+                         std::function<void(int)> launch) {
+    Entry entry;
+    entry.id       = m_nextId++;
+    entry.label    = label;
+    entry.priority = priority;
+    entry.threads  = requestedThreads > 0 ? requestedThreads : m_budget;
+    entry.launch   = std::move(launch);
+
+    // Insert after every entry of equal or higher priority: FIFO within a priority level
+    auto pos = std::find_if(m_queue.begin(), m_queue.end(),
+                            [priority](const Entry& e) { return e.priority < priority; });
+    m_queue.insert(pos, entry);
+
+    scheduleDispatch();
+    return entry.id;
+}
+
+void JobScheduler::release(int ticket) {
+    auto it = m_running.find(ticket);
+    if (it == m_running.end()) return;
+    m_used -= it.value();
+    m_running.erase(it);
+    scheduleDispatch();
+}
+
+bool JobScheduler::withdraw(int ticket) {
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i].id == ticket) {
+            m_queue.removeAt(i);
+            emit queueChanged(m_running.size(), m_queue.size());
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobScheduler::isQueued(int ticket) const {
+    return std::any_of(m_queue.begin(), m_queue.end(),
+                       [ticket](const Entry& e) { return e.id == ticket; });
+}
+
+// Launches are always deferred to the event loop, so launch callbacks never run
+// inside submit() (before the caller has its ticket) or re-enter a release().
+void JobScheduler::scheduleDispatch() {
+    if (m_dispatchPending) return;
+    m_dispatchPending = true;
+    QMetaObject::invokeMethod(this, [this]() {
+        m_dispatchPending = false;
+        dispatch();
+    }, Qt::QueuedConnection);
+}
+
+// Strict priority order: the head of the queue is never overtaken, so a big
+// high-priority job can't be starved by a stream of small ones. The head starts
+// once at least half of its request is free, or immediately on an idle machine.
+void JobScheduler::dispatch() {
+    while (!m_queue.isEmpty()) {
+        const Entry& head = m_queue.first();
+        const int wanted  = qMin(head.threads, m_budget);
+        const int free    = m_budget - m_used;
+        const int granted = qMin(wanted, free);
+
+        if (!m_running.isEmpty() && granted < qMax(1, (wanted + 1) / 2)) break;
+
+        Entry entry = m_queue.takeFirst();
+        const int threads = qMax(1, granted);
+        m_running.insert(entry.id, threads);
+        m_used += threads;
+        entry.launch(threads);
+    }
+    emit queueChanged(m_running.size(), m_queue.size());
+}
+
+ProcessSupervisor* JobScheduler::prepareProcess(QProcess *process) const {
+    ProcessSupervisor *supervisor = new ProcessSupervisor(process);
+    supervisor->setWallTimeout(m_wallTimeout);
+    supervisor->setIdleTimeout(m_idleTimeout);
+#if defined(Q_OS_UNIX)
+    const int nice = m_niceLevel;
+#if defined(Q_OS_LINUX)
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int cpu : m_affinity)
+        if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &cpus);
+    const bool pin = !m_affinity.isEmpty();
+#endif
+    // Runs in the forked child before exec; only async-signal-safe calls here
+    process->setChildProcessModifier([=]() {
+        ::setpgid(0, 0);
+#if defined(Q_OS_LINUX)
+        // Don't outlive the app if it crashes or is killed
+        ::prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+        if (nice > 0) ::setpriority(PRIO_PROCESS, 0, nice);
+#if defined(Q_OS_LINUX)
+        if (pin) ::sched_setaffinity(0, sizeof(cpus), &cpus);
+#endif
+    });
+#endif
+    return supervisor;
+}
+
+void JobScheduler::applyToStartedProcess(QProcess *process) const {
+#if defined(Q_OS_WIN)
+    HANDLE handle = OpenProcess(PROCESS_SET_INFORMATION | PROCESS_QUERY_INFORMATION, FALSE,
+                                static_cast<DWORD>(process->processId()));
+    if (!handle) return;
+    if (m_niceLevel > 0)
+        SetPriorityClass(handle, m_niceLevel >= 15 ? IDLE_PRIORITY_CLASS : BELOW_NORMAL_PRIORITY_CLASS);
+    if (!m_affinity.isEmpty()) {
+        DWORD_PTR mask = 0;
+        for (int cpu : m_affinity)
+            if (cpu >= 0 && cpu < int(sizeof(DWORD_PTR) * 8)) mask |= DWORD_PTR(1) << cpu;
+        if (mask) SetProcessAffinityMask(handle, mask);
+    }
+    CloseHandle(handle);
+#else
+    Q_UNUSED(process);
+#endif
+}
+
+QList<int> JobScheduler::parseCpuList(const QString& text) {
+    QList<int> cpus;
+    const QStringList parts = text.split(',', Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        const QStringList range = part.trimmed().split('-');
+        bool okA = false, okB = true;
+        const int a = range.value(0).toInt(&okA);
+        const int b = range.size() > 1 ? range.value(1).toInt(&okB) : a;
+        if (!okA || !okB) continue;
+        for (int cpu = a; cpu <= b; ++cpu)
+            if (!cpus.contains(cpu)) cpus << cpu;
+    }
+    std::sort(cpus.begin(), cpus.end());
+    return cpus;
+}
+
+QString JobScheduler::formatCpuList(const QList<int>& cpus) {
+    QStringList parts;
+    for (int i = 0; i < cpus.size();) {
+        int j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        parts << (i == j ? QString::number(cpus[i])
+                         : QString("%1-%2").arg(cpus[i]).arg(cpus[j]));
+        i = j + 1;
+    }
+    return parts.join(',');
+}
@@ -0,0 +1,97 @@
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <functional>
+
+class QProcess;
+class ProcessSupervisor;
+
+// Central admission control for every external process the app launches.
+// Jobs submit a request for N threads; the scheduler starts them in priority order
+// while the machine-wide thread budget allows, and tells each job how many threads
+// it was granted so it can pass them on (-threads, n_threads, encoder options).
+// It also applies nice/affinity settings and the supervision limits (timeouts)
+// every job process runs under.
+class JobScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum Priority { Low = 0, Normal = 1, High = 2 };
+
+    static JobScheduler* instance();
+
+    // Queues a job. `launch` runs (possibly immediately) with the granted thread count.
+    // requestedThreads <= 0 asks for the whole budget. Returns a ticket for release()/withdraw().
+    int submit(const QString& label, int priority, int requestedThreads,
+               std::function<void(int grantedThreads)> launch);
+    // Returns a launched job's threads to the pool and starts whatever fits next.
+    void release(int ticket);
+    // Removes a job that is still queued. Returns false if it has already been launched.
+    bool withdraw(int ticket);
+    bool isQueued(int ticket) const;
+
+    int runningCount() const { return m_running.size(); }
+    int queuedCount() const { return m_queue.size(); }
+
+    int threadBudget() const { return m_budget; }
+    void setThreadBudget(int threads);
+    // Unix nice increment (0-19) / Windows below-normal priority class when > 0
+    int niceLevel() const { return m_niceLevel; }
+    void setNiceLevel(int level);
+    // CPU indices child processes are pinned to; empty means no pinning
+    QList<int> cpuAffinity() const { return m_affinity; }
+    void setCpuAffinity(const QList<int>& cpus);
+    // Stop a job process that runs longer than this / prints nothing for this long; 0 = never
+    int wallTimeout() const { return m_wallTimeout; }
+    void setWallTimeout(int seconds);
+    int idleTimeout() const { return m_idleTimeout; }
+    void setIdleTimeout(int seconds);
+
+    // Call before QProcess::start(): puts the child in its own process group, applies
+    // nice/affinity so everything it spawns inherits them, and attaches a supervisor
+    // (owned by the process) with the current timeouts. Cancel through the supervisor
+    // or ProcessSupervisor::killTree() so the whole tree goes.
+    ProcessSupervisor* prepareProcess(QProcess *process) const;
+    // Call after QProcess::start() succeeded; applies settings that need a running pid.
+    void applyToStartedProcess(QProcess *process) const;
+
+    // Parses "0-3,8,10-11" into CPU indices; the inverse of formatCpuList().
+    static QList<int> parseCpuList(const QString& text);
+    static QString formatCpuList(const QList<int>& cpus);
+
+signals:
+    void queueChanged(int running, int queued);
+
+private:
+    explicit JobScheduler(QObject *parent = nullptr);
+    void loadSettings();
+    void saveSettings() const;
+    void scheduleDispatch();
+    void dispatch();
+
+    struct Entry {
+        int id = 0;
+        QString label;
+        int priority = Normal;
+        int threads = 1;
+        std::function<void(int)> launch;
+    };
+
+    QList<Entry> m_queue;      // kept sorted: priority desc, then submission order
+    QMap<int, int> m_running;  // ticket -> granted threads
+    int m_used = 0;
+    int m_nextId = 1;
+    bool m_dispatchPending = false;
+
+    int m_budget = 1;
+    int m_niceLevel = 0;
+    QList<int> m_affinity;
+    int m_wallTimeout = 0;
+    int m_idleTimeout = 0;
+};
+
+#endif // JOBSCHEDULER_H
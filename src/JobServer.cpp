@@ -0,0 +1,358 @@
+#include "JobServer.h"
+#include "AbAv1Job.h"
+#include "FfmpegJob.h"
+#include "JobProtocol.h"
+#include "JobScheduler.h"
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+// A client sending more than this without a newline is dropped
+static constexpr int MaxLineLength = 1024 * 1024;
+
+JobServer::JobServer(QObject *parent) : QObject(parent) {}
+
+JobServer::~JobServer() = default;
+
+bool JobServer::listen(const QString& address, QString *errorMessage) {
+    const JobProtocol::Address a = JobProtocol::parseAddress(address);
+
+    if (a.isLocal) {
+        QLocalServer *server = new QLocalServer(this);
+        QLocalServer::removeServer(a.localName);  // stale socket from a crashed run
+        if (!server->listen(a.localName)) {
+            if (errorMessage) *errorMessage = server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QLocalServer::newConnection, this, [this, server]() {
+            while (QLocalSocket *socket = server->nextPendingConnection()) {
+                connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+                    removeConnection(socket);
+                });
+                addConnection(socket);
+            }
+        });
+        m_localServers << server;
+        m_addresses << "local:" + server->fullServerName();
+    } else {
+        QTcpServer *server = new QTcpServer(this);
+        if (!server->listen(QHostAddress(a.host), a.port)) {
+            if (errorMessage) *errorMessage = server->errorString();
+            delete server;
+            return false;
+        }
+        connect(server, &QTcpServer::newConnection, this, [this, server]() {
+            while (QTcpSocket *socket = server->nextPendingConnection()) {
+                connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+                    removeConnection(socket);
+                });
+                addConnection(socket);
+            }
+        });
+        m_tcpServers << server;
+        m_addresses << QString("%1:%2").arg(server->serverAddress().toString()).arg(server->serverPort());
+    }
+
+    emit logLine("Job server listening on " + m_addresses.last());
+    return true;
+}
+
+void JobServer::addConnection(QIODevice *socket) {
+    m_buffers.insert(socket, QByteArray());
+    connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+        QByteArray& buffer = m_buffers[socket];
+        buffer += socket->readAll();
+        int newline;
+        while ((newline = buffer.indexOf('\n')) >= 0) {
+            const QByteArray line = buffer.left(newline).trimmed();
+            buffer.remove(0, newline + 1);
+            if (!line.isEmpty()) handleLine(socket, line);
+        }
+        if (buffer.size() > MaxLineLength) {
+            emit logLine("Dropping client: request line too long");
+            socket->close();
+        }
+    });
+}
+
+void JobServer::removeConnection(QIODevice *socket) {
+    m_buffers.remove(socket);
+    // Jobs keep running; a client can re-attach to them with "subscribe"
+    for (JobRecord& record : m_jobs)
+        if (record.client == socket) record.client = nullptr;
+    socket->deleteLater();
+}
+
+void JobServer::send(QIODevice *socket, const QJsonObject& message) {
+    if (socket && socket->isOpen()) socket->write(JobProtocol::encode(message));
+}
+
+void JobServer::notify(int jobId, const QString& method, QJsonObject params) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) return;
+    params["jobId"] = jobId;
+    send(it->client, JobProtocol::notification(method, params));
+}
+
+void JobServer::handleLine(QIODevice *socket, const QByteArray& line) {
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(line, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+        send(socket, JobProtocol::error(QJsonValue(), JobProtocol::ParseError, parseError.errorString()));
+        return;
+    }
+
+    const QJsonObject message = doc.object();
+    const QJsonValue id       = message.value("id");
+    const QString method      = message.value("method").toString();
+    const QJsonObject params  = message.value("params").toObject();
+    if (method.isEmpty()) {
+        send(socket, JobProtocol::error(id, JobProtocol::InvalidRequest, "Missing method"));
+        return;
+    }
+
+    QString error;
+    QJsonValue result;
+
+    if (method == "ping") {
+        result = QJsonObject{{"threads", JobScheduler::instance()->threadBudget()},
+                             {"running", JobScheduler::instance()->runningCount()},
+                             {"queued",  JobScheduler::instance()->queuedCount()}};
+    } else if (method == "compare") {
+        result = startCompare(socket, params, &error);
+    } else if (method == "crfSearch") {
+        result = startCrfSearch(socket, params, &error);
+    } else if (method == "cancel" || method == "subscribe") {
+        auto it = m_jobs.find(params.value("jobId").toInt());
+        if (it == m_jobs.end()) {
+            error = "Unknown jobId";
+        } else if (method == "subscribe") {
+            it->client = socket;
+            result = jobSummary(*it);
+        } else {
+            if (auto *job = qobject_cast<FfmpegJob*>(it->job.data())) job->cancel();
+            if (auto *job = qobject_cast<AbAv1Job*>(it->job.data()))  job->cancel();
+            result = true;
+        }
+    } else if (method == "listJobs") {
+        QJsonArray jobs;
+        for (const JobRecord& record : std::as_const(m_jobs)) jobs.append(jobSummary(record));
+        result = jobs;
+    } else {
+        send(socket, JobProtocol::error(id, JobProtocol::MethodNotFound, "Unknown method: " + method));
+        return;
+    }
+
+    // Notifications (no id) get no reply, per JSON-RPC
+    if (id.isUndefined()) return;
+    if (!error.isEmpty()) send(socket, JobProtocol::error(id, JobProtocol::InvalidParams, error));
+    else                  send(socket, JobProtocol::response(id, result));
+}
+
+QJsonObject JobServer::startCompare(QIODevice *client, const QJsonObject& params, QString *error) {
+    // "distorted" is one path, or an array to score several encodes in one decode
+    const QString reference = params.value("reference").toString();
+    QStringList distorted;
+    const QJsonValue d = params.value("distorted");
+    if (d.isArray()) {
+        for (const QJsonValue& v : d.toArray()) distorted << v.toString();
+    } else if (!d.toString().isEmpty()) {
+        distorted << d.toString();
+    }
+    if (reference.isEmpty() || distorted.isEmpty() || distorted.contains(QString())) {
+        *error = "compare requires \"reference\" and \"distorted\"";
+        return {};
+    }
+
+    // "gates": quality-gate rules in QualityGate::parse() syntax
+    QString gateError;
+    const QList<GateRule> gates = QualityGate::parse(params.value("gates").toString(), &gateError);
+    if (!gateError.isEmpty()) {
+        *error = gateError;
+        return {};
+    }
+
+    // "windows": [{start, duration}] in seconds, scored against a single distorted file
+    QList<TimeWindow> windows;
+    for (const QJsonValue& v : params.value("windows").toArray()) {
+        const QJsonObject w = v.toObject();
+        windows << TimeWindow{w.value("start").toDouble(), w.value("duration").toDouble()};
+        if (windows.last().duration <= 0) {
+            *error = "every window needs a positive \"duration\"";
+            return {};
+        }
+    }
+    if (!windows.isEmpty() && distorted.size() != 1) {
+        *error = "\"windows\" requires a single distorted file";
+        return {};
+    }
+
+    const int jobId = m_nextJobId++;
+    FfmpegJob *job = new FfmpegJob(this);
+    job->setPriority(params.value("priority").toInt(JobScheduler::Normal));
+    job->setThreads(params.value("threads").toInt(0));
+    job->setStageTiming(params.value("stageTiming").toBool());
+    // "frameMetrics": also send each input's per-frame series (job.frames)
+    job->setCollectFrameMetrics(params.value("frameMetrics").toBool());
+    job->setQualityGates(gates);
+    // "metrics": extra libvmaf metric ids (MetricSet), e.g. ["ms_ssim", "cambi"]
+    QStringList metrics;
+    for (const QJsonValue& v : params.value("metrics").toArray()) metrics << v.toString();
+    job->setExtraMetrics(metrics);
+    job->setAutoCrop(params.value("autoCrop").toBool());
+    job->setSnapToKeyframes(params.value("snapToKeyframes").toBool());
+    job->setReferenceCache(params.value("referenceCache").toBool());
+    // "hashCheck": "packets" or "frames" (packets, then decoded frames)
+    const QString hashCheck = params.value("hashCheck").toString();
+    job->setHashCheck(hashCheck == "frames" ? FfmpegJob::PacketAndFrameHash
+                      : hashCheck == "packets" ? FfmpegJob::PacketHash : FfmpegJob::NoHashCheck);
+    if (params.contains("proxy")) {
+        const QJsonObject proxy = params.value("proxy").toObject();
+        job->setProxyMode(true, QSize(proxy.value("width").toInt(640), proxy.value("height").toInt(360)),
+                          proxy.value("vmaf").toBool());
+    }
+
+    JobRecord record;
+    record.id          = jobId;
+    record.type        = "compare";
+    record.description = QFileInfo(reference).fileName() + " vs " +
+                         (distorted.size() == 1 ? QFileInfo(distorted.first()).fileName()
+                                                : QString("%1 files").arg(distorted.size()));
+    record.job         = job;
+    record.client      = client;
+    m_jobs.insert(jobId, record);
+
+    connect(job, &FfmpegJob::logLine, this, [this, jobId](const QString& line) {
+        notify(jobId, "job.log", {{"line", line}});
+    });
+    connect(job, &FfmpegJob::progressUpdated, this, [this, jobId](double current, double total) {
+        notify(jobId, "job.progress", {{"current", current}, {"total", total}});
+    });
+    connect(job, &FfmpegJob::ssimResult, this, [this, jobId](const SsimResult& r) {
+        m_jobs[jobId].results["ssim"] = JobProtocol::toJson(r);
+        notify(jobId, "job.ssim", {{"result", JobProtocol::toJson(r)}});
+    });
+    connect(job, &FfmpegJob::psnrResult, this, [this, jobId](const PsnrResult& r) {
+        m_jobs[jobId].results["psnr"] = JobProtocol::toJson(r);
+        notify(jobId, "job.psnr", {{"result", JobProtocol::toJson(r)}});
+    });
+    connect(job, &FfmpegJob::vmafResult, this, [this, jobId](double score) {
+        m_jobs[jobId].results["vmaf"] = score;
+        notify(jobId, "job.vmaf", {{"score", score}});
+    });
+    connect(job, &FfmpegJob::comparisonResult, this, [this, jobId](int index, const ComparisonResult& r) {
+        QJsonArray comparisons = m_jobs[jobId].results.value("comparisons").toArray();
+        comparisons.append(JobProtocol::toJson(r));
+        m_jobs[jobId].results["comparisons"] = comparisons;
+        notify(jobId, "job.comparison", {{"index", index}, {"result", JobProtocol::toJson(r)}});
+    });
+    // Streamed only: the series are too large to keep in the job record
+    connect(job, &FfmpegJob::frameMetricsReady, this, [this, jobId](int index, const FrameMetrics& metrics) {
+        notify(jobId, "job.frames", {{"index", index}, {"metrics", JobProtocol::toJson(metrics)}});
+    });
+    connect(job, &FfmpegJob::statsReady, this, [this, jobId](const JobStats& stats) {
+        m_jobs[jobId].results["stats"] = JobProtocol::toJson(stats);
+        notify(jobId, "job.stats", {{"stats", JobProtocol::toJson(stats)}});
+    });
+    connect(job, &FfmpegJob::finished, this, [this, jobId, job](bool success, int exitCode) {
+        markFinished(jobId, success, exitCode, {{"gateAborted", job->abortedByGate()}});
+    });
+
+    emit logLine(QString("[job %1] compare %2").arg(jobId).arg(record.description));
+    // Start after the reply has been queued so the client learns the jobId first
+    QMetaObject::invokeMethod(job, [job, reference, distorted, windows, params]() {
+        if (!windows.isEmpty())
+            job->startWindows(reference, distorted.first(), windows);
+        else
+            job->startMulti(reference, distorted,
+                            params.value("startTime").toString(), params.value("duration").toString());
+    }, Qt::QueuedConnection);
+
+    return {{"jobId", jobId}};
+}
+
+QJsonObject JobServer::startCrfSearch(QIODevice *client, const QJsonObject& params, QString *error) {
+    const QString input   = params.value("input").toString();
+    const QString encoder = params.value("encoder").toString();
+    const QString preset  = params.value("preset").toString();
+    if (input.isEmpty() || encoder.isEmpty() || preset.isEmpty()) {
+        *error = "crfSearch requires \"input\", \"encoder\" and \"preset\"";
+        return {};
+    }
+
+    const int jobId = m_nextJobId++;
+    AbAv1Job *job = new AbAv1Job(this);
+    job->setPriority(params.value("priority").toInt(JobScheduler::Normal));
+    job->setThreads(params.value("threads").toInt(0));
+
+    JobRecord record;
+    record.id          = jobId;
+    record.type        = "crfSearch";
+    record.description = QString("%1 (%2, preset %3)").arg(QFileInfo(input).fileName(), encoder, preset);
+    record.job         = job;
+    record.client      = client;
+    m_jobs.insert(jobId, record);
+
+    connect(job, &AbAv1Job::logLine, this, [this, jobId](const QString& line) {
+        notify(jobId, "job.log", {{"line", line}});
+    });
+    connect(job, &AbAv1Job::progressUpdated, this, [this, jobId](int current, int total) {
+        notify(jobId, "job.progress", {{"current", current}, {"total", total}});
+    });
+    connect(job, &AbAv1Job::resultReady, this,
+            [this, jobId](const QString& crf, double vmaf, const QString& size, const QString& time) {
+        const QJsonObject prediction{{"crf", crf}, {"vmaf", vmaf}, {"size", size}, {"time", time}};
+        m_jobs[jobId].results["prediction"] = prediction;
+        notify(jobId, "job.prediction", prediction);
+    });
+    connect(job, &AbAv1Job::finished, this, [this, jobId](bool success, int exitCode) {
+        markFinished(jobId, success, exitCode);
+    });
+
+    emit logLine(QString("[job %1] crf-search %2").arg(jobId).arg(record.description));
+    const double minVmaf = params.value("minVmaf").toDouble(95.0);
+    const int samples    = params.value("samples").toInt(4);
+    QMetaObject::invokeMethod(job, [job, input, encoder, preset, minVmaf, samples]() {
+        job->start(input, encoder, preset, minVmaf, samples);
+    }, Qt::QueuedConnection);
+
+    return {{"jobId", jobId}};
+}
+
+void JobServer::markFinished(int jobId, bool success, int exitCode, const QJsonObject& extra) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) return;
+    it->finished = true;
+    it->success  = success;
+    QJsonObject params = extra;
+    params["success"]  = success;
+    params["exitCode"] = exitCode;
+    notify(jobId, "job.finished", params);
+    emit logLine(QString("[job %1] %2 (exit code %3)")
+                 .arg(jobId).arg(success ? "finished" : "failed").arg(exitCode));
+    if (it->job) it->job->deleteLater();
+    pruneFinished();
+}
+
+// Finished jobs stay for listJobs and late subscribers, but only the newest
+// MaxFinishedJobs of them, so a long-running worker doesn't grow without bound
+void JobServer::pruneFinished() {
+    int finished = 0;
+    for (const JobRecord& record : std::as_const(m_jobs)) finished += record.finished ? 1 : 0;
+    for (auto it = m_jobs.begin(); it != m_jobs.end() && finished > MaxFinishedJobs;) {
+        if (!it->finished) { ++it; continue; }
+        it = m_jobs.erase(it);   // ids ascend, so the oldest go first
+        --finished;
+    }
+}
+
+QJsonObject JobServer::jobSummary(const JobRecord& record) const {
+    return {{"jobId", record.id}, {"type", record.type}, {"description", record.description},
+            {"finished", record.finished}, {"success", record.success}, {"results", record.results}};
+}
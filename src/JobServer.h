@@ -0,0 +1,69 @@
+#ifndef JOBSERVER_H
+#define JOBSERVER_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QMap>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+class QTcpServer;
+class QLocalServer;
+
+// Headless JSON-RPC endpoint (see JobProtocol.h) that runs comparison and CRF-search
+// jobs on this machine's FfmpegJob/AbAv1Job engines and streams their signals back
+// as notifications to the client that submitted (or last subscribed to) each job.
+// Jobs go through the JobScheduler like local ones, so the box's thread budget holds.
+class JobServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit JobServer(QObject *parent = nullptr);
+    ~JobServer();
+
+    // May be called several times to listen on TCP and a local socket at once.
+    bool listen(const QString& address, QString *errorMessage = nullptr);
+    QStringList listeningAddresses() const { return m_addresses; }
+
+signals:
+    void logLine(const QString& line);
+
+private:
+    struct JobRecord {
+        int id = 0;
+        QString type;        // "compare" or "crfSearch"
+        QString description;
+        QPointer<QObject> job;
+        QIODevice *client = nullptr;
+        bool finished = false;
+        bool success  = false;
+        QJsonObject results; // last result payloads, for listJobs / late subscribers
+    };
+
+    void addConnection(QIODevice *socket);
+    void removeConnection(QIODevice *socket);
+    void handleLine(QIODevice *socket, const QByteArray& line);
+    void send(QIODevice *socket, const QJsonObject& message);
+    void notify(int jobId, const QString& method, QJsonObject params);
+
+    QJsonObject startCompare(QIODevice *client, const QJsonObject& params, QString *error);
+    QJsonObject startCrfSearch(QIODevice *client, const QJsonObject& params, QString *error);
+    QJsonObject jobSummary(const JobRecord& record) const;
+    // `extra` is merged into the job.finished notification
+    void markFinished(int jobId, bool success, int exitCode, const QJsonObject& extra = QJsonObject());
+    void pruneFinished();
+
+    static constexpr int MaxFinishedJobs = 100;
+
+    QList<QTcpServer*> m_tcpServers;
+    QList<QLocalServer*> m_localServers;
+    QStringList m_addresses;
+    QMap<QIODevice*, QByteArray> m_buffers;
+    QMap<int, JobRecord> m_jobs;
+    int m_nextJobId = 1;
+};
+
+#endif // JOBSERVER_H
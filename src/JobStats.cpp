@@ -0,0 +1,93 @@
+#include "JobStats.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+
+double JobStats::cpuSeconds() const {
+    if (userSeconds >= 0 && systemSeconds >= 0) return userSeconds + systemSeconds;
+    return sampledCpuSeconds;
+}
+
+qint64 JobStats::peakRssKiB() const {
+    return maxRssKiB >= 0 ? maxRssKiB : sampledPeakRssKiB;
+}
+
+double JobStats::unattributedCpuSeconds() const {
+    const double total = cpuSeconds();
+    if (total < 0 || stages.isEmpty()) return -1;
+    double staged = 0;
+    for (const StageTiming& s : stages) staged += s.userSeconds + s.systemSeconds;
+    return qMax(0.0, total - staged);
+}
+
+double JobStats::framesPerSecond() const {
+    return processingSeconds > 0 ? frames / processingSeconds : 0.0;
+}
+
+void JobStats::addStage(const QString& name, double user, double system, double real) {
+    for (StageTiming& s : stages) {
+        if (s.name == name) {
+            ++s.calls;
+            s.userSeconds   += user;
+            s.systemSeconds += system;
+            s.realSeconds   += real;
+            return;
+        }
+    }
+    StageTiming s;
+    s.name = name;
+    s.calls = 1;
+    s.userSeconds   = user;
+    s.systemSeconds = system;
+    s.realSeconds   = real;
+    stages << s;
+}
+
+void JobStats::addEvent(const QString& name, const QString& lane, qint64 startUs, qint64 durationUs) {
+    if (events.size() >= MaxTraceEvents) {
+        eventsTruncated = true;
+        return;
+    }
+    events << TraceEvent{name, lane, startUs, qMax<qint64>(0, durationUs)};
+}
+
+bool JobStats::writeChromeTrace(const QString& path, QString *errorMessage) const {
+    QJsonArray trace;
+    QMap<QString, int> lanes;   // lane name -> tid, in order of first use
+
+    for (const TraceEvent& e : events) {
+        if (!lanes.contains(e.lane)) lanes.insert(e.lane, lanes.size() + 1);
+        trace.append(QJsonObject{{"name", e.name}, {"cat", e.lane}, {"ph", "X"},
+                                 {"ts", e.startUs}, {"dur", e.durationUs},
+                                 {"pid", 1}, {"tid", lanes.value(e.lane)}});
+    }
+    for (auto it = lanes.cbegin(); it != lanes.cend(); ++it) {
+        trace.append(QJsonObject{{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", it.value()},
+                                 {"args", QJsonObject{{"name", it.key()}}}});
+    }
+    for (const ResourceSample& s : samples) {
+        trace.append(QJsonObject{{"name", "CPU %"}, {"ph", "C"}, {"ts", s.timeUs}, {"pid", 1},
+                                 {"args", QJsonObject{{"cpu", s.cpuPercent}}}});
+        trace.append(QJsonObject{{"name", "RSS (MiB)"}, {"ph", "C"}, {"ts", s.timeUs}, {"pid", 1},
+                                 {"args", QJsonObject{{"rss", s.rssKiB / 1024.0}}}});
+    }
+    trace.append(QJsonObject{{"name", "process_name"}, {"ph", "M"}, {"pid", 1},
+                             {"args", QJsonObject{{"name", "ffmpeg comparison"}}}});
+
+    const QJsonObject summary{
+        {"threads", threads}, {"frames", frames}, {"wallSeconds", wallSeconds},
+        {"cpuSeconds", cpuSeconds()}, {"peakRssKiB", peakRssKiB()},
+        {"eventsTruncated", eventsTruncated}
+    };
+    const QJsonObject root{{"traceEvents", trace}, {"displayTimeUnit", "ms"}, {"otherData", summary}};
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorMessage) *errorMessage = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef JOBSTATS_H
+#define JOBSTATS_H
+
+#include <QString>
+#include <QVector>
+
+// Time spent in one kind of ffmpeg work, summed over every -benchmark_all record
+// with that label, e.g. "decode_video 1.0" (input 1, stream 0).
+struct StageTiming {
+    QString name;
+    int calls = 0;
+    double userSeconds   = 0;
+    double systemSeconds = 0;
+    double realSeconds   = 0;
+};
+
+// One slice of the job timeline, in microseconds from submission
+struct TraceEvent {
+    QString name;
+    QString lane;
+    qint64 startUs    = 0;
+    qint64 durationUs = 0;
+};
+
+struct ResourceSample {
+    qint64 timeUs = 0;      // from submission
+    double cpuPercent = 0;  // since the previous sample; 100 per busy core
+    qint64 rssKiB = 0;
+};
+
+// Where a job's time and memory went. Phases come from the job's own clock; CPU
+// and memory from ffmpeg's -benchmark summary and /proc sampling; per-stage times
+// from -benchmark_all when it was requested. -1 marks anything that wasn't measured.
+struct JobStats {
+    static constexpr int MaxTraceEvents = 20000;
+
+    int threads = 0;
+    qint64 frames = 0;
+
+    // Phases, in seconds
+    double queuedSeconds     = 0;  // waiting for the scheduler
+    double startupSeconds    = 0;  // process start to first progress report (probing, init)
+    double processingSeconds = 0;  // first to last progress report
+    double finalizeSeconds   = 0;  // last report to exit (flush, libvmaf pooling, logs)
+    double postSeconds       = 0;  // reading per-frame logs after exit
+    double wallSeconds       = 0;  // process start to exit
+
+    // ffmpeg -benchmark summary
+    double userSeconds   = -1;
+    double systemSeconds = -1;
+    qint64 maxRssKiB     = -1;
+    // Sampled from the running process
+    double sampledCpuSeconds = -1;
+    qint64 sampledPeakRssKiB = -1;
+
+    QVector<StageTiming> stages;
+    QVector<TraceEvent> events;
+    bool eventsTruncated = false;
+    QVector<ResourceSample> samples;
+
+    double cpuSeconds() const;        // best available total, or -1
+    qint64 peakRssKiB() const;        // best available peak, or -1
+    // CPU not covered by the -benchmark_all stages: mostly the filter graph
+    // (scaling, ssim, psnr, libvmaf). Approximate with frame threading; -1 if unknown.
+    double unattributedCpuSeconds() const;
+    double framesPerSecond() const;
+
+    void addStage(const QString& name, double user, double system, double real);
+    void addEvent(const QString& name, const QString& lane, qint64 startUs, qint64 durationUs);
+
+    // Chrome trace-event JSON (chrome://tracing, Perfetto)
+    bool writeChromeTrace(const QString& path, QString *errorMessage = nullptr) const;
+};
+
+#endif // JOBSTATS_H
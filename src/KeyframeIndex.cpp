@@ -0,0 +1,134 @@
+#include "KeyframeIndex.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+
+// Bumped when the scan or the file layout changes; older caches are rebuilt
+static constexpr int CacheVersion = 1;
+
+double KeyframeIndex::keyframeAtOrBefore(double time) const {
+    auto it = std::upper_bound(keyframes.cbegin(), keyframes.cend(), time);
+    return it == keyframes.cbegin() ? -1.0 : *(it - 1);
+}
+
+QVector<double> KeyframeIndex::keyframesIn(double start, double end) const {
+    auto first = std::lower_bound(keyframes.cbegin(), keyframes.cend(), start);
+    auto last  = std::lower_bound(first, keyframes.cend(), end);
+    return QVector<double>(first, last);
+}
+
+double KeyframeIndex::commonKeyframeBefore(const QList<KeyframeIndex>& indexes, double time,
+                                           double maxBack, double tolerance) {
+    if (indexes.isEmpty()) return -1.0;
+    // Walk the first index's keyframes backwards and check each against the others
+    const QVector<double>& candidates = indexes.first().keyframes;
+    auto it = std::upper_bound(candidates.cbegin(), candidates.cend(), time + tolerance);
+    while (it != candidates.cbegin()) {
+        const double t = *--it;
+        if (time - t > maxBack) break;
+        bool shared = true;
+        for (int i = 1; i < indexes.size() && shared; ++i) {
+            const double other = indexes[i].keyframeAtOrBefore(t + tolerance);
+            shared = other >= 0 && std::abs(other - t) <= tolerance;
+        }
+        if (shared) return qMin(t, time);
+    }
+    return -1.0;
+}
+
+QStringList KeyframeIndex::probeArguments(const QString& file) {
+    // -show_entries on packets only demuxes; "compact" prefixes each line with its section
+    return {"-v", "error", "-select_streams", "v:0",
+            "-show_entries", "format=start_time:packet=pts_time,duration_time,flags",
+            "-of", "compact", file};
+}
+
+// Lines look like "packet|pts_time=12.512000|duration_time=0.041708|flags=K__"
+// and "format|start_time=0.000000"
+KeyframeIndex KeyframeIndex::fromProbeOutput(const QString& file, const QByteArray& output) {
+    KeyframeIndex index;
+    index.file = file;
+    double startTime = 0;
+    QVector<double> keyframes;
+    double end = 0;
+
+    for (const QByteArray& line : output.split('\n')) {
+        const QList<QByteArray> fields = line.trimmed().split('|');
+        if (fields.isEmpty()) continue;
+        if (fields.first() == "format") {
+            for (const QByteArray& field : fields)
+                if (field.startsWith("start_time=")) startTime = field.mid(11).toDouble();
+            continue;
+        }
+        if (fields.first() != "packet") continue;
+        bool hasPts = false, key = false;
+        double pts = 0, duration = 0;
+        for (const QByteArray& field : fields) {
+            if (field.startsWith("pts_time="))           pts = field.mid(9).toDouble(&hasPts);
+            else if (field.startsWith("duration_time=")) duration = field.mid(14).toDouble();
+            else if (field.startsWith("flags="))         key = field.mid(6).startsWith('K');
+        }
+        ++index.packetCount;
+        if (!hasPts) continue;
+        if (key) keyframes << pts;
+        end = qMax(end, pts + duration);
+    }
+
+    // Packets come in decode order; keyframes are stored by presentation time
+    std::sort(keyframes.begin(), keyframes.end());
+    for (double& t : keyframes) t -= startTime;
+    index.keyframes = keyframes;
+    index.duration  = end - startTime;
+    return index;
+}
+
+QString KeyframeIndex::cacheDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/keyframe-index";
+}
+
+QString KeyframeIndex::identityKey(const QString& file) {
+    const QFileInfo info(file);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return QString::fromLatin1(hash.result().toHex().left(20));
+}
+
+bool KeyframeIndex::load(const QString& file, KeyframeIndex& index) {
+    if (!QFileInfo(file).isFile()) return false;
+    QFile cache(QDir(cacheDirectory()).filePath(identityKey(file) + ".json"));
+    if (!cache.open(QIODevice::ReadOnly)) return false;
+
+    const QJsonObject root = QJsonDocument::fromJson(cache.readAll()).object();
+    if (root.value("version").toInt() != CacheVersion) return false;
+    index = KeyframeIndex();
+    index.file        = file;
+    index.duration    = root.value("duration").toDouble();
+    index.packetCount = root.value("packets").toInt();
+    for (const QJsonValue& v : root.value("keyframes").toArray()) index.keyframes << v.toDouble();
+    return index.isValid();
+}
+
+bool KeyframeIndex::save() const {
+    if (!isValid() || !QFileInfo(file).isFile()) return false;
+    QJsonArray times;
+    for (double t : keyframes) times.append(t);
+    const QJsonObject root{
+        {"version", CacheVersion}, {"file", QFileInfo(file).canonicalFilePath()},
+        {"duration", duration},    {"packets", packetCount}, {"keyframes", times}
+    };
+
+    QDir().mkpath(cacheDirectory());
+    QFile cache(QDir(cacheDirectory()).filePath(identityKey(file) + ".json"));
+    if (!cache.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    return cache.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) > 0;
+}
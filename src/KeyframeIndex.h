@@ -0,0 +1,46 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Keyframe positions of a file's first video stream, from a packet-only ffprobe scan
+// (no decoding). Indexes are cached on disk by file identity (path, size, mtime), so
+// each file is scanned once; later runs place seeks and segment boundaries on
+// keyframes without probing again. Times are in seconds relative to the file's start
+// time, i.e. in the units ffmpeg's -ss uses.
+class KeyframeIndex {
+public:
+    QString file;
+    QVector<double> keyframes;   // ascending
+    double duration = 0;         // end of the last packet
+    int packetCount = 0;
+
+    bool isValid() const { return !keyframes.isEmpty(); }
+
+    // Latest keyframe at or before `time`; -1 if there is none
+    double keyframeAtOrBefore(double time) const;
+    // Keyframes inside [start, end)
+    QVector<double> keyframesIn(double start, double end) const;
+    // Latest time at or before `time`, no further back than `maxBack` seconds, that is a
+    // keyframe in every index (within `tolerance`); -1 if they share none in that span
+    static double commonKeyframeBefore(const QList<KeyframeIndex>& indexes, double time,
+                                       double maxBack, double tolerance = 0.005);
+
+    // ffprobe arguments for the scan; feed its stdout to fromProbeOutput()
+    static QStringList probeArguments(const QString& file);
+    static KeyframeIndex fromProbeOutput(const QString& file, const QByteArray& output);
+
+    // Cached index of `file`; false if there is none or the file has changed since
+    static bool load(const QString& file, KeyframeIndex& index);
+    bool save() const;
+    static QString cacheDirectory();
+
+private:
+    static QString identityKey(const QString& file);
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -0,0 +1,372 @@
+#include "LadderJob.h"
+#include "ChunkedEncodeJob.h"
+#include "EncodeModel.h"
+#include "FfmpegJob.h"
+#include "JobScheduler.h"
+#include "VideoUtils.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+
+QString LadderPoint::label() const {
+    return QString("%1p CRF %2").arg(height).arg(crf);
+}
+
+LadderJob::LadderJob(QObject *parent) : QObject(parent) {}
+
+LadderJob::~LadderJob() {
+    stopAll();
+}
+
+int LadderJob::threadsPerJob() const {
+    return qMax(1, JobScheduler::instance()->threadBudget() / qMax(1, m_settings.parallel));
+}
+
+QString LadderJob::encodedName(int point, int sample) const {
+    return QString("p%1_s%2.mkv").arg(point, 3, 10, QChar('0')).arg(sample);
+}
+
+void LadderJob::start(const Settings& settings) {
+    if (m_running) return;
+    m_settings = settings;
+    m_settings.input = QFileInfo(settings.input).absoluteFilePath();
+    m_samples.clear();
+    m_points.clear();
+    m_measurements.clear();
+    m_pointsDone = 0;
+    m_jobsDone = 0;
+
+    const QString resolution = VideoUtils::getVideoResolution(m_settings.input);
+    m_sourceSize = QSize(resolution.section('x', 0, 0).toInt(), resolution.section('x', 1, 1).toInt());
+    m_source = VideoUtils::getVideoFormat(m_settings.input);
+    const double duration = m_source.durationSeconds;
+    m_workDir = std::make_unique<QTemporaryDir>(QDir::temp().filePath("vidmetric-ladder-XXXXXX"));
+    if (m_sourceSize.isEmpty() || duration <= 0 || !m_workDir->isValid()) {
+        emit logLine("Error: cannot read the source's resolution and duration, or create a work directory.");
+        emit finished(false);
+        return;
+    }
+    m_steps.setWorkingDirectory(m_workDir->path());
+
+    // Rungs never go above the source; each keeps its aspect ratio at an even width
+    QList<int> heights;
+    for (int h : settings.heights)
+        if (h > 0 && h <= m_sourceSize.height() && !heights.contains(h)) heights << h;
+    std::sort(heights.begin(), heights.end(), std::greater<int>());
+    for (int h : std::as_const(heights)) {
+        const int w = qRound(m_sourceSize.width() * double(h) / m_sourceSize.height() / 2.0) * 2;
+        for (double crf : settings.crfs) {
+            LadderPoint point;
+            point.height = h;
+            point.size = QSize(w, h);
+            point.crf = crf;
+            m_points << point;
+        }
+    }
+    if (m_points.isEmpty()) {
+        emit logLine("Error: no resolution at or below the source's and no CRF to try.");
+        emit finished(false);
+        return;
+    }
+
+    // Samples spread evenly over the title, away from its very start and end;
+    // a short title is used whole
+    const int sampleCount = duration < 2 * settings.samples * settings.sampleSeconds ? 1 : qMax(1, settings.samples);
+    for (int k = 0; k < sampleCount; ++k) m_samples << Sample{QString("sample%1.mkv").arg(k), 0};
+    m_measurements = QVector<QVector<Measurement>>(m_points.size(), QVector<Measurement>(sampleCount));
+    m_pointFinished = QVector<bool>(m_points.size(), false);
+    planEncodeOrder();
+
+    m_jobsTotal = sampleCount * (1 + int(m_points.size()) + int(heights.size()));
+    m_running = true;
+    emit logLine(QString("Ladder search on %1 (%2x%3): %4 resolutions × %5 CRFs × %6 samples = %7 probe encodes.")
+                     .arg(QFileInfo(m_settings.input).fileName()).arg(m_sourceSize.width()).arg(m_sourceSize.height())
+                     .arg(heights.size()).arg(settings.crfs.size()).arg(sampleCount).arg(m_points.size() * sampleCount));
+    emit progressUpdated(0, m_jobsTotal);
+
+    for (int k = 0; k < sampleCount; ++k) {
+        const double start = sampleCount == 1 ? 0 : (duration - settings.sampleSeconds) * (k + 1) / (sampleCount + 1);
+        const double length = sampleCount == 1 ? duration : settings.sampleSeconds;
+        const QString input = m_settings.input, file = m_samples[k].file;
+        // Stream copy: the sample begins at the keyframe before `start`, which both the
+        // encodes and their scoring then share
+        m_steps.run(QString("Ladder: sample %1").arg(k + 1), [input, file, start, length](int) {
+            return QStringList{"-hide_banner", "-y", "-ss", QString::number(start, 'f', 3),
+                               "-t", QString::number(length, 'f', 3), "-i", input,
+                               "-map", "0:v:0", "-c", "copy", "-an", "-sn",
+                               "-avoid_negative_ts", "make_zero", file};
+        }, 1, nullptr, [this, k, length](bool ok, const QString& errors) {
+            jobsDone();
+            if (ok) {
+                const double probed = VideoUtils::getVideoFormat(QDir(m_workDir->path()).filePath(m_samples[k].file)).durationSeconds;
+                m_samples[k].duration = probed > 0 ? probed : length;
+                for (int p : std::as_const(m_encodeOrder)) encode(p, k);
+                return;
+            }
+            emit logLine(QString("Sample %1 could not be cut: %2").arg(k + 1).arg(errors.trimmed().section('\n', -1)));
+            for (int p = 0; p < m_points.size(); ++p) m_measurements[p][k].failed = true;
+            QList<int> heights;
+            for (const LadderPoint& point : std::as_const(m_points))
+                if (!heights.contains(point.height)) heights << point.height;
+            jobsDone(int(m_points.size() + heights.size()));
+            for (int p = 0; p < m_points.size(); ++p) finishPointIfReady(p);
+        });
+    }
+}
+
+void LadderJob::cancel() {
+    if (!m_running) return;
+    emit logLine("Cancelled.");
+    stopAll();
+    m_running = false;
+    emit finished(false);
+}
+
+// The scheduler starts jobs of equal priority in submission order, so submitting the
+// slowest encodes first keeps a long one from starting last and finishing alone.
+// Costs come from the EncodeModel when it knows this encoder and preset, otherwise
+// from the pixel count.
+void LadderJob::planEncodeOrder() {
+    const double complexity = EncodeModel::complexityOf(m_source);
+    QVector<double> cost(m_points.size());
+    bool modelled = true;
+    for (int p = 0; p < m_points.size() && modelled; ++p) {
+        const EncodeEstimate e = EncodeModel::estimate(m_settings.encoder, m_settings.preset, m_points[p].size.width(),
+                                                       m_points[p].size.height(), m_points[p].crf, threadsPerJob(), complexity);
+        modelled = e.valid();
+        cost[p] = modelled ? 1.0 / e.fps : 0;
+    }
+    if (!modelled)
+        for (int p = 0; p < m_points.size(); ++p) cost[p] = double(m_points[p].size.width()) * m_points[p].size.height();
+
+    m_encodeOrder.clear();
+    for (int p = 0; p < m_points.size(); ++p) m_encodeOrder << p;
+    std::stable_sort(m_encodeOrder.begin(), m_encodeOrder.end(), [&cost](int a, int b) { return cost[a] > cost[b]; });
+}
+
+void LadderJob::encode(int point, int sample) {
+    const LadderPoint& p = m_points[point];
+    const Settings settings = m_settings;
+    const QString source = m_samples[sample].file, output = encodedName(point, sample);
+    const QSize size = p.size == m_sourceSize ? QSize() : p.size;
+    const double crf = p.crf;
+    // Wall time and threads of the encode itself, for the EncodeModel
+    auto clock = std::make_shared<QElapsedTimer>();
+    auto threadsUsed = std::make_shared<int>(0);
+
+    m_steps.run(QString("Ladder: %1, sample %2").arg(p.label()).arg(sample + 1),
+                [settings, source, output, size, crf, clock, threadsUsed](int granted) {
+        clock->start();
+        *threadsUsed = granted;
+        QStringList args{"-hide_banner", "-y", "-i", source, "-map", "0:v:0"};
+        if (!size.isEmpty()) args << "-vf" << QString("scale=%1:%2:flags=lanczos").arg(size.width()).arg(size.height());
+        args << "-c:v" << settings.encoder
+             << ChunkedEncodeJob::qualityArguments(settings.encoder, settings.preset, crf)
+             << ChunkedEncodeJob::threadArguments(settings.encoder, granted)
+             << "-an" << "-sn" << output;
+        return args;
+    }, threadsPerJob(), nullptr, [this, point, sample, output, clock, threadsUsed](bool ok, const QString& errors) {
+        jobsDone();
+        Measurement& m = m_measurements[point][sample];
+        if (ok) {
+            m.encoded = true;
+            m.bytes = QFileInfo(QDir(m_workDir->path()).filePath(output)).size();
+
+            const LadderPoint& p = m_points[point];
+            const double frames = m_samples[sample].duration * m_source.frameRate;
+            const double seconds = clock->elapsed() / 1000.0;
+            if (frames > 0 && seconds > 0) {
+                EncodeSample measured;
+                measured.encoder      = m_settings.encoder;
+                measured.preset       = m_settings.preset;
+                measured.width        = p.size.width();
+                measured.height       = p.size.height();
+                measured.crf          = p.crf;
+                measured.threads      = *threadsUsed;
+                measured.complexity   = EncodeModel::complexityOf(m_source);
+                measured.fps          = frames / seconds;
+                measured.bitsPerPixel = m.bytes * 8.0 / (frames * p.size.width() * p.size.height());
+                EncodeModel::record(measured);
+            }
+        } else {
+            m.failed = true;
+            emit logLine(QString("%1, sample %2: encode failed: %3")
+                             .arg(m_points[point].label()).arg(sample + 1).arg(errors.trimmed().section('\n', -1)));
+        }
+        scoreIfReady(m_points[point].height, sample);
+    });
+}
+
+// All CRFs of one resolution and sample are scored in one run, which decodes the
+// sample once and splits it to every encode
+void LadderJob::scoreIfReady(int height, int sample) {
+    QList<int> points;
+    for (int p = 0; p < m_points.size(); ++p) {
+        if (m_points[p].height != height) continue;
+        const Measurement& m = m_measurements[p][sample];
+        if (!m.encoded && !m.failed) return;
+        if (!m.failed) points << p;
+    }
+    if (points.isEmpty()) {
+        jobsDone();
+        for (int p = 0; p < m_points.size(); ++p)
+            if (m_points[p].height == height) finishPointIfReady(p);
+        return;
+    }
+
+    const QDir dir(m_workDir->path());
+    QStringList files;
+    for (int p : std::as_const(points)) files << dir.filePath(encodedName(p, sample));
+
+    FfmpegJob *scorer = new FfmpegJob(this);
+    m_scorers << scorer;
+    scorer->setThreads(threadsPerJob());
+    // Scoring frees disk and completes points, so it goes ahead of queued encodes
+    scorer->setPriority(JobScheduler::High);
+    if (height != m_sourceSize.height()) scorer->setScaleDistortedTo(m_sourceSize);
+
+    connect(scorer, &FfmpegJob::comparisonResult, this, [this, points, sample](int index, const ComparisonResult& result) {
+        if (index < 0 || index >= points.size()) return;
+        Measurement& m = m_measurements[points[index]][sample];
+        m.scored = result.hasVmaf;
+        m.vmaf = result.vmaf;
+    });
+    connect(scorer, &FfmpegJob::finished, this, [this, scorer, points, sample, height](bool success, int) {
+        m_scorers.removeOne(scorer);
+        scorer->deleteLater();
+        jobsDone();
+        if (!success) emit logLine(QString("%1p, sample %2: scoring failed.").arg(height).arg(sample + 1));
+        for (int p : points) {
+            Measurement& m = m_measurements[p][sample];
+            if (!m.scored) m.failed = true;
+            // The encode has served its purpose
+            QFile::remove(QDir(m_workDir->path()).filePath(encodedName(p, sample)));
+        }
+        for (int p = 0; p < m_points.size(); ++p)
+            if (m_points[p].height == height) finishPointIfReady(p);
+    });
+    scorer->startMulti(dir.filePath(m_samples[sample].file), files);
+}
+
+void LadderJob::finishPointIfReady(int point) {
+    if (m_pointFinished[point]) return;
+    double bytes = 0, seconds = 0, vmaf = 0;
+    bool failed = false;
+    for (int k = 0; k < m_samples.size(); ++k) {
+        const Measurement& m = m_measurements[point][k];
+        if (!m.scored && !m.failed) return;
+        if (m.failed) { failed = true; continue; }
+        bytes   += m.bytes;
+        seconds += m_samples[k].duration;
+        vmaf    += m.vmaf * m_samples[k].duration;
+    }
+    m_pointFinished[point] = true;
+
+    LadderPoint& p = m_points[point];
+    p.valid = !failed && seconds > 0;
+    if (p.valid) {
+        p.bitrateKbps = bytes * 8 / seconds / 1000;
+        p.vmaf = vmaf / seconds;
+    }
+    ++m_pointsDone;
+    emit pointReady(point);
+    if (m_pointsDone == m_points.size()) complete();
+}
+
+void LadderJob::complete() {
+    markHull(m_points);
+    chooseRungs(m_points, m_settings.rungs);
+
+    QStringList ladder;
+    for (const LadderPoint& p : std::as_const(m_points))
+        if (p.chosen) ladder << QString("  %1x%2 CRF %3: %4 kbps, VMAF %5")
+                                    .arg(p.size.width()).arg(p.size.height()).arg(p.crf)
+                                    .arg(p.bitrateKbps, 0, 'f', 0).arg(p.vmaf, 0, 'f', 2);
+    const bool success = !ladder.isEmpty();
+    if (success) emit logLine("Ladder:\n" + ladder.join('\n'));
+    else         emit logLine("Error: no probe encode could be measured.");
+    m_running = false;
+    m_workDir.reset();
+    emit finished(success);
+}
+
+void LadderJob::jobsDone(int count) {
+    m_jobsDone += count;
+    emit progressUpdated(m_jobsDone, m_jobsTotal);
+}
+
+void LadderJob::stopAll() {
+    m_steps.stopAll();
+    // Their destructors withdraw or kill whatever is still queued or running
+    const QList<FfmpegJob*> scorers = m_scorers;
+    m_scorers.clear();
+    for (FfmpegJob *scorer : scorers) {
+        scorer->disconnect(this);
+        delete scorer;
+    }
+}
+
+// --- Hull and rungs ---
+
+void LadderJob::markHull(QVector<LadderPoint>& points) {
+    QList<int> order;
+    for (int i = 0; i < points.size(); ++i) {
+        points[i].onHull = false;
+        if (points[i].valid && points[i].bitrateKbps > 0) order << i;
+    }
+    std::sort(order.begin(), order.end(), [&points](int a, int b) {
+        if (points[a].bitrateKbps != points[b].bitrateKbps) return points[a].bitrateKbps < points[b].bitrateKbps;
+        return points[a].vmaf > points[b].vmaf;
+    });
+
+    // Pareto front: each point must beat every cheaper one
+    QList<int> pareto;
+    for (int i : std::as_const(order))
+        if (pareto.isEmpty() || points[i].vmaf > points[pareto.last()].vmaf) pareto << i;
+
+    // Upper convex hull (monotone chain): drop points on or below the chord of their neighbours
+    auto x = [&points](int i) { return std::log2(points[i].bitrateKbps); };
+    auto y = [&points](int i) { return points[i].vmaf; };
+    QList<int> hull;
+    for (int c : std::as_const(pareto)) {
+        while (hull.size() >= 2) {
+            const int a = hull[hull.size() - 2], b = hull.last();
+            const double cross = (x(b) - x(a)) * (y(c) - y(a)) - (y(b) - y(a)) * (x(c) - x(a));
+            if (cross < 0) break;
+            hull.removeLast();
+        }
+        hull << c;
+    }
+    for (int i : std::as_const(hull)) points[i].onHull = true;
+}
+
+void LadderJob::chooseRungs(QVector<LadderPoint>& points, int rungs) {
+    QList<int> hull;
+    for (int i = 0; i < points.size(); ++i) {
+        points[i].chosen = false;
+        if (points[i].onHull) hull << i;
+    }
+    std::sort(hull.begin(), hull.end(), [&points](int a, int b) { return points[a].bitrateKbps < points[b].bitrateKbps; });
+    if (hull.isEmpty() || rungs <= 0) return;
+    if (hull.size() <= rungs) {
+        for (int i : std::as_const(hull)) points[i].chosen = true;
+        return;
+    }
+
+    // Targets at even bitrate ratios; each takes the nearest hull point still free
+    const double low = std::log2(points[hull.first()].bitrateKbps), high = std::log2(points[hull.last()].bitrateKbps);
+    for (int r = 0; r < rungs; ++r) {
+        const double target = rungs == 1 ? high : low + (high - low) * r / (rungs - 1);
+        int best = -1;
+        for (int i : std::as_const(hull)) {
+            if (points[i].chosen) continue;
+            if (best < 0 || std::abs(std::log2(points[i].bitrateKbps) - target)
+                            < std::abs(std::log2(points[best].bitrateKbps) - target))
+                best = i;
+        }
+        if (best >= 0) points[best].chosen = true;
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef LADDERJOB_H
+#define LADDERJOB_H
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QSize>
+#include <QVector>
+#include <QTemporaryDir>
+#include <memory>
+#include "ScheduledProcesses.h"
+#include "VideoUtils.h"
+
+class FfmpegJob;
+
+// One resolution × CRF combination of a ladder search, measured over all samples
+struct LadderPoint {
+    int height = 0;
+    QSize size;                // encoded frame size
+    double crf = 0;
+    double bitrateKbps = 0;
+    double vmaf = 0;           // scored after upscaling to the source resolution
+    bool valid = false;        // every sample was encoded and scored
+    bool onHull = false;       // on the upper convex hull of bitrate vs. VMAF
+    bool chosen = false;       // picked as a rung of the ladder
+
+    QString label() const;     // "720p CRF 32"
+};
+
+// Per-title bitrate ladder: probe encodes of a few samples of the source at every
+// resolution × CRF, each scored with VMAF after scaling back up to the source size.
+// The Pareto-optimal points form the rate-quality hull, from which the ladder rungs
+// are picked at roughly even bitrate ratios.
+//
+// All sample cuts, encodes and scorings are JobScheduler jobs submitted as soon as
+// their inputs exist, so they run as parallel as the thread budget allows.
+class LadderJob : public QObject {
+    Q_OBJECT
+
+public:
+    struct Settings {
+        QString input;
+        QString encoder, preset;
+        QList<int> heights;             // heights above the source's are dropped
+        QList<double> crfs;
+        int samples = 4;
+        double sampleSeconds = 10;
+        int rungs = 6;
+        int parallel = 4;               // jobs sharing the thread budget at once
+    };
+
+    explicit LadderJob(QObject *parent = nullptr);
+    ~LadderJob();
+
+    void start(const Settings& settings);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    const QVector<LadderPoint>& points() const { return m_points; }
+    QSize sourceSize() const { return m_sourceSize; }
+
+    // Marks the upper convex hull of the Pareto-optimal valid points; bitrate is taken
+    // on a log scale, where rate-quality curves are close to straight lines
+    static void markHull(QVector<LadderPoint>& points);
+    // Marks up to `rungs` hull points spread evenly over log bitrate, always
+    // including the cheapest and the best one
+    static void chooseRungs(QVector<LadderPoint>& points, int rungs);
+
+signals:
+    void logLine(const QString& line);
+    // Jobs done out of all jobs of the search (sample cuts, encodes and scorings)
+    void progressUpdated(int done, int total);
+    // A point has all of its measurements (or failed: LadderPoint::valid is false)
+    void pointReady(int index);
+    void finished(bool success);
+
+private:
+    struct Sample {
+        QString file;
+        double duration = 0;
+    };
+    // Per point and sample: encoded bytes, VMAF, and whether the encode is done
+    struct Measurement {
+        qint64 bytes = 0;
+        double vmaf = 0;
+        bool encoded = false, scored = false, failed = false;
+    };
+    void cutSample(int sample);
+    void planEncodeOrder();
+    void encode(int point, int sample);
+    void scoreIfReady(int height, int sample);
+    void finishPointIfReady(int point);
+    void complete();
+    void jobsDone(int count = 1);
+    void stopAll();
+    QString encodedName(int point, int sample) const;
+    int threadsPerJob() const;
+
+    Settings m_settings;
+    QSize m_sourceSize;
+    VideoUtils::VideoFormat m_source;
+    std::unique_ptr<QTemporaryDir> m_workDir;
+    QVector<Sample> m_samples;
+    QVector<LadderPoint> m_points;
+    QVector<QVector<Measurement>> m_measurements;   // [point][sample]
+    QVector<bool> m_pointFinished;
+    QList<int> m_encodeOrder;   // points, most expensive encode first
+    int m_pointsDone = 0;
+    int m_jobsDone = 0, m_jobsTotal = 0;
+    bool m_running = false;
+
+    ScheduledProcesses m_steps;   // sample cuts and encodes
+    QList<FfmpegJob*> m_scorers;
+};
+
+#endif // LADDERJOB_H
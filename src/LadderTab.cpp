@@ -0,0 +1,301 @@
+#include "LadderTab.h"
+#include "VideoUtils.h"
+#include <QColor>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QLabel>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QScrollBar>
+#include <QSettings>
+#include <QThread>
+#include <QTime>
+
+// Typical middle preset per encoder family; probe encodes don't need the slowest
+static QString defaultPreset(const QString& encoder) {
+    if (encoder == "libsvtav1")       return "8";
+    if (encoder.endsWith("_nvenc"))   return "p4";
+    if (encoder.endsWith("_qsv"))     return "4";
+    if (encoder.endsWith("_amf"))     return "balanced";
+    return "medium";
+}
+
+// "1080, 720 540" -> numbers in the order given
+static QList<double> parseNumbers(const QString& text) {
+    QList<double> numbers;
+    for (const QString& part : text.split(QRegularExpression("[,;\\s]+"), Qt::SkipEmptyParts)) {
+        bool ok = false;
+        const double n = part.toDouble(&ok);
+        if (ok && n > 0) numbers << n;
+    }
+    return numbers;
+}
+
+LadderTab::LadderTab(QWidget *parent) : QWidget(parent) {
+    ladderJob = new LadderJob(this);
+    setupUI();
+    loadSettings();
+
+    connect(ladderJob, &LadderJob::logLine, this, &LadderTab::log);
+    connect(ladderJob, &LadderJob::progressUpdated, this, [this](int done, int total) {
+        if (total <= 0) return;
+        progressBar->setValue(done * 100 / total);
+        progressBar->setFormat(QString("%1 of %2 jobs (%3%)").arg(done).arg(total).arg(done * 100 / total));
+    });
+    connect(ladderJob, &LadderJob::pointReady, this, &LadderTab::showPoint);
+    connect(ladderJob, &LadderJob::finished, this, [this](bool success) {
+        runBtn->setEnabled(true);
+        cancelBtn->setEnabled(false);
+        progressBar->setVisible(false);
+        if (!success) {
+            log("Ladder search did not complete.");
+            return;
+        }
+        // Hull and rung marks are only known now
+        QStringList rungs;
+        const QVector<LadderPoint>& points = ladderJob->points();
+        for (int i = 0; i < points.size(); ++i) {
+            showPoint(i);
+            if (points[i].chosen)
+                rungs << QString("%1 %2 kbps VMAF %3").arg(points[i].label())
+                             .arg(points[i].bitrateKbps, 0, 'f', 0).arg(points[i].vmaf, 0, 'f', 1);
+        }
+        saveBtn->setEnabled(true);
+        emit ladderCompleted("Ladder", m_runDetails, QString("Rungs: %1 | %2").arg(rungs.size()).arg(rungs.join(" | ")));
+    });
+}
+
+void LadderTab::setupUI() {
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QGroupBox *fileGroup = new QGroupBox("File Selection", this);
+    QHBoxLayout *fileLayout = new QHBoxLayout(fileGroup);
+    inputEdit = new QLineEdit(this);
+    inputEdit->setPlaceholderText("Select source video...");
+    QPushButton *browseBtn = new QPushButton("Browse...", this);
+    fileLayout->addWidget(new QLabel("Source:", this));
+    fileLayout->addWidget(inputEdit);
+    fileLayout->addWidget(browseBtn);
+    mainLayout->addWidget(fileGroup);
+
+    QGroupBox *settingsGroup = new QGroupBox("Ladder Settings", this);
+    QFormLayout *form = new QFormLayout(settingsGroup);
+
+    QHBoxLayout *encoderLayout = new QHBoxLayout();
+    encoderCombo = new QComboBox(this);
+    encoderCombo->addItems({"libsvtav1", "libx265", "libx264", "av1_nvenc", "hevc_nvenc", "h264_nvenc",
+                            "av1_qsv", "hevc_qsv", "h264_qsv", "av1_amf", "hevc_amf", "h264_amf"});
+    presetEdit = new QLineEdit(this);
+    presetEdit->setMaximumWidth(100);
+    encoderLayout->addWidget(encoderCombo);
+    encoderLayout->addWidget(new QLabel("Preset:", this));
+    encoderLayout->addWidget(presetEdit);
+    encoderLayout->addStretch();
+    form->addRow("Encoder:", encoderLayout);
+
+    heightsEdit = new QLineEdit(this);
+    heightsEdit->setToolTip("Frame heights to encode at; widths follow the source's aspect ratio.\n"
+                            "Heights above the source's are skipped.");
+    form->addRow("Resolutions:", heightsEdit);
+    crfsEdit = new QLineEdit(this);
+    crfsEdit->setToolTip("CRF (or CQ / global quality for hardware encoders) tried at every resolution");
+    form->addRow("CRFs:", crfsEdit);
+
+    QHBoxLayout *samplesLayout = new QHBoxLayout();
+    samplesSpin = new QSpinBox(this);
+    samplesSpin->setRange(1, 20);
+    samplesSpin->setToolTip("Sections of the title every probe encode covers");
+    sampleLengthSpin = new QSpinBox(this);
+    sampleLengthSpin->setRange(2, 120);
+    sampleLengthSpin->setSuffix(" s");
+    samplesLayout->addWidget(samplesSpin);
+    samplesLayout->addWidget(new QLabel("of", this));
+    samplesLayout->addWidget(sampleLengthSpin);
+    samplesLayout->addStretch();
+    form->addRow("Samples:", samplesLayout);
+
+    QHBoxLayout *limitsLayout = new QHBoxLayout();
+    rungsSpin = new QSpinBox(this);
+    rungsSpin->setRange(1, 20);
+    rungsSpin->setToolTip("Number of ladder rungs picked from the rate-quality hull");
+    parallelSpin = new QSpinBox(this);
+    parallelSpin->setRange(1, 64);
+    parallelSpin->setToolTip("Probe encodes and scorings running at once; they share the scheduler's thread budget");
+    limitsLayout->addWidget(new QLabel("Rungs:", this));
+    limitsLayout->addWidget(rungsSpin);
+    limitsLayout->addSpacing(20);
+    limitsLayout->addWidget(new QLabel("Parallel jobs:", this));
+    limitsLayout->addWidget(parallelSpin);
+    limitsLayout->addStretch();
+    form->addRow(limitsLayout);
+    mainLayout->addWidget(settingsGroup);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    runBtn = new QPushButton("Build Ladder", this);
+    runBtn->setMinimumHeight(40);
+    cancelBtn = new QPushButton("Cancel", this);
+    cancelBtn->setMinimumHeight(40);
+    cancelBtn->setEnabled(false);
+    saveBtn = new QPushButton("Save Ladder...", this);
+    saveBtn->setMinimumHeight(40);
+    saveBtn->setEnabled(false);
+    buttons->addWidget(runBtn, 1);
+    buttons->addWidget(cancelBtn);
+    buttons->addWidget(saveBtn);
+    mainLayout->addLayout(buttons);
+
+    progressBar = new QProgressBar(this);
+    progressBar->setVisible(false);
+    progressBar->setTextVisible(true);
+    mainLayout->addWidget(progressBar);
+
+    pointsTable = new QTableWidget(this);
+    pointsTable->setColumnCount(6);
+    pointsTable->setHorizontalHeaderLabels({"Resolution", "CRF", "Bitrate (kbps)", "VMAF", "Hull", "Rung"});
+    pointsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    pointsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    pointsTable->setSortingEnabled(false);
+    mainLayout->addWidget(pointsTable, 1);
+
+    logText = new QTextEdit(this);
+    logText->setReadOnly(true);
+    logText->setFont(QFont("Courier New", 8));
+    logText->setMaximumHeight(150);
+    mainLayout->addWidget(logText);
+
+    connect(browseBtn, &QPushButton::clicked, this, [this]() {
+        const QString file = QFileDialog::getOpenFileName(this, "Select Source", inputEdit->text(),
+                                                          "Video Files (*.mp4 *.mkv *.mov *.webm *.avi)");
+        if (!file.isEmpty()) inputEdit->setText(file);
+    });
+    connect(encoderCombo, &QComboBox::currentTextChanged, this, [this](const QString& encoder) {
+        presetEdit->setText(defaultPreset(encoder));
+    });
+    connect(runBtn, &QPushButton::clicked, this, &LadderTab::startSearch);
+    connect(cancelBtn, &QPushButton::clicked, ladderJob, &LadderJob::cancel);
+    connect(saveBtn, &QPushButton::clicked, this, &LadderTab::saveLadder);
+}
+
+void LadderTab::loadSettings() {
+    QSettings settings;
+    encoderCombo->setCurrentText(settings.value("ladder/encoder", "libsvtav1").toString());
+    presetEdit->setText(settings.value("ladder/preset", defaultPreset(encoderCombo->currentText())).toString());
+    heightsEdit->setText(settings.value("ladder/heights", "2160, 1440, 1080, 720, 540, 360").toString());
+    crfsEdit->setText(settings.value("ladder/crfs", "22, 26, 30, 34, 38, 42").toString());
+    samplesSpin->setValue(settings.value("ladder/samples", 4).toInt());
+    sampleLengthSpin->setValue(settings.value("ladder/sampleSeconds", 10).toInt());
+    rungsSpin->setValue(settings.value("ladder/rungs", 6).toInt());
+    parallelSpin->setValue(settings.value("ladder/parallel", qBound(1, QThread::idealThreadCount() / 4, 8)).toInt());
+}
+
+void LadderTab::saveSettings() const {
+    QSettings settings;
+    settings.setValue("ladder/encoder", encoderCombo->currentText());
+    settings.setValue("ladder/preset", presetEdit->text());
+    settings.setValue("ladder/heights", heightsEdit->text());
+    settings.setValue("ladder/crfs", crfsEdit->text());
+    settings.setValue("ladder/samples", samplesSpin->value());
+    settings.setValue("ladder/sampleSeconds", sampleLengthSpin->value());
+    settings.setValue("ladder/rungs", rungsSpin->value());
+    settings.setValue("ladder/parallel", parallelSpin->value());
+}
+
+void LadderTab::startSearch() {
+    LadderJob::Settings settings;
+    settings.input = inputEdit->text().trimmed();
+    if (settings.input.isEmpty() || !QFileInfo::exists(settings.input) || !VideoUtils::isValidVideoFile(settings.input)) {
+        QMessageBox::warning(this, "Error", "Please select a valid source file.");
+        return;
+    }
+    for (double h : parseNumbers(heightsEdit->text())) settings.heights << int(h);
+    settings.crfs = parseNumbers(crfsEdit->text());
+    if (settings.heights.isEmpty() || settings.crfs.isEmpty()) {
+        QMessageBox::warning(this, "Error", "Enter at least one resolution and one CRF.");
+        return;
+    }
+    settings.encoder       = encoderCombo->currentText();
+    settings.preset        = presetEdit->text().trimmed();
+    settings.samples       = samplesSpin->value();
+    settings.sampleSeconds = sampleLengthSpin->value();
+    settings.rungs         = rungsSpin->value();
+    settings.parallel      = parallelSpin->value();
+    saveSettings();
+
+    m_runDetails = QString("%1 (%2, preset %3)").arg(QFileInfo(settings.input).fileName(), settings.encoder, settings.preset);
+    pointsTable->setRowCount(0);
+    logText->clear();
+    runBtn->setEnabled(false);
+    cancelBtn->setEnabled(true);
+    saveBtn->setEnabled(false);
+    progressBar->setValue(0);
+    progressBar->setVisible(true);
+    ladderJob->start(settings);
+}
+
+void LadderTab::showPoint(int index) {
+    const LadderPoint& p = ladderJob->points().value(index);
+    if (pointsTable->rowCount() < ladderJob->points().size()) pointsTable->setRowCount(ladderJob->points().size());
+
+    const QStringList cells{
+        QString("%1x%2").arg(p.size.width()).arg(p.size.height()),
+        QString::number(p.crf),
+        p.valid ? QString::number(p.bitrateKbps, 'f', 0) : QString("--"),
+        p.valid ? QString::number(p.vmaf, 'f', 2) : QString("failed"),
+        p.onHull ? QString("✓") : QString(),
+        p.chosen ? QString("✓") : QString()
+    };
+    for (int column = 0; column < cells.size(); ++column) {
+        QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+        if (p.chosen) {
+            item->setBackground(QColor("#c8e6c9"));
+            QFont font = item->font();
+            font.setBold(true);
+            item->setFont(font);
+        }
+        pointsTable->setItem(index, column, item);
+    }
+}
+
+void LadderTab::saveLadder() {
+    const QString path = QFileDialog::getSaveFileName(this, "Save Ladder", QFileInfo(inputEdit->text()).completeBaseName() + "_ladder.json",
+                                                      "JSON (*.json)");
+    if (path.isEmpty()) return;
+
+    auto toJson = [](const LadderPoint& p) {
+        return QJsonObject{{"width", p.size.width()}, {"height", p.size.height()}, {"crf", p.crf},
+                           {"bitrateKbps", p.bitrateKbps}, {"vmaf", p.vmaf}};
+    };
+    QJsonArray rungs, hull, points;
+    for (const LadderPoint& p : ladderJob->points()) {
+        if (!p.valid) continue;
+        if (p.chosen) rungs.append(toJson(p));
+        if (p.onHull) hull.append(toJson(p));
+        points.append(toJson(p));
+    }
+    const QJsonObject root{
+        {"source", inputEdit->text()},
+        {"sourceWidth", ladderJob->sourceSize().width()}, {"sourceHeight", ladderJob->sourceSize().height()},
+        {"encoder", encoderCombo->currentText()}, {"preset", presetEdit->text()},
+        {"rungs", rungs}, {"hull", hull}, {"points", points}
+    };
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson()) < 0 || !file.commit()) {
+        QMessageBox::warning(this, "Save Ladder", "Could not write " + path);
+        return;
+    }
+    log("Saved ladder to " + path);
+}
+
+void LadderTab::log(const QString& line) {
+    logText->append(QTime::currentTime().toString("HH:mm:ss") + "  " + line);
+    logText->verticalScrollBar()->setValue(logText->verticalScrollBar()->maximum());
+}
@@ -0,0 +1,55 @@
+#ifndef LADDERTAB_H
+#define LADDERTAB_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QTableWidget>
+#include <QTextEdit>
+#include "LadderJob.h"
+
+// Per-title ABR ladder: probe encodes at several resolutions × CRFs over a few
+// samples, scored at the source resolution, reduced to the rate-quality hull and
+// the rungs picked from it.
+class LadderTab : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit LadderTab(QWidget *parent = nullptr);
+
+signals:
+    void ladderCompleted(const QString& type, const QString& details, const QString& result);
+
+private:
+    void setupUI();
+    void loadSettings();
+    void saveSettings() const;
+    void startSearch();
+    void showPoint(int index);
+    void saveLadder();
+    void log(const QString& line);
+
+    QLineEdit *inputEdit;
+    QComboBox *encoderCombo;
+    QLineEdit *presetEdit;
+    QLineEdit *heightsEdit;
+    QLineEdit *crfsEdit;
+    QSpinBox *samplesSpin;
+    QSpinBox *sampleLengthSpin;
+    QSpinBox *rungsSpin;
+    QSpinBox *parallelSpin;
+    QPushButton *runBtn;
+    QPushButton *cancelBtn;
+    QPushButton *saveBtn;
+    QProgressBar *progressBar;
+    QTableWidget *pointsTable;
+    QTextEdit *logText;
+
+    LadderJob *ladderJob;
+    QString m_runDetails;
+};
+
+#endif // LADDERTAB_H
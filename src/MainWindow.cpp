@@ -1,5 +1,21 @@
 #include "MainWindow.h"
+#include "JobScheduler.h"
+#include "ReferenceCache.h"
+#include "VideoUtils.h"
 #include <QTabWidget>
+#include <QMenuBar>
+#include <QStatusBar>
+#include <QLabel>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QThread>
+#include <QInputDialog>
+#include <QMessageBox>
+#include <QPushButton>
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
     setupUI();
@@ -13,14 +29,211 @@ void MainWindow::setupUI() {
 
     predictTab = new PredictTab(this);
     verifyTab = new VerifyTab(this);
+    watchTab = new WatchTab(this);
+    ladderTab = new LadderTab(this);
     historyTab = new HistoryTab(this);
     
     tabWidget->addTab(predictTab, "Predict");
     tabWidget->addTab(verifyTab, "Verify");
+    tabWidget->addTab(watchTab, "Watch");
+    tabWidget->addTab(ladderTab, "Ladder");
     tabWidget->addTab(historyTab, "History");
     setCentralWidget(tabWidget);
     
     // Connect signals
-    connect(predictTab, &PredictTab::predictionCompleted, historyTab, &HistoryTab::addEntry);
+    connect(predictTab, &PredictTab::predictionCompleted, historyTab,
+            [this](const QString& type, const QString& details, const QString& result) {
+        historyTab->addEntry(type, details, result);
+    });
     connect(verifyTab, &VerifyTab::comparisonCompleted, historyTab, &HistoryTab::addEntry);
+    connect(watchTab, &WatchTab::comparisonCompleted, historyTab, &HistoryTab::addEntry);
+    connect(ladderTab, &LadderTab::ladderCompleted, historyTab,
+            [this](const QString& type, const QString& details, const QString& result) {
+        historyTab->addEntry(type, details, result);
+    });
+
+    // Settings menu
+    QMenu *settingsMenu = menuBar()->addMenu("&Settings");
+    settingsMenu->addAction("Job Scheduler...", this, &MainWindow::showSchedulerSettings);
+    settingsMenu->addAction("Reference Cache...", this, &MainWindow::showReferenceCacheSettings);
+    settingsMenu->addAction("Stream Inputs...", this, &MainWindow::showStreamInputSettings);
+    settingsMenu->addSeparator();
+    settingsMenu->addAction("Connect to Job Server...", this, &MainWindow::connectToJobServer);
+    disconnectAction = settingsMenu->addAction("Disconnect from Job Server", this, [this]() {
+        jobClient->disconnectFromServer();
+    });
+    disconnectAction->setEnabled(false);
+
+    // Remote execution: when connected, both tabs submit their jobs to the server
+    jobClient = new JobClient(this);
+    connect(jobClient, &JobClient::disconnected, this, [this]() { setRemoteClient(nullptr); });
+
+    // Status bar: execution target and scheduler load
+    serverLabel = new QLabel("Running locally", this);
+    statusBar()->addPermanentWidget(serverLabel);
+    QLabel *jobsLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(jobsLabel);
+    auto updateJobs = [jobsLabel](int running, int queued) {
+        jobsLabel->setText(QString("Jobs: %1 running, %2 queued").arg(running).arg(queued));
+    };
+    updateJobs(0, 0);
+    connect(JobScheduler::instance(), &JobScheduler::queueChanged, jobsLabel, updateJobs);
+}
+
+void MainWindow::showSchedulerSettings() {
+    JobScheduler *scheduler = JobScheduler::instance();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Job Scheduler");
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QSpinBox *budgetSpin = new QSpinBox(&dialog);
+    budgetSpin->setRange(1, 1024);
+    budgetSpin->setValue(scheduler->threadBudget());
+    budgetSpin->setToolTip(QString("Total threads shared by all running jobs (this machine has %1).\n"
+                                   "Jobs wait in the queue until enough of the budget is free.")
+                           .arg(QThread::idealThreadCount()));
+    form->addRow("Thread budget:", budgetSpin);
+
+    QSpinBox *niceSpin = new QSpinBox(&dialog);
+    niceSpin->setRange(0, 19);
+    niceSpin->setValue(scheduler->niceLevel());
+    niceSpin->setToolTip("Lower the CPU priority of ffmpeg/ab-av1 processes (0 = normal, 19 = lowest).\n"
+                         "On Windows any non-zero value selects below-normal priority.");
+    form->addRow("Nice level:", niceSpin);
+
+    QLineEdit *affinityEdit = new QLineEdit(JobScheduler::formatCpuList(scheduler->cpuAffinity()), &dialog);
+    affinityEdit->setPlaceholderText("all CPUs");
+    affinityEdit->setToolTip("Pin job processes to these CPUs, e.g. \"0-7,16-23\". Leave empty for no pinning.");
+    form->addRow("CPU affinity:", affinityEdit);
+
+    QSpinBox *wallSpin = new QSpinBox(&dialog);
+    wallSpin->setRange(0, 7 * 24 * 3600);
+    wallSpin->setSuffix(" s");
+    wallSpin->setSpecialValueText("no limit");
+    wallSpin->setValue(scheduler->wallTimeout());
+    wallSpin->setToolTip("Stop a job (and every process it started) that runs longer than this.");
+    form->addRow("Wall-clock timeout:", wallSpin);
+
+    QSpinBox *idleSpin = new QSpinBox(&dialog);
+    idleSpin->setRange(0, 24 * 3600);
+    idleSpin->setSuffix(" s");
+    idleSpin->setSpecialValueText("no limit");
+    idleSpin->setValue(scheduler->idleTimeout());
+    idleSpin->setToolTip("Stop a job whose process prints nothing for this long, e.g. a hung decode.");
+    form->addRow("Idle-output timeout:", idleSpin);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    // Applies to jobs launched from now on; running processes keep their settings
+    scheduler->setThreadBudget(budgetSpin->value());
+    scheduler->setNiceLevel(niceSpin->value());
+    scheduler->setCpuAffinity(JobScheduler::parseCpuList(affinityEdit->text()));
+    scheduler->setWallTimeout(wallSpin->value());
+    scheduler->setIdleTimeout(idleSpin->value());
+}
+
+void MainWindow::showReferenceCacheSettings() {
+    constexpr qint64 GiB = 1024LL * 1024 * 1024;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Reference Cache");
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QLabel *usageLabel = new QLabel(&dialog);
+    auto updateUsage = [usageLabel]() {
+        usageLabel->setText(QString("%1 GiB in %2").arg(double(ReferenceCache::totalBytes()) / GiB, 0, 'f', 1)
+                                                   .arg(ReferenceCache::directory()));
+    };
+    updateUsage();
+    form->addRow("In use:", usageLabel);
+
+    QSpinBox *sizeSpin = new QSpinBox(&dialog);
+    sizeSpin->setRange(1, 100000);
+    sizeSpin->setSuffix(" GiB");
+    sizeSpin->setValue(int(ReferenceCache::maxBytes() / GiB));
+    sizeSpin->setToolTip("Least recently used proxies are deleted once the cache grows past this.\n"
+                         "FFV1 proxies are typically a third to half the size of raw video.");
+    form->addRow("Size limit:", sizeSpin);
+
+    QPushButton *clearBtn = new QPushButton("Clear Cache", &dialog);
+    connect(clearBtn, &QPushButton::clicked, &dialog, [updateUsage]() {
+        ReferenceCache::clear();
+        updateUsage();
+    });
+    form->addRow(QString(), clearBtn);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+    ReferenceCache::setMaxBytes(sizeSpin->value() * GiB);
+}
+
+void MainWindow::showStreamInputSettings() {
+    VideoUtils::StreamOptions options = VideoUtils::StreamOptions::load();
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Stream Inputs");
+    QFormLayout *form = new QFormLayout(&dialog);
+
+    QSpinBox *readAheadSpin = new QSpinBox(&dialog);
+    readAheadSpin->setRange(0, 1024);
+    readAheadSpin->setSuffix(" MiB");
+    readAheadSpin->setValue(options.readAheadKiB / 1024);
+    readAheadSpin->setToolTip("HTTP inputs: a forward seek shorter than this keeps reading the open response\n"
+                              "instead of issuing a new range request.");
+    form->addRow("Read-ahead:", readAheadSpin);
+
+    QSpinBox *timeoutSpin = new QSpinBox(&dialog);
+    timeoutSpin->setRange(0, 3600);
+    timeoutSpin->setSuffix(" s");
+    timeoutSpin->setSpecialValueText("no limit");
+    timeoutSpin->setValue(options.timeoutSeconds);
+    timeoutSpin->setToolTip("Fail a URL read that receives no data for this long.");
+    form->addRow("Network timeout:", timeoutSpin);
+
+    QCheckBox *reconnectCheck = new QCheckBox("Reconnect dropped HTTP connections", &dialog);
+    reconnectCheck->setChecked(options.reconnect);
+    form->addRow(QString(), reconnectCheck);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, &dialog);
+    connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    form->addRow(buttons);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+    options.readAheadKiB = readAheadSpin->value() * 1024;
+    options.timeoutSeconds = timeoutSpin->value();
+    options.reconnect = reconnectCheck->isChecked();
+    options.save();
+}
+
+void MainWindow::connectToJobServer() {
+    bool ok = false;
+    const QString address = QInputDialog::getText(this, "Connect to Job Server",
+        "Server address ([host:]port or local:<name>):", QLineEdit::Normal,
+        jobClient->address().isEmpty() ? "127.0.0.1:7450" : jobClient->address(), &ok);
+    if (!ok || address.trimmed().isEmpty()) return;
+
+    QString error;
+    if (!jobClient->connectToServer(address.trimmed(), 3000, &error)) {
+        QMessageBox::warning(this, "Job Server", "Could not connect to " + address + ":\n" + error);
+        return;
+    }
+    setRemoteClient(jobClient);
+}
+
+void MainWindow::setRemoteClient(JobClient *client) {
+    predictTab->setRemoteClient(client);
+    verifyTab->setRemoteClient(client);
+    disconnectAction->setEnabled(client != nullptr);
+    serverLabel->setText(client ? "Server: " + client->address() : "Running locally");
 }
@@ -3,8 +3,13 @@
 
 #include <QMainWindow>
 #include "HistoryTab.h"
+#include "LadderTab.h"
 #include "PredictTab.h"
 #include "VerifyTab.h"
+#include "WatchTab.h"
+#include "JobClient.h"
+
+class QLabel;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -14,10 +19,21 @@ public:
 
 private:
     void setupUI();
+    void showSchedulerSettings();
+    void showReferenceCacheSettings();
+    void showStreamInputSettings();
+    void connectToJobServer();
+    void setRemoteClient(JobClient *client);
     
     HistoryTab *historyTab;
     PredictTab *predictTab;
     VerifyTab *verifyTab;
+    WatchTab *watchTab;
+    LadderTab *ladderTab;
+
+    JobClient *jobClient;
+    QLabel *serverLabel;
+    QAction *disconnectAction;
 };
 
 #endif // MAINWINDOW_H
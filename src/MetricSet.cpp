@@ -0,0 +1,41 @@
+#include "MetricSet.h"
+
+QString MetricScore::text() const {
+    QString s = QString("%1: %2").arg(label).arg(value, 0, 'f', decimals);
+    if (!unit.isEmpty()) s += " " + unit;
+    return s;
+}
+
+namespace MetricSet {
+
+const QList<ExtraMetric>& available() {
+    static const QList<ExtraMetric> metrics{
+        {"ms_ssim",  "MS-SSIM",   "float_ms_ssim", "float_ms_ssim", QString(), 4},
+        {"ciede",    "CIEDE2000", "ciede",         "ciede2000",     QString(), 2},
+        {"cambi",    "CAMBI",     "cambi",         "cambi",         QString(), 3},
+        {"psnr_hvs", "PSNR-HVS",  "psnr_hvs",      "psnr_hvs",      "dB",      2},
+    };
+    return metrics;
+}
+
+const ExtraMetric* find(const QString& id) {
+    for (const ExtraMetric& m : available())
+        if (m.id == id) return &m;
+    return nullptr;
+}
+
+QString featureOption(const QStringList& ids) {
+    QStringList names;
+    for (const QString& id : ids)
+        if (const ExtraMetric *m = find(id)) names << "name=" + m->feature;
+    return names.join('|');
+}
+
+QStringList normalize(const QStringList& ids) {
+    QStringList result;
+    for (const ExtraMetric& m : available())
+        if (ids.contains(m.id)) result << m.id;
+    return result;
+}
+
+} // namespace MetricSet
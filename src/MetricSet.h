@@ -0,0 +1,40 @@
+#ifndef METRICSET_H
+#define METRICSET_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// A metric computed by a libvmaf feature extractor. Requested metrics are added to
+// the run's existing libvmaf filter (feature=name=...), so they share its decoded,
+// format-converted frames instead of needing another ffmpeg pass.
+struct ExtraMetric {
+    QString id;        // stable key for settings, the job protocol and history ("ms_ssim")
+    QString label;     // display name ("MS-SSIM")
+    QString feature;   // libvmaf extractor ("float_ms_ssim")
+    QString column;    // column of libvmaf's csv log holding the per-frame score
+    QString unit;      // appended to values ("dB"); may be empty
+    int decimals = 2;
+};
+
+// One pooled score of any metric, in a form every view can show the same way
+struct MetricScore {
+    QString id, label, unit;
+    double value = 0;
+    int decimals = 2;
+
+    // "MS-SSIM: 0.9871", "PSNR-HVS: 41.20 dB"
+    QString text() const;
+};
+
+namespace MetricSet {
+    // MS-SSIM, CIEDE2000, CAMBI (banding; lower is better) and PSNR-HVS
+    const QList<ExtraMetric>& available();
+    const ExtraMetric* find(const QString& id);
+    // Value of libvmaf's feature option for `ids`: "name=float_ms_ssim|name=ciede"
+    QString featureOption(const QStringList& ids);
+    // Drops unknown ids and duplicates, keeping available() order
+    QStringList normalize(const QStringList& ids);
+}
+
+#endif // METRICSET_H
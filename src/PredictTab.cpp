@@ -1,5 +1,7 @@
 #include "PredictTab.h"
 #include "VideoUtils.h"
+#include "EncodeModel.h"
+#include "JobScheduler.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGridLayout>
@@ -12,11 +14,37 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QThread>
+
+// Every encoder the tab knows presets for; the probe narrows this to the ones that work
+static const QStringList kKnownEncoders = {
+    // AV1
+    "libsvtav1", "av1_qsv", "av1_nvenc", "av1_amf",
+    // HEVC
+    "libx265", "hevc_qsv", "hevc_nvenc", "hevc_amf",
+    // H.264
+    "libx264", "h264_qsv", "h264_nvenc", "h264_amf"
+};
+
+// "01:23:45"
+static QString formatDuration(qint64 seconds) {
+    return QString("%1:%2:%3").arg(seconds / 3600, 2, 10, QChar('0'))
+        .arg(seconds / 60 % 60, 2, 10, QChar('0')).arg(seconds % 60, 2, 10, QChar('0'));
+}
 
 PredictTab::PredictTab(QWidget *parent) : QWidget(parent) {
     predictJob = new AbAv1Job(this);
+    encodeJob = new ChunkedEncodeJob(this);
+    encoderProbe = new EncoderProbe(this);
     setupUI();
 
+    // Probe which encoders actually work here; cached per ffmpeg binary, so usually instant
+    connect(encoderProbe, &EncoderProbe::logLine, this, [this](const QString& line) {
+        predictOutput->append(line);
+    });
+    connect(encoderProbe, &EncoderProbe::finished, this, &PredictTab::applyEncoderCapabilities);
+    encoderProbe->start(kKnownEncoders);
+
     // Log lines → output widget
     connect(predictJob, &AbAv1Job::logLine, this, [this](const QString& line) {
         predictOutput->append(line);
@@ -67,18 +95,127 @@ PredictTab::PredictTab(QWidget *parent) : QWidget(parent) {
                 .arg(predResultSizeLabel->text())
                 .arg(predResultTimeLabel->text());
             emit predictionCompleted("Prediction", m_pendingRunDetails, result);
+
+            // Offer the final encode at the CRF just found
+            bool crfOk = false;
+            m_encodeSettings.crf = predResultCRFLabel->text().toDouble(&crfOk);
+            if (crfOk) {
+                m_encodeSource = VideoUtils::getVideoFormat(m_encodeSettings.input);
+                updateModelEstimate();
+                const QFileInfo input(m_encodeSettings.input);
+                encodeOutputEdit->setText(input.dir().filePath(
+                    QString("%1_%2_crf%3.mkv").arg(input.completeBaseName(), m_encodeSettings.encoder,
+                                                   predResultCRFLabel->text())));
+                encodeRunBtn->setText(QString("Encode at CRF %1").arg(predResultCRFLabel->text()));
+                encodeGroup->setVisible(true);
+            }
         } else {
             predictOutput->append("\nFAILED: Process exited with code " + QString::number(exitCode));
         }
     });
 }
 
+void PredictTab::startEncode() {
+    ChunkedEncodeJob::Settings settings = m_encodeSettings;
+    settings.output  = encodeOutputEdit->text().trimmed();
+    settings.workers = encodeWorkersSpin->value();
+    // The encode always runs here, even when the CRF search ran on a job server
+    if (!QFileInfo::exists(settings.input)) {
+        QMessageBox::warning(this, "Error", "The input file is not available on this machine:\n" + settings.input);
+        return;
+    }
+    if (settings.output.isEmpty() || QFileInfo(settings.output) == QFileInfo(settings.input)) {
+        QMessageBox::warning(this, "Error", "Please choose an output file other than the input.");
+        return;
+    }
+    if (QFileInfo::exists(settings.output)
+        && QMessageBox::question(this, "Overwrite", "Overwrite " + settings.output + "?") != QMessageBox::Yes)
+        return;
+
+    encodeRunBtn->setEnabled(false);
+    encodeCancelBtn->setEnabled(true);
+    predictRunBtn->setEnabled(false);
+    encodeProgressBar->setValue(0);
+    encodeProgressBar->setVisible(true);
+    predictOutput->append(QString("\nEncoding %1 with %2 (preset %3) at CRF %4, %5 chunks in parallel...")
+                              .arg(QFileInfo(settings.input).fileName(), settings.encoder, settings.preset)
+                              .arg(settings.crf).arg(settings.workers));
+    m_encodeClock.start();
+    encodeJob->start(settings);
+}
+
+// Speed and size from the EncodeModel, for the encode as the Encode group would run it
+void PredictTab::updateModelEstimate() {
+    const VideoUtils::VideoFormat& source = m_encodeSource;
+    const int workers = encodeWorkersSpin->value();
+    const int threads = qMax(1, JobScheduler::instance()->threadBudget() / workers);
+    const EncodeEstimate e = EncodeModel::estimate(m_encodeSettings.encoder, m_encodeSettings.preset,
+                                                   source.width, source.height, m_encodeSettings.crf,
+                                                   threads, EncodeModel::complexityOf(source));
+    if (!e.valid()) {
+        predResultModelLabel->setText(QString("no estimate yet: %1 of %2 measured encodes with this encoder and preset")
+                                          .arg(e.samples).arg(EncodeModel::MinSamples));
+        return;
+    }
+    const double frames = source.durationSeconds * source.frameRate;
+    if (frames <= 0) {
+        predResultModelLabel->setText(QString("%1 fps per chunk").arg(e.fps, 0, 'f', 1));
+        return;
+    }
+    predResultModelLabel->setText(
+        QString("%1 fps per chunk × %2 chunks: %3, %4 MB (±%5% time, ±%6% size; from %7 encodes)")
+            .arg(e.fps, 0, 'f', 1).arg(workers)
+            .arg(formatDuration(qint64(e.seconds(frames) / workers)))
+            .arg(e.bytes(frames, source.width, source.height) / (1024.0 * 1024.0), 0, 'f', 0)
+            .arg(e.fpsError * 100, 0, 'f', 0).arg(e.sizeError * 100, 0, 'f', 0).arg(e.samples));
+}
+
+void PredictTab::setRemoteClient(JobClient *client) {
+    predictJob->setRemote(client);
+}
+
+void PredictTab::applyEncoderCapabilities() {
+    reprobeBtn->setEnabled(true);
+
+    // No results means ffmpeg wasn't found; keep the full list rather than an empty combo
+    const QMap<QString, EncoderCapability> results = encoderProbe->results();
+    if (results.isEmpty()) return;
+
+    QStringList working;
+    for (const QString& encoder : kKnownEncoders)
+        if (results.value(encoder).working) working << encoder;
+
+    if (working.isEmpty()) {
+        predictOutput->append("Encoder probe: no encoder passed its test encode; showing all encoders.");
+        return;
+    }
+
+    m_capabilities = results;
+    const QString current = encoderCombo->currentText();
+    encoderCombo->blockSignals(true);
+    encoderCombo->clear();
+    encoderCombo->addItems(working);
+    encoderCombo->setCurrentIndex(qMax(0, encoderCombo->findText(current)));
+    encoderCombo->blockSignals(false);
+    updatePresetOptions(encoderCombo->currentText());
+
+    predictOutput->append("Encoder probe: available encoders: " + working.join(", "));
+}
+
 void PredictTab::updatePresetOptions(const QString &encoder) {
     presetCombo->clear();
 
+    // Probed capabilities (if any) narrow the list to presets this ffmpeg build accepts
+    const EncoderCapability cap = m_capabilities.value(encoder);
+
     // Helper lambda: adds an item with display text and the raw preset value as UserRole data
-    auto add = [this](const QString &display, const QString &value) {
-        presetCombo->addItem(display, QVariant(value));
+    auto add = [this, &cap](const QString &display, const QString &value) {
+        if (cap.acceptsPreset(value))
+            presetCombo->addItem(display, QVariant(value));
+    };
+    // Selects the default preset by value, since filtering may have shifted indices
+    auto setDefault = [this](const QString &value) {
+        presetCombo->setCurrentIndex(qMax(0, presetCombo->findData(QVariant(value))));
     };
 
     if (encoder == "av1_qsv" || encoder == "hevc_qsv" || encoder == "h264_qsv") {
@@ -90,7 +227,7 @@ void PredictTab::updatePresetOptions(const QString &encoder) {
         add("5",             "5");
         add("6",             "6");
         add("7 (speed)",     "7");
-        presetCombo->setCurrentIndex(3); // default: balanced
+        setDefault("4"); // default: balanced
         presetCombo->setToolTip("Intel QSV preset (1–7).\n1 = quality (slowest, best compression)\n4 = balanced\n7 = speed (fastest)");
 
     } else if (encoder == "av1_nvenc" || encoder == "hevc_nvenc" || encoder == "h264_nvenc") {
@@ -102,7 +239,7 @@ void PredictTab::updatePresetOptions(const QString &encoder) {
         add("p3",            "p3");
         add("p2",            "p2");
         add("p1 (speed)",    "p1");
-        presetCombo->setCurrentIndex(3); // default: balanced
+        setDefault("p4"); // default: balanced
         presetCombo->setToolTip("NVIDIA NVENC preset (p1–p7).\np7 = quality (slowest)\np4 = balanced\np1 = speed (fastest)");
 
     } else if (encoder == "av1_amf" || encoder == "hevc_amf" || encoder == "h264_amf") {
@@ -110,7 +247,7 @@ void PredictTab::updatePresetOptions(const QString &encoder) {
         add("quality",   "quality");
         add("balanced",  "balanced");
         add("speed",     "speed");
-        presetCombo->setCurrentIndex(1); // default: balanced
+        setDefault("balanced"); // default: balanced
         presetCombo->setToolTip("AMD AMF preset.\nquality = slowest, best compression\nspeed = fastest");
 
     } else if (encoder == "libsvtav1") {
@@ -123,7 +260,7 @@ void PredictTab::updatePresetOptions(const QString &encoder) {
         add("10",            "10");
         add("12 (speed)",    "12");
         add("13",            "13");
-        presetCombo->setCurrentIndex(3); // default: balanced (5)
+        setDefault("5"); // default: balanced (5)
         presetCombo->setToolTip("SVT-AV1 preset (0–13).\n0 = quality (slowest)\n5 = balanced\n12–13 = speed (fastest)");
 
     } else {
@@ -137,7 +274,7 @@ void PredictTab::updatePresetOptions(const QString &encoder) {
         add("veryfast",           "veryfast");
         add("superfast",          "superfast");
         add("ultrafast (speed)",  "ultrafast");
-        presetCombo->setCurrentIndex(3); // default: medium
+        setDefault("medium"); // default: medium
         presetCombo->setToolTip("x264/x265 preset.\nveryslow = quality (slowest)\nmedium = balanced\nultrafast = speed (fastest)");
     }
 }
@@ -164,16 +301,15 @@ void PredictTab::setupUI() {
     encoderLabel->setToolTip("Select the video codec. Software (lib*) is high quality but slow. Hardware (qsv/nvenc/amf) uses your GPU for speed.");
     settingsLayout->addWidget(encoderLabel, 0, 0);
     encoderCombo = new QComboBox(this);
-    encoderCombo->addItems({
-        // AV1
-        "libsvtav1", "av1_qsv", "av1_nvenc", "av1_amf",
-        // HEVC
-        "libx265", "hevc_qsv", "hevc_nvenc", "hevc_amf",
-        // H.264
-        "libx264", "h264_qsv", "h264_nvenc", "h264_amf"
-    });
+    encoderCombo->addItems(kKnownEncoders);
     settingsLayout->addWidget(encoderCombo, 0, 1);
 
+    reprobeBtn = new QPushButton("Re-probe", this);
+    reprobeBtn->setToolTip("Re-test which encoders work with the installed ffmpeg and GPU drivers.\n"
+                           "Results are cached per ffmpeg binary.");
+    reprobeBtn->setEnabled(false);
+    settingsLayout->addWidget(reprobeBtn, 0, 2);
+
     QLabel *presetLabel = new QLabel("Preset:", this);
     presetLabel->setToolTip("Encoding speed vs quality preset.\n"
                             "Options change based on the selected encoder.");
@@ -241,8 +377,46 @@ void PredictTab::setupUI() {
     predResLayout->addWidget(predResultSizeLabel, 1, 1);
     predResLayout->addWidget(new QLabel("Est. Time:", this), 1, 2);
     predResLayout->addWidget(predResultTimeLabel, 1, 3);
+    predResultModelLabel = new QLabel("--", this);
+    predResultModelLabel->setWordWrap(true);
+    predResultModelLabel->setToolTip("Learned from the encodes measured on this machine (final encodes and ladder probes),\n"
+                                     "for the whole file with the Encode settings below");
+    predResLayout->addWidget(new QLabel("Local Estimate:", this), 2, 0);
+    predResLayout->addWidget(predResultModelLabel, 2, 1, 1, 3);
     layout->addWidget(predResultsGroup);
 
+    // Encode Group: the whole title at the predicted CRF
+    encodeGroup = new QGroupBox("Encode", this);
+    encodeGroup->setVisible(false);
+    QGridLayout *encodeLayout = new QGridLayout(encodeGroup);
+    encodeOutputEdit = new QLineEdit(this);
+    QPushButton *encodeBrowseBtn = new QPushButton("Browse...", this);
+    encodeLayout->addWidget(new QLabel("Output:", this), 0, 0);
+    encodeLayout->addWidget(encodeOutputEdit, 0, 1, 1, 2);
+    encodeLayout->addWidget(encodeBrowseBtn, 0, 3);
+
+    QLabel *workersLabel = new QLabel("Parallel chunks:", this);
+    workersLabel->setToolTip("The source is split at scene cuts and this many chunks are encoded at once,\n"
+                             "sharing the scheduler's thread budget. Chunks are joined without re-encoding.\n"
+                             "A cancelled or failed encode resumes from the finished chunks.");
+    encodeLayout->addWidget(workersLabel, 1, 0);
+    encodeWorkersSpin = new QSpinBox(this);
+    encodeWorkersSpin->setRange(1, 64);
+    encodeWorkersSpin->setValue(qBound(1, QThread::idealThreadCount() / 4, 8));
+    encodeLayout->addWidget(encodeWorkersSpin, 1, 1);
+
+    encodeRunBtn = new QPushButton("Encode", this);
+    encodeCancelBtn = new QPushButton("Cancel Encode", this);
+    encodeCancelBtn->setEnabled(false);
+    encodeLayout->addWidget(encodeRunBtn, 1, 2);
+    encodeLayout->addWidget(encodeCancelBtn, 1, 3);
+
+    encodeProgressBar = new QProgressBar(this);
+    encodeProgressBar->setVisible(false);
+    encodeProgressBar->setTextVisible(true);
+    encodeLayout->addWidget(encodeProgressBar, 2, 0, 1, 4);
+    layout->addWidget(encodeGroup);
+
     // Output Log
     predictOutput = new QTextEdit(this);
     predictOutput->setReadOnly(true);
@@ -263,13 +437,82 @@ void PredictTab::setupUI() {
         predictJob->cancel();
     });
 
+    connect(encodeBrowseBtn, &QPushButton::clicked, this, [this]() {
+        QString fileName = QFileDialog::getSaveFileName(this, "Save Encode As", encodeOutputEdit->text(),
+                                                        "Video Files (*.mkv *.mp4 *.webm)");
+        if (!fileName.isEmpty()) encodeOutputEdit->setText(fileName);
+    });
+    connect(encodeRunBtn, &QPushButton::clicked, this, &PredictTab::startEncode);
+    connect(encodeWorkersSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this]() {
+        if (!encodeGroup->isHidden()) updateModelEstimate();
+    });
+    connect(encodeCancelBtn, &QPushButton::clicked, encodeJob, &ChunkedEncodeJob::cancel);
+
+    connect(encodeJob, &ChunkedEncodeJob::logLine, this, [this](const QString& line) {
+        predictOutput->append(line);
+        predictOutput->verticalScrollBar()->setValue(predictOutput->verticalScrollBar()->maximum());
+    });
+    connect(encodeJob, &ChunkedEncodeJob::stageChanged, this, [this](const QString& stage) {
+        m_encodeStage = stage;
+        encodeProgressBar->setValue(0);
+        encodeProgressBar->setFormat(stage + "...");
+    });
+    connect(encodeJob, &ChunkedEncodeJob::progressUpdated, this, [this](double done, double total) {
+        if (total <= 0) return;
+        const int percent = qBound(0, int(done * 100 / total), 100);
+        encodeProgressBar->setValue(percent);
+        encodeProgressBar->setFormat(QString("%1: %2 / %3 s (%4%)")
+                                         .arg(m_encodeStage).arg(done, 0, 'f', 0).arg(total, 0, 'f', 0).arg(percent));
+    });
+    connect(encodeJob, &ChunkedEncodeJob::chunkFinished, this, [this](int done, int count) {
+        encodeGroup->setTitle(QString("Encode (%1 of %2 chunks done)").arg(done).arg(count));
+    });
+    connect(encodeJob, &ChunkedEncodeJob::finished, this, [this](bool success) {
+        encodeRunBtn->setEnabled(true);
+        encodeCancelBtn->setEnabled(false);
+        predictRunBtn->setEnabled(true);
+        encodeProgressBar->setVisible(false);
+        encodeGroup->setTitle("Encode");
+        if (!success) {
+            predictOutput->append("\nFAILED: Encode did not complete.");
+            return;
+        }
+        const QString output = encodeOutputEdit->text().trimmed();
+        const double seconds = m_encodeClock.elapsed() / 1000.0;
+        const QString time = formatDuration(qint64(seconds));
+        predictOutput->append("\nSUCCESS: Encode completed in " + time + ".");
+        const QString details = QString("%1 -> %2 (%3, preset %4)")
+            .arg(QFileInfo(m_encodeSettings.input).fileName(), QFileInfo(output).fileName(),
+                 m_encodeSettings.encoder, m_encodeSettings.preset);
+        QString result = QString("CRF: %1 | Size: %2 MB | Time: %3")
+            .arg(m_encodeSettings.crf)
+            .arg(QFileInfo(output).size() / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(time);
+        const double frames = m_encodeSource.durationSeconds * m_encodeSource.frameRate;
+        if (frames > 0 && seconds > 0) result += QString(" | Speed: %1 fps").arg(frames / seconds, 0, 'f', 1);
+        updateModelEstimate();
+        emit predictionCompleted("Encode", details, result);
+    });
+
+    connect(reprobeBtn, &QPushButton::clicked, this, [this]() {
+        reprobeBtn->setEnabled(false);
+        encoderProbe->start(kKnownEncoders, true);
+    });
+
     connect(predictRunBtn, &QPushButton::clicked, this, [this]() {
         QString inputFile = predFileEdit->text();
-        if (inputFile.isEmpty() || !QFileInfo::exists(inputFile) || !VideoUtils::isValidVideoFile(inputFile)) {
+        // A remote server resolves the path itself, so only check existence when running locally
+        const bool missing = !predictJob->isRemote() && !QFileInfo::exists(inputFile);
+        if (inputFile.isEmpty() || missing || !VideoUtils::isValidVideoFile(inputFile)) {
             QMessageBox::warning(this, "Error", "Please select a valid input file.");
             return;
         }
 
+        m_encodeSettings.input   = inputFile;
+        m_encodeSettings.encoder = encoderCombo->currentText();
+        m_encodeSettings.preset  = presetCombo->currentData().toString();
+        encodeGroup->setVisible(false);
+
         m_pendingRunDetails = QString("%1 (%2, preset %3)")
             .arg(QFileInfo(inputFile).fileName())
             .arg(encoderCombo->currentText())
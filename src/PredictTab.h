@@ -11,13 +11,19 @@
 #include <QGroupBox>
 #include <QLabel>
 #include <QTextEdit>
+#include <QMap>
+#include <QElapsedTimer>
 #include "AbAv1Job.h"
+#include "ChunkedEncodeJob.h"
+#include "EncoderProbe.h"
 
 class PredictTab : public QWidget {
     Q_OBJECT
 
 public:
     explicit PredictTab(QWidget *parent = nullptr);
+    // Routes jobs to a JobServer; nullptr runs them on this machine
+    void setRemoteClient(JobClient *client);
 
 signals:
     void predictionCompleted(const QString& type, const QString& details, const QString& result);
@@ -25,10 +31,14 @@ signals:
 private:
     void setupUI();
     void updatePresetOptions(const QString &encoder);
+    void applyEncoderCapabilities();
+    void startEncode();
+    void updateModelEstimate();
 
     QLineEdit *predFileEdit;
     QComboBox *encoderCombo;
     QComboBox *presetCombo;
+    QPushButton *reprobeBtn;
     QDoubleSpinBox *vmafSpin;
     QSpinBox *samplesSpin;
 
@@ -41,12 +51,31 @@ private:
     QLabel *predResultVMAFLabel;
     QLabel *predResultSizeLabel;
     QLabel *predResultTimeLabel;
+    QLabel *predResultModelLabel;
+
+    // Final encode at the predicted CRF
+    QGroupBox *encodeGroup;
+    QLineEdit *encodeOutputEdit;
+    QSpinBox *encodeWorkersSpin;
+    QPushButton *encodeRunBtn;
+    QPushButton *encodeCancelBtn;
+    QProgressBar *encodeProgressBar;
 
     QTextEdit *predictOutput;
     AbAv1Job  *predictJob;
+    ChunkedEncodeJob *encodeJob;
+    EncoderProbe *encoderProbe;
+
+    // Probe results keyed by encoder name; empty until the first probe finishes
+    QMap<QString, EncoderCapability> m_capabilities;
 
     // Captured at job-start; used when the finished signal fires
     QString m_pendingRunDetails;
+    // Input and settings of the last successful prediction, for the encode
+    ChunkedEncodeJob::Settings m_encodeSettings;
+    VideoUtils::VideoFormat m_encodeSource;
+    QString m_encodeStage;
+    QElapsedTimer m_encodeClock;
 };
 
 #endif // PREDICTTAB_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "ProcessStats.h"
+#include <QByteArray>
+#include <QFile>
+#include <QDir>
+#include <QList>
+#include <QSet>
+#include <QString>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace ProcessStats {
+
+#if defined(Q_OS_LINUX)
+// "VmHWM:     123456 kB" -> 123456
+static qint64 kibField(const QByteArray& line) {
+    return line.mid(line.indexOf(':') + 1).trimmed().split(' ').value(0).toLongLong();
+}
+
+// utime + stime + cutime + cstime, in seconds; -1 if unreadable
+static double treeCpuOf(qint64 pid) {
+    QFile stat(QString("/proc/%1/stat").arg(pid));
+    if (!stat.open(QIODevice::ReadOnly)) return -1;
+    const QByteArray text = stat.readAll();
+    const QList<QByteArray> fields = text.mid(text.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() <= 14) return -1;
+    double ticks = 0;
+    for (int i = 11; i <= 14; ++i) ticks += fields[i].toDouble();
+    return ticks / double(sysconf(_SC_CLK_TCK));
+}
+
+// Direct children of every thread of `pid`
+static QList<qint64> childrenOf(qint64 pid) {
+    QList<qint64> children;
+    const QDir tasks(QString("/proc/%1/task").arg(pid));
+    for (const QString& tid : tasks.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QFile file(tasks.filePath(tid + "/children"));
+        if (!file.open(QIODevice::ReadOnly)) continue;
+        for (const QByteArray& child : file.readAll().split(' ')) {
+            const qint64 id = child.trimmed().toLongLong();
+            if (id > 0) children << id;
+        }
+    }
+    return children;
+}
+#endif
+
+bool sample(qint64 pid, Sample& out) {
+#if defined(Q_OS_LINUX)
+    if (pid <= 0) return false;
+    QFile status(QString("/proc/%1/status").arg(pid));
+    if (!status.open(QIODevice::ReadOnly)) return false;
+    for (const QByteArray& line : status.readAll().split('\n')) {
+        if (line.startsWith("VmHWM:"))     out.peakRssKiB = kibField(line);
+        else if (line.startsWith("VmRSS:")) out.rssKiB    = kibField(line);
+    }
+
+    // utime and stime are fields 14 and 15; skip past "(comm)", which may contain spaces
+    QFile stat(QString("/proc/%1/stat").arg(pid));
+    if (!stat.open(QIODevice::ReadOnly)) return true;
+    const QByteArray text = stat.readAll();
+    const QList<QByteArray> fields = text.mid(text.lastIndexOf(')') + 2).split(' ');
+    if (fields.size() > 12) {
+        const double ticks = fields[11].toDouble() + fields[12].toDouble();
+        out.cpuSeconds = ticks / double(sysconf(_SC_CLK_TCK));
+    }
+    return true;
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(out);
+    return false;
+#endif
+}
+
+bool sampleTree(qint64 pid, Sample& out) {
+#if defined(Q_OS_LINUX)
+    if (pid <= 0) return false;
+    bool any = false;
+    double cpu = 0;
+    qint64 rss = 0, peak = 0;
+    QList<qint64> pending{pid};
+    QSet<qint64> seen;
+    while (!pending.isEmpty()) {
+        const qint64 current = pending.takeFirst();
+        if (seen.contains(current)) continue;
+        seen.insert(current);
+        Sample s;
+        if (!sample(current, s)) continue;   // exited meanwhile
+        any = true;
+        const double treeCpu = treeCpuOf(current);
+        if (treeCpu >= 0) cpu += treeCpu;
+        if (s.rssKiB > 0) rss += s.rssKiB;
+        peak = qMax(peak, s.peakRssKiB);
+        pending << childrenOf(current);
+    }
+    if (!any) return false;
+    out.cpuSeconds = cpu;
+    out.rssKiB     = rss;
+    out.peakRssKiB = qMax(peak, rss);
+    return true;
+#else
+    Q_UNUSED(pid);
+    Q_UNUSED(out);
+    return false;
+#endif
+}
+
+} // namespace ProcessStats
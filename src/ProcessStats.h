@@ -0,0 +1,24 @@
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+
+// Point-in-time resource usage of a running child process, read from /proc.
+// Only implemented on Linux; elsewhere sample() returns false and callers
+// report the figures as unavailable.
+namespace ProcessStats {
+    struct Sample {
+        double cpuSeconds  = -1;  // user + system time so far
+        qint64 rssKiB      = -1;  // current resident set
+        qint64 peakRssKiB  = -1;  // kernel high-water mark (VmHWM)
+    };
+
+    bool sample(qint64 pid, Sample& out);
+    // The same over `pid` and all its live descendants (/proc/<pid>/task/*/children).
+    // cpuSeconds includes children that have already exited and been waited for;
+    // rssKiB is the sum over the tree and peakRssKiB the larger of that sum and the
+    // biggest single high-water mark, so callers should keep the maximum over samples.
+    bool sampleTree(qint64 pid, Sample& out);
+}
+
+#endif // PROCESSSTATS_H
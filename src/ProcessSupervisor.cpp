@@ -0,0 +1,154 @@
+#include "ProcessSupervisor.h"
+#include "ProcessStats.h"
+#include <QProcess>
+
+#if defined(Q_OS_WIN)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(Q_OS_UNIX)
+#include <csignal>
+#include <unistd.h>
+#endif
+
+// Timeout checks and whole-tree sampling; /proc walks are too costly for a faster rate
+static constexpr int TickIntervalMs = 1000;
+
+ProcessSupervisor::ProcessSupervisor(QProcess *process) : QObject(process), m_process(process) {
+    m_tickTimer.setInterval(TickIntervalMs);
+    connect(&m_tickTimer, &QTimer::timeout, this, &ProcessSupervisor::tick);
+    m_graceTimer.setSingleShot(true);
+    connect(&m_graceTimer, &QTimer::timeout, this, &ProcessSupervisor::kill);
+
+    connect(process, &QProcess::started, this, &ProcessSupervisor::onStarted);
+    connect(process, &QProcess::readyReadStandardOutput, this, [this]() { m_idleClock.restart(); });
+    connect(process, &QProcess::readyReadStandardError, this, [this]() { m_idleClock.restart(); });
+    connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+            this, &ProcessSupervisor::onFinished);
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+#if defined(Q_OS_WIN)
+    // JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE: closing the last handle ends anything left in it
+    if (m_jobObject) CloseHandle(m_jobObject);
+#endif
+}
+
+void ProcessSupervisor::onStarted() {
+    m_pid = m_process->processId();
+    m_wallClock.start();
+    m_idleClock.start();
+    m_tickTimer.start();
+#if defined(Q_OS_WIN)
+    // Children created from now on join the job; a process spawned before this
+    // point (a few ms after start) would escape, which ffmpeg/ab-av1 never do
+    m_jobObject = CreateJobObjectW(nullptr, nullptr);
+    if (m_jobObject) {
+        JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+        limits.BasicLimitInformation.LimitFlags = JOB_OBJECT_LIMIT_KILL_ON_JOB_CLOSE;
+        SetInformationJobObject(m_jobObject, JobObjectExtendedLimitInformation, &limits, sizeof(limits));
+        HANDLE handle = OpenProcess(PROCESS_SET_QUOTA | PROCESS_TERMINATE, FALSE, static_cast<DWORD>(m_pid));
+        if (!handle || !AssignProcessToJobObject(m_jobObject, handle)) {
+            CloseHandle(m_jobObject);
+            m_jobObject = nullptr;
+        }
+        if (handle) CloseHandle(handle);
+    }
+#endif
+}
+
+void ProcessSupervisor::onFinished() {
+    m_tickTimer.stop();
+    m_graceTimer.stop();
+    // The leader is gone, but ab-av1's encoders (or anything else it spawned) may not be
+    killGroup(true);
+    m_pid = 0;
+}
+
+void ProcessSupervisor::tick() {
+    sample();
+    if (m_timedOut) return;
+    QString reason;
+    if (m_wallTimeout > 0 && m_wallClock.elapsed() >= qint64(m_wallTimeout) * 1000)
+        reason = QString("wall-clock timeout: still running after %1 s").arg(m_wallTimeout);
+    else if (m_idleTimeout > 0 && m_idleClock.elapsed() >= qint64(m_idleTimeout) * 1000)
+        reason = QString("idle timeout: no output for %1 s").arg(m_idleTimeout);
+    if (reason.isEmpty()) return;
+
+    m_timedOut = true;
+    emit timeoutExpired(reason);
+    terminate(reason);
+}
+
+void ProcessSupervisor::sample() {
+    if (m_pid <= 0) return;
+#if defined(Q_OS_WIN)
+    if (!m_jobObject) return;
+    JOBOBJECT_BASIC_ACCOUNTING_INFORMATION accounting = {};
+    if (QueryInformationJobObject(m_jobObject, JobObjectBasicAccountingInformation,
+                                  &accounting, sizeof(accounting), nullptr)) {
+        // 100 ns units; includes processes in the job that have already exited
+        m_cpuSeconds = (accounting.TotalUserTime.QuadPart + accounting.TotalKernelTime.QuadPart) / 1e7;
+    }
+    JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits = {};
+    if (QueryInformationJobObject(m_jobObject, JobObjectExtendedLimitInformation,
+                                  &limits, sizeof(limits), nullptr)) {
+        // Peak committed memory of the whole job; the closest Windows has to a tree RSS peak
+        m_peakRssKiB = qint64(limits.PeakJobMemoryUsed / 1024);
+    }
+#else
+    ProcessStats::Sample tree;
+    if (!ProcessStats::sampleTree(m_pid, tree)) return;
+    m_cpuSeconds = qMax(m_cpuSeconds, tree.cpuSeconds);
+    m_peakRssKiB = qMax(m_peakRssKiB, tree.peakRssKiB);
+#endif
+}
+
+void ProcessSupervisor::terminate(const QString& reason, int graceMs) {
+    if (!m_process || m_process->state() == QProcess::NotRunning) return;
+    if (!reason.isEmpty()) m_stopReason = reason;
+#if defined(Q_OS_UNIX)
+    killGroup(false);
+    if (!m_graceTimer.isActive()) m_graceTimer.start(graceMs);
+#else
+    Q_UNUSED(graceMs);
+    kill();
+#endif
+}
+
+void ProcessSupervisor::kill() {
+    if (!m_process || m_process->state() == QProcess::NotRunning) return;
+    killGroup(true);
+    m_process->kill();
+}
+
+void ProcessSupervisor::killGroup(bool force) {
+    if (m_pid <= 0) return;
+#if defined(Q_OS_WIN)
+    Q_UNUSED(force);
+    if (m_jobObject) TerminateJobObject(m_jobObject, 1);
+    else if (m_process->state() != QProcess::NotRunning) QProcess::execute("taskkill", {"/F", "/T", "/PID", QString::number(m_pid)});
+#elif defined(Q_OS_UNIX)
+    // prepareProcess() made the child a process-group leader, so -pid reaches its descendants.
+    // The kernel keeps a group's id reserved while any member is alive.
+    ::kill(-static_cast<pid_t>(m_pid), force ? SIGKILL : SIGTERM);
+#else
+    Q_UNUSED(force);
+#endif
+}
+
+void ProcessSupervisor::killTree(QProcess *process) {
+    if (!process) return;
+    if (auto *supervisor = process->findChild<ProcessSupervisor*>(QString(), Qt::FindDirectChildrenOnly)) {
+        supervisor->kill();
+        return;
+    }
+    if (process->state() == QProcess::NotRunning) return;
+    const qint64 pid = process->processId();
+#if defined(Q_OS_WIN)
+    if (pid > 0)
+        QProcess::execute("taskkill", {"/F", "/T", "/PID", QString::number(pid)});
+#elif defined(Q_OS_UNIX)
+    if (pid > 0) ::kill(-static_cast<pid_t>(pid), SIGKILL);
+#endif
+    process->kill();
+}
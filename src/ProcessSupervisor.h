@@ -0,0 +1,77 @@
+#ifndef PROCESSSUPERVISOR_H
+#define PROCESSSUPERVISOR_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+
+class QProcess;
+
+// Owns the lifetime of one external process and everything it spawns (ab-av1 runs
+// its own ffmpeg children). On Unix the child leads its own process group
+// (JobScheduler::prepareProcess) and, on Linux, is killed if the app dies; on
+// Windows it is placed in a kill-on-close Job Object. Cancels and timeouts take
+// down the whole tree, and when the leader exits any stragglers left in its group
+// are killed as well, so no encode outlives its job.
+//
+// Also samples CPU time and resident memory over the whole tree while it runs.
+class ProcessSupervisor : public QObject {
+    Q_OBJECT
+
+public:
+    // Becomes a child of `process`; create it before QProcess::start()
+    explicit ProcessSupervisor(QProcess *process);
+    ~ProcessSupervisor() override;
+
+    // Stop the tree after this long in total / without any stdout or stderr output.
+    // 0 disables the limit.
+    void setWallTimeout(int seconds) { m_wallTimeout = seconds; }
+    void setIdleTimeout(int seconds) { m_idleTimeout = seconds; }
+
+    // SIGTERM to the group so ffmpeg can close its outputs, SIGKILL after graceMs.
+    // Windows has no graceful equivalent for console children, so it kills at once.
+    void terminate(const QString& reason, int graceMs = 3000);
+    // Kills the process tree immediately
+    void kill();
+    // Kills `process` and every descendant; for processes without a supervisor
+    static void killTree(QProcess *process);
+
+    // Why the supervisor stopped the process ("idle timeout: no output for 600 s");
+    // empty when it exited on its own or was cancelled
+    QString stopReason() const { return m_stopReason; }
+    bool timedOut() const { return m_timedOut; }
+
+    // Whole-tree figures from the last sample; -1 when not available on this platform
+    double cpuSeconds() const { return m_cpuSeconds; }
+    qint64 peakRssKiB() const { return m_peakRssKiB; }
+
+signals:
+    // A limit was hit; the tree is being terminated
+    void timeoutExpired(const QString& reason);
+
+private:
+    void onStarted();
+    void onFinished();
+    void tick();
+    void sample();
+    void killGroup(bool force);
+
+    QProcess *m_process;
+    qint64 m_pid = 0;
+    QTimer m_tickTimer;
+    QTimer m_graceTimer;
+    QElapsedTimer m_wallClock, m_idleClock;
+    int m_wallTimeout = 0, m_idleTimeout = 0;
+    bool m_timedOut = false;
+    QString m_stopReason;
+
+    double m_cpuSeconds = -1;
+    qint64 m_peakRssKiB = -1;
+
+#if defined(Q_OS_WIN)
+    void *m_jobObject = nullptr;   // HANDLE
+#endif
+};
+
+#endif // PROCESSSUPERVISOR_H
@@ -0,0 +1,178 @@
+#include "QualityGate.h"
+#include <QRegularExpression>
+#include <QTime>
+#include <cmath>
+
+static const char *metricName(FrameMetrics::Metric metric) {
+    switch (metric) {
+    case FrameMetrics::Ssim: return "ssim";
+    case FrameMetrics::Psnr: return "psnr";
+    case FrameMetrics::Vmaf: return "vmaf";
+    }
+    return "vmaf";
+}
+
+// Best score a frame can get; 0 when unbounded (PSNR of identical frames is inf)
+static double metricCeiling(FrameMetrics::Metric metric) {
+    switch (metric) {
+    case FrameMetrics::Ssim: return 1.0;
+    case FrameMetrics::Vmaf: return 100.0;
+    case FrameMetrics::Psnr: return 0.0;
+    }
+    return 0.0;
+}
+
+QString GateRule::toString() const {
+    const QString value = QString::number(threshold);
+    switch (kind) {
+    case Window: return QString("%1 window %2s >= %3").arg(metricName(metric)).arg(windowSeconds).arg(value);
+    case Frame:  return QString("%1 frame >= %2").arg(metricName(metric), value);
+    case Mean:   break;
+    }
+    return QString("%1 >= %2").arg(metricName(metric), value);
+}
+
+QString GateVerdict::message() const {
+    if (!failed) return "passed";
+    if (!measured) return QString("failed \"%1\" (metric not measured)").arg(rule);
+    const QString decimals = QString::number(value, 'f', value <= 1.0 ? 4 : 2);
+    if (frame < 0) return QString("failed \"%1\" (%2)").arg(rule, decimals);
+    return QString("failed \"%1\" at %2, frame %3 (%4)")
+        .arg(rule, QTime(0, 0).addMSecs(int(time * 1000)).toString("HH:mm:ss.zzz"))
+        .arg(frame).arg(decimals);
+}
+
+QualityGate::QualityGate(const QList<GateRule>& rules, double frameRate, double startTime)
+    : m_frameRate(frameRate), m_startTime(startTime) {
+    for (const GateRule& rule : rules) {
+        RuleState state;
+        state.rule = rule;
+        if (rule.kind == GateRule::Window) {
+            // 24 fps is assumed when the stream did not report a rate
+            const double fps = frameRate > 0 ? frameRate : 24.0;
+            state.windowFrames = qMax(1, int(std::lround(rule.windowSeconds * fps)));
+            state.window = QVector<float>(state.windowFrames, 0.0f);
+        }
+        m_states << state;
+    }
+}
+
+QList<GateRule> QualityGate::parse(const QString& text, QString *errorMessage) {
+    static QRegularExpression ruleRx(
+        R"(^(ssim|psnr|vmaf)\s*(?:(mean|frame)|window\s*([\d.]+)\s*s?)?\s*>=?\s*([\d.]+)$)",
+        QRegularExpression::CaseInsensitiveOption);
+    QList<GateRule> rules;
+    const QStringList parts = text.split(QRegularExpression("[;,\\n]"), Qt::SkipEmptyParts);
+    for (const QString& part : parts) {
+        const QString trimmed = part.trimmed();
+        if (trimmed.isEmpty()) continue;
+        const QRegularExpressionMatch m = ruleRx.match(trimmed);
+        if (!m.hasMatch()) {
+            if (errorMessage) *errorMessage = QString("Cannot parse quality gate \"%1\"").arg(trimmed);
+            return {};
+        }
+        GateRule rule;
+        const QString metric = m.captured(1).toLower();
+        rule.metric = metric == "ssim" ? FrameMetrics::Ssim : metric == "psnr" ? FrameMetrics::Psnr
+                                                                                : FrameMetrics::Vmaf;
+        if (m.captured(2).compare("frame", Qt::CaseInsensitive) == 0) {
+            rule.kind = GateRule::Frame;
+        } else if (!m.captured(3).isEmpty()) {
+            rule.kind = GateRule::Window;
+            rule.windowSeconds = m.captured(3).toDouble();
+            if (rule.windowSeconds <= 0) {
+                if (errorMessage) *errorMessage = QString("Window must be longer than 0 s in \"%1\"").arg(trimmed);
+                return {};
+            }
+        }
+        rule.threshold = m.captured(4).toDouble();
+        rules << rule;
+    }
+    return rules;
+}
+
+QString QualityGate::format(const QList<GateRule>& rules) {
+    QStringList parts;
+    for (const GateRule& rule : rules) parts << rule.toString();
+    return parts.join("; ");
+}
+
+void QualityGate::fail(const RuleState& state, int frame, double value, bool early) {
+    m_verdict.failed = true;
+    m_verdict.early  = early;
+    m_verdict.rule   = state.rule.toString();
+    m_verdict.frame  = frame;
+    m_verdict.time   = frame >= 0 ? m_startTime + (m_frameRate > 0 ? frame / m_frameRate : 0.0) : 0.0;
+    m_verdict.value  = value;
+}
+
+bool QualityGate::addFrame(FrameMetrics::Metric metric, float value) {
+    const int frame = m_seen[metric]++;
+    if (m_verdict.failed) return false;
+    // inf PSNR (identical frames) counts as a very good frame, not an infinite one
+    const double v = std::isfinite(value) ? value : FrameMetricsIO::PyramidCeiling;
+
+    for (RuleState& s : m_states) {
+        if (s.rule.metric != metric) continue;
+        s.sum += v;
+        ++s.count;
+        switch (s.rule.kind) {
+        case GateRule::Frame:
+            if (v < s.rule.threshold) fail(s, frame, v, true);
+            break;
+        case GateRule::Window: {
+            float& slot = s.window[frame % s.windowFrames];
+            s.windowSum += v - slot;
+            slot = float(v);
+            if (s.count >= s.windowFrames && s.windowSum / s.windowFrames < s.rule.threshold)
+                fail(s, frame - s.windowFrames + 1, s.windowSum / s.windowFrames, true);
+            break;
+        }
+        case GateRule::Mean: {
+            // Unrecoverable once perfect scores on every remaining frame can't lift the mean
+            const double ceiling = metricCeiling(metric);
+            if (ceiling <= 0 || m_expectedFrames <= 0 || s.count >= m_expectedFrames) break;
+            const double best = (s.sum + (m_expectedFrames - s.count) * ceiling) / m_expectedFrames;
+            if (best < s.rule.threshold) fail(s, frame, s.sum / s.count, true);
+            break;
+        }
+        }
+        if (m_verdict.failed) return false;
+    }
+    return true;
+}
+
+void QualityGate::setOverall(FrameMetrics::Metric metric, double value) {
+    m_overall[metric] = value;
+    m_hasOverall[metric] = true;
+}
+
+const GateVerdict& QualityGate::finish(const FrameMetrics& metrics) {
+    if (m_verdict.failed) return m_verdict;
+    for (FrameMetrics::Metric m : {FrameMetrics::Ssim, FrameMetrics::Psnr, FrameMetrics::Vmaf}) {
+        const QVector<float>& values = metrics.series(m);
+        for (int i = m_seen[m]; i < values.size() && !m_verdict.failed; ++i) addFrame(m, values[i]);
+    }
+    if (m_verdict.failed) {
+        m_verdict.early = false;
+        return m_verdict;
+    }
+
+    for (const RuleState& s : std::as_const(m_states)) {
+        const FrameMetrics::Metric m = s.rule.metric;
+        // A gate on a metric that was never computed (e.g. VMAF in proxy mode) can't pass
+        if (s.count == 0 && !m_hasOverall[m]) {
+            fail(s, -1, 0, false);
+            m_verdict.measured = false;
+            break;
+        }
+        if (s.rule.kind != GateRule::Mean) continue;
+        // Prefer ffmpeg's own overall score (PSNR's is MSE-based, not a mean of dB values)
+        const double mean = m_hasOverall[m] ? m_overall[m] : s.sum / s.count;
+        if (mean < s.rule.threshold) {
+            fail(s, -1, mean, false);
+            break;
+        }
+    }
+    return m_verdict;
+}
@@ -0,0 +1,84 @@
+#ifndef QUALITYGATE_H
+#define QUALITYGATE_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+#include "FrameMetrics.h"
+
+// One pass/fail rule, written as text like
+//   "vmaf >= 93"                 mean over the whole run (ffmpeg's overall score)
+//   "vmaf window 2s >= 80"       no 2-second window may average below 80
+//   "ssim frame >= 0.9"          no single frame below 0.9
+struct GateRule {
+    enum Kind { Mean, Window, Frame };
+    FrameMetrics::Metric metric = FrameMetrics::Vmaf;
+    Kind kind = Mean;
+    double threshold = 0;
+    double windowSeconds = 2.0;
+
+    QString toString() const;
+};
+
+// Outcome of a gate for one input
+struct GateVerdict {
+    bool failed = false;
+    bool early  = false;   // decided before the whole input was scored
+    QString rule;          // GateRule::toString() of the rule that failed
+    int frame = -1;        // offending frame (window start), -1 for whole-run rules
+    double time = 0;       // source timestamp of `frame`, in seconds
+    double value = 0;      // the failing mean / window mean / frame score
+    bool measured = true;  // false when the rule's metric was not computed at all
+
+    QString message() const;
+};
+
+// Evaluates a set of rules incrementally as per-frame scores arrive, so a run can
+// stop as soon as a rule is failed in a way the remaining frames cannot undo:
+// a frame or window below its threshold, or a mean that stays below the threshold
+// even if every remaining frame scored perfectly (needs the expected frame count;
+// PSNR has no upper bound, so its mean is only checked at the end).
+class QualityGate {
+public:
+    QualityGate() = default;
+    QualityGate(const QList<GateRule>& rules, double frameRate, double startTime = 0);
+
+    // "rule; rule; ..." (commas and newlines also separate rules)
+    static QList<GateRule> parse(const QString& text, QString *errorMessage = nullptr);
+    static QString format(const QList<GateRule>& rules);
+
+    void setExpectedFrames(int frames) { m_expectedFrames = frames; }
+    // Feeds the next frame of `metric`. Returns false once any rule has failed.
+    bool addFrame(FrameMetrics::Metric metric, float value);
+    int framesSeen(FrameMetrics::Metric metric) const { return m_seen[metric]; }
+    // Whole-run score of a metric as reported by ffmpeg; used for Mean rules at the end
+    void setOverall(FrameMetrics::Metric metric, double value);
+
+    // Feeds the frames of `metrics` not seen yet and checks the Mean rules
+    const GateVerdict& finish(const FrameMetrics& metrics);
+
+    bool failed() const { return m_verdict.failed; }
+    const GateVerdict& verdict() const { return m_verdict; }
+
+private:
+    struct RuleState {
+        GateRule rule;
+        int windowFrames = 1;
+        double sum = 0;
+        int count = 0;
+        QVector<float> window;   // ring buffer of the last windowFrames values
+        double windowSum = 0;
+    };
+    void fail(const RuleState& state, int frame, double value, bool early);
+
+    QList<RuleState> m_states;
+    double m_frameRate = 0;
+    double m_startTime = 0;
+    int m_expectedFrames = 0;
+    int m_seen[3] = {0, 0, 0};
+    double m_overall[3] = {0, 0, 0};
+    bool m_hasOverall[3] = {false, false, false};
+    GateVerdict m_verdict;
+};
+
+#endif // QUALITYGATE_H
@@ -0,0 +1,290 @@
+#include "QualityTimeline.h"
+#include "FrameArchive.h"
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTime>
+#include <QWheelEvent>
+#include <cmath>
+
+QualityTimeline::QualityTimeline(QWidget *parent) : QWidget(parent) {
+    setMouseTracking(false);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void QualityTimeline::setMetrics(const FrameMetrics& metrics) {
+    m_archive.reset();
+    m_metrics = metrics;
+    m_highlights.clear();
+    m_sizePrefix.clear();
+    m_keyframePrefix.clear();
+    buildLevels();
+    resetZoom();
+}
+
+void QualityTimeline::setArchive(std::shared_ptr<const FrameArchive> archive) {
+    m_archive = std::move(archive);
+    // Only the timing fields are used; the series stay in the mapping
+    m_metrics = FrameMetrics();
+    if (m_archive) {
+        m_metrics.frameRate = m_archive->frameRate();
+        m_metrics.startTime = m_archive->startTime();
+    }
+    m_highlights.clear();
+    m_sizePrefix.clear();
+    m_keyframePrefix.clear();
+    buildLevels();
+    resetZoom();
+}
+
+void QualityTimeline::setMetric(FrameMetrics::Metric metric) {
+    m_metric = metric;
+    buildLevels();
+    update();
+}
+
+void QualityTimeline::setHighlights(const QList<FrameSegment>& segments) {
+    m_highlights = segments;
+    update();
+}
+
+void QualityTimeline::setFrameTrack(const FrameTrack& track) {
+    const int n = track.frameCount();
+    m_sizePrefix = QVector<double>(n + 1, 0.0);
+    m_keyframePrefix = QVector<int>(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+        m_sizePrefix[i + 1] = m_sizePrefix[i] + track.sizes[i];
+        m_keyframePrefix[i + 1] = m_keyframePrefix[i] + (track.isKeyframe(i) ? 1 : 0);
+    }
+    if (n == 0) {
+        m_sizePrefix.clear();
+        m_keyframePrefix.clear();
+    }
+    update();
+}
+
+void QualityTimeline::clear() {
+    setMetrics(FrameMetrics());
+}
+
+void QualityTimeline::zoomTo(int firstFrame, int frameCount) {
+    // Show some context either side of the requested range
+    const double pad = frameCount * 0.5;
+    m_viewStart  = firstFrame - pad;
+    m_viewFrames = frameCount + 2 * pad;
+    clampView();
+    update();
+}
+
+void QualityTimeline::resetZoom() {
+    m_viewStart  = 0;
+    m_viewFrames = m_levels.isEmpty() ? 0 : m_levels.first().size;
+    update();
+}
+
+void QualityTimeline::clampView() {
+    const double total = m_levels.isEmpty() ? 0 : m_levels.first().size;
+    m_viewFrames = qBound(qMin(16.0, total), m_viewFrames, total);
+    m_viewStart  = qBound(0.0, m_viewStart, total - m_viewFrames);
+}
+
+void QualityTimeline::buildLevels() {
+    m_levels.clear();
+    m_pyramid = MinMaxPyramid();
+
+    if (m_archive) {
+        for (int k = 0; k < m_archive->levelCount(m_metric); ++k)
+            m_levels << Level{m_archive->levelMin(m_metric, k), m_archive->levelMax(m_metric, k),
+                              m_archive->levelSize(k)};
+    } else {
+        m_pyramid = FrameMetricsIO::buildPyramid(m_metrics.series(m_metric));
+        for (int k = 0; k < m_pyramid.levelCount(); ++k)
+            m_levels << Level{m_pyramid.min[k].constData(), m_pyramid.max[k].constData(),
+                              int(m_pyramid.min[k].size())};
+    }
+    if (m_levels.isEmpty()) return;
+
+    // Y range: fixed scales where the metric has one, data-driven otherwise
+    const float lo = m_levels.last().min[0];
+    const float hi = m_levels.last().max[0];
+    switch (m_metric) {
+    case FrameMetrics::Ssim: m_yMin = qMin(0.9f, std::floor(lo * 50) / 50); m_yMax = 1.0f;  break;
+    case FrameMetrics::Vmaf: m_yMin = qMin(60.0f, std::floor(lo / 10) * 10); m_yMax = 100.0f; break;
+    case FrameMetrics::Psnr: m_yMin = std::floor(lo / 5) * 5; m_yMax = std::ceil(hi / 5) * 5; break;
+    }
+    if (m_yMax <= m_yMin) m_yMax = m_yMin + 1;
+}
+
+// Min/max over frames [first, last). Uses the coarsest level whose buckets are still
+// a small fraction of the range, so each call touches only a handful of entries.
+bool QualityTimeline::rangeMinMax(int first, int last, float& lo, float& hi) const {
+    if (m_levels.isEmpty() || last <= first) return false;
+    int level = 0;
+    while (level + 1 < m_levels.size() && (2 << level) * 4 <= last - first) ++level;
+
+    const Level& l = m_levels[level];
+    const int a = first >> level;
+    const int b = qMin(l.size, ((last - 1) >> level) + 1);
+    if (a >= b) return false;
+    lo = l.min[a];
+    hi = l.max[a];
+    for (int i = a + 1; i < b; ++i) {
+        lo = qMin(lo, l.min[i]);
+        hi = qMax(hi, l.max[i]);
+    }
+    return true;
+}
+
+QRect QualityTimeline::plotRect() const {
+    return rect().adjusted(48, 8, -8, -22);
+}
+
+double QualityTimeline::frameAtX(int x) const {
+    const QRect plot = plotRect();
+    return m_viewStart + (x - plot.left()) * m_viewFrames / qMax(1, plot.width());
+}
+
+void QualityTimeline::paintEvent(QPaintEvent *) {
+    QPainter p(this);
+    p.fillRect(rect(), palette().base());
+    const QRect plot = plotRect();
+
+    if (m_levels.isEmpty() || m_viewFrames <= 0) {
+        p.setPen(palette().color(QPalette::Disabled, QPalette::Text));
+        p.drawText(rect(), Qt::AlignCenter, "No per-frame data");
+        return;
+    }
+
+    auto yOf = [&](float v) {
+        const double t = (qBound(m_yMin, v, m_yMax) - m_yMin) / (m_yMax - m_yMin);
+        return plot.bottom() - int(t * plot.height());
+    };
+
+    // Grid and Y labels
+    p.setPen(QColor(0, 0, 0, 40));
+    const int steps = 4;
+    for (int i = 0; i <= steps; ++i) {
+        const float v = m_yMin + (m_yMax - m_yMin) * i / steps;
+        const int y = yOf(v);
+        p.drawLine(plot.left(), y, plot.right(), y);
+        p.save();
+        p.setPen(palette().color(QPalette::Text));
+        p.drawText(QRect(0, y - 8, plot.left() - 4, 16), Qt::AlignRight | Qt::AlignVCenter,
+                   QString::number(v, 'f', m_metric == FrameMetrics::Ssim ? 3 : 1));
+        p.restore();
+    }
+
+    // Highlighted segments
+    auto xOf = [&](double frame) {
+        return plot.left() + int((frame - m_viewStart) * plot.width() / m_viewFrames);
+    };
+    for (const FrameSegment& s : std::as_const(m_highlights)) {
+        const int x0 = qMax(plot.left(), xOf(s.firstFrame));
+        const int x1 = qMin(plot.right(), xOf(s.firstFrame + s.frameCount));
+        if (x1 >= x0) p.fillRect(QRect(x0, plot.top(), qMax(1, x1 - x0), plot.height()), QColor(244, 67, 54, 50));
+    }
+
+    // Bit rate and keyframes of the encode, under the series
+    const double perPixel = m_viewFrames / qMax(1, plot.width());
+    auto columnFrames = [&](int x, int& first, int& last) {
+        first = int(std::floor(m_viewStart + (x - plot.left()) * perPixel));
+        last  = qMax(first + 1, int(std::floor(m_viewStart + (x - plot.left() + 1) * perPixel)));
+    };
+    if (hasFrameTrack()) {
+        const int frames = int(m_sizePrefix.size()) - 1;
+        // kbit/s with a frame rate, bytes per frame without; either way scaled to the visible peak
+        const double scale = m_metrics.frameRate > 0 ? m_metrics.frameRate * 8 / 1000 : 1;
+        QVector<double> rates(plot.width() + 1, -1);
+        double peak = 0;
+        for (int x = plot.left(); x <= plot.right(); ++x) {
+            int first, last;
+            columnFrames(x, first, last);
+            first = qBound(0, first, frames);
+            last = qBound(0, last, frames);
+            if (last <= first) continue;
+            rates[x - plot.left()] = (m_sizePrefix[last] - m_sizePrefix[first]) / (last - first) * scale;
+            peak = qMax(peak, rates[x - plot.left()]);
+
+            if (m_keyframePrefix[last] > m_keyframePrefix[first])
+                p.fillRect(QRect(x, plot.top(), 1, 6), QColor(0, 0, 0, 140));
+        }
+        if (peak > 0) {
+            const int band = plot.height() * 35 / 100;
+            for (int x = plot.left(); x <= plot.right(); ++x) {
+                const double rate = rates[x - plot.left()];
+                if (rate <= 0) continue;
+                const int h = qMax(1, int(rate / peak * band));
+                p.fillRect(QRect(x, plot.bottom() - h, 1, h), QColor(96, 125, 139, 70));
+            }
+            p.setPen(QColor(96, 125, 139));
+            p.drawText(plot.adjusted(0, 8, -4, 0), Qt::AlignRight | Qt::AlignTop,
+                       m_metrics.frameRate > 0 ? QString("bit rate, peak %1 kbps; ticks = keyframes").arg(peak, 0, 'f', 0)
+                                               : QString("frame size, peak %1 B; ticks = keyframes").arg(peak, 0, 'f', 0));
+        }
+    }
+
+    // Series: one min/max bar per pixel column
+    const QColor colors[] = {QColor("#1976d2"), QColor("#388e3c"), QColor("#f57c00")};
+    p.setPen(colors[m_metric]);
+    int prevY = -1;
+    for (int x = plot.left(); x <= plot.right(); ++x) {
+        int first, last;
+        columnFrames(x, first, last);
+        float lo, hi;
+        if (!rangeMinMax(first, last, lo, hi)) continue;
+        const int yLo = yOf(lo), yHi = yOf(hi);
+        // Connect to the previous column so sparse (zoomed-in) data reads as a line
+        if (prevY >= 0) p.drawLine(x - 1, prevY, x, (yLo + yHi) / 2);
+        p.drawLine(x, yHi, x, yLo);
+        prevY = (yLo + yHi) / 2;
+    }
+
+    // Time axis
+    p.setPen(palette().color(QPalette::Text));
+    p.drawRect(plot);
+    auto timeText = [this](double frame) {
+        return QTime(0, 0).addMSecs(int(m_metrics.timeOfFrame(int(frame)) * 1000)).toString("HH:mm:ss");
+    };
+    const bool hasTime = m_metrics.frameRate > 0;
+    const QString left  = hasTime ? timeText(m_viewStart) : QString("frame %1").arg(int(m_viewStart));
+    const QString right = hasTime ? timeText(m_viewStart + m_viewFrames)
+                                  : QString("frame %1").arg(int(m_viewStart + m_viewFrames));
+    p.drawText(QRect(plot.left(), plot.bottom() + 2, plot.width(), 18), Qt::AlignLeft | Qt::AlignVCenter, left);
+    p.drawText(QRect(plot.left(), plot.bottom() + 2, plot.width(), 18), Qt::AlignRight | Qt::AlignVCenter, right);
+}
+
+void QualityTimeline::wheelEvent(QWheelEvent *event) {
+    if (m_levels.isEmpty()) return;
+    const double anchor = frameAtX(int(event->position().x()));
+    const double factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+    m_viewFrames *= factor;
+    m_viewStart = anchor - (anchor - m_viewStart) * factor;
+    clampView();
+    update();
+}
+
+void QualityTimeline::mousePressEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton) return;
+    m_pressX = int(event->position().x());
+    m_pressViewStart = m_viewStart;
+    m_dragged = false;
+}
+
+void QualityTimeline::mouseMoveEvent(QMouseEvent *event) {
+    if (m_pressX < 0) return;
+    const int dx = int(event->position().x()) - m_pressX;
+    if (qAbs(dx) > 3) m_dragged = true;
+    if (!m_dragged) return;
+    m_viewStart = m_pressViewStart - dx * m_viewFrames / qMax(1, plotRect().width());
+    clampView();
+    update();
+}
+
+void QualityTimeline::mouseReleaseEvent(QMouseEvent *event) {
+    if (m_pressX >= 0 && !m_dragged && !m_levels.isEmpty() && plotRect().contains(event->position().toPoint()))
+        emit frameClicked(qBound(0, int(frameAtX(int(event->position().x()))), m_levels.first().size - 1));
+    m_pressX = -1;
+}
+
+void QualityTimeline::mouseDoubleClickEvent(QMouseEvent *) {
+    resetZoom();
+}
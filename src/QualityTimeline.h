@@ -0,0 +1,84 @@
+#ifndef QUALITYTIMELINE_H
+#define QUALITYTIMELINE_H
+
+#include <QWidget>
+#include <QList>
+#include <QVector>
+#include <memory>
+#include "FrameMetrics.h"
+#include "FrameTrack.h"
+
+class FrameArchive;
+
+// Plots one per-frame metric over time. Each pixel column is drawn as the min/max
+// of the frames it covers, read from a min/max pyramid (built once per series, or
+// read straight from a mapped FrameArchive), so painting is O(width) whether the
+// file has 2k or 200k frames.
+// Wheel zooms around the cursor, drag pans, double-click resets, click picks a frame.
+class QualityTimeline : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit QualityTimeline(QWidget *parent = nullptr);
+
+    void setMetrics(const FrameMetrics& metrics);
+    // Plots from the archive's stored pyramid without copying the series
+    void setArchive(std::shared_ptr<const FrameArchive> archive);
+    void setMetric(FrameMetrics::Metric metric);
+    FrameMetrics::Metric metric() const { return m_metric; }
+    // Shaded regions, e.g. the worst segments
+    void setHighlights(const QList<FrameSegment>& segments);
+    // Bit rate (shaded, bottom) and keyframes (ticks, top) under the metric, frame-aligned
+    // with it; cleared by setMetrics()/setArchive()
+    void setFrameTrack(const FrameTrack& track);
+    bool hasFrameTrack() const { return !m_sizePrefix.isEmpty(); }
+    void zoomTo(int firstFrame, int frameCount);
+    void resetZoom();
+    void clear();
+
+    QSize sizeHint() const override { return QSize(600, 180); }
+    QSize minimumSizeHint() const override { return QSize(200, 120); }
+
+signals:
+    void frameClicked(int frame);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+
+private:
+    struct Level {
+        const float *min = nullptr;
+        const float *max = nullptr;
+        int size = 0;
+    };
+
+    void buildLevels();
+    bool rangeMinMax(int first, int last, float& lo, float& hi) const;
+    QRect plotRect() const;
+    double frameAtX(int x) const;
+    void clampView();
+
+    FrameMetrics m_metrics;
+    FrameMetrics::Metric m_metric = FrameMetrics::Vmaf;
+    std::shared_ptr<const FrameArchive> m_archive;
+    MinMaxPyramid m_pyramid;   // storage behind m_levels when not plotting an archive
+    QVector<Level> m_levels;   // level k aggregates 2^k frames
+    float m_yMin = 0, m_yMax = 1;
+    QList<FrameSegment> m_highlights;
+    // Prefix sums over the frame track, so any column's bytes and keyframes are O(1)
+    QVector<double> m_sizePrefix;
+    QVector<int> m_keyframePrefix;
+
+    double m_viewStart  = 0;   // first visible frame
+    double m_viewFrames = 0;   // number of visible frames
+    int m_pressX = -1;
+    double m_pressViewStart = 0;
+    bool m_dragged = false;
+};
+
+#endif // QUALITYTIMELINE_H
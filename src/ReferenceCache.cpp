@@ -0,0 +1,147 @@
+#include "ReferenceCache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QHash>
+#include <QLockFile>
+#include <QSettings>
+#include <QStandardPaths>
+#include <algorithm>
+#include <memory>
+
+static constexpr qint64 GiB = 1024LL * 1024 * 1024;
+static constexpr const char *ProxySuffix   = ".mkv";
+static constexpr const char *PendingSuffix = ".mkv.part";
+static constexpr const char *LockSuffix    = ".lock";
+
+// Reservations held by this process, by pending path
+static QHash<QString, std::shared_ptr<QLockFile>>& pendingLocks() {
+    static QHash<QString, std::shared_ptr<QLockFile>> locks;
+    return locks;
+}
+
+QString ReferenceCache::directory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/reference-proxies";
+}
+
+qint64 ReferenceCache::maxBytes() {
+    return QSettings().value("referenceCache/maxGiB", 100).toLongLong() * GiB;
+}
+
+void ReferenceCache::setMaxBytes(qint64 bytes) {
+    QSettings().setValue("referenceCache/maxGiB", qMax<qint64>(1, bytes / GiB));
+    evict(maxBytes());
+}
+
+qint64 ReferenceCache::totalBytes() {
+    qint64 total = 0;
+    const QFileInfoList entries = QDir(directory()).entryInfoList({QString("*") + ProxySuffix}, QDir::Files);
+    for (const QFileInfo& entry : entries) total += entry.size();
+    return total;
+}
+
+void ReferenceCache::clear() {
+    // Pending proxies belong to running jobs; a later reservation cleans up abandoned ones
+    QDir dir(directory());
+    for (const QString& name : dir.entryList({QString("*") + ProxySuffix}, QDir::Files))
+        dir.remove(name);
+}
+
+QString ReferenceCache::entryPath(const QString& source) {
+    const QFileInfo info(source);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.canonicalFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return QDir(directory()).filePath(QString::fromLatin1(hash.result().toHex().left(20)) + ProxySuffix);
+}
+
+QString ReferenceCache::lookup(const QString& source) {
+    if (!QFileInfo(source).isFile()) return QString();
+    const QString path = entryPath(source);
+    QFile proxy(path);
+    if (!proxy.exists()) return QString();
+    // The modification time doubles as the LRU stamp
+    if (proxy.open(QIODevice::ReadWrite))
+        proxy.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return path;
+}
+
+QString ReferenceCache::reservePending(const QString& source) {
+    QDir().mkpath(directory());
+    QString base = entryPath(source);
+    base.chop(int(qstrlen(ProxySuffix)));
+
+    // A lock left by a process that died is taken over; age alone never makes it
+    // stale, since writing a proxy of a long master takes a long time
+    auto lock = std::make_shared<QLockFile>(base + LockSuffix);
+    lock->setStaleLockTime(0);
+    if (!lock->tryLock(0)) return QString();
+
+    // Holding the lock, any pending file of this entry is left over from a crashed run
+    const QFileInfo baseInfo(base);
+    QDir dir(directory());
+    for (const QString& name : dir.entryList({baseInfo.fileName() + ".*" + PendingSuffix}, QDir::Files))
+        dir.remove(name);
+
+    static int counter = 0;
+    const QString path = QString("%1.%2-%3%4").arg(base).arg(QCoreApplication::applicationPid())
+                                              .arg(++counter).arg(PendingSuffix);
+    pendingLocks().insert(path, lock);
+    return path;
+}
+
+void ReferenceCache::release(const QString& pendingPath) {
+    if (auto lock = pendingLocks().take(pendingPath)) lock->unlock();
+}
+
+bool ReferenceCache::commit(const QString& source, const QString& pendingPath, QString *message) {
+    auto fail = [&](const QString& text) {
+        discard(pendingPath);
+        if (message) *message = text;
+        return false;
+    };
+    const qint64 size = QFileInfo(pendingPath).size();
+    if (size <= 0) return fail("the proxy was not written");
+    if (size > maxBytes()) return fail(QString("the proxy (%1 GiB) is larger than the cache limit")
+                                           .arg(double(size) / GiB, 0, 'f', 1));
+
+    const QString path = entryPath(source);
+    QFile::remove(path);
+    if (!QFile::rename(pendingPath, path)) return fail("could not move the proxy into the cache");
+    release(pendingPath);
+    evict(maxBytes(), path);
+    if (message) *message = QString("%1 GiB, cache now %2 GiB")
+                                .arg(double(size) / GiB, 0, 'f', 1).arg(double(totalBytes()) / GiB, 0, 'f', 1);
+    return true;
+}
+
+void ReferenceCache::discard(const QString& pendingPath) {
+    if (pendingPath.isEmpty()) return;
+    QFile::remove(pendingPath);
+    release(pendingPath);
+}
+
+void ReferenceCache::evict(qint64 limit, const QString& keep) {
+    QFileInfoList entries = QDir(directory()).entryInfoList({QString("*") + ProxySuffix}, QDir::Files);
+    std::sort(entries.begin(), entries.end(), [](const QFileInfo& a, const QFileInfo& b) {
+        return a.lastModified() < b.lastModified();
+    });
+    qint64 total = 0;
+    for (const QFileInfo& entry : std::as_const(entries)) total += entry.size();
+    for (const QFileInfo& entry : std::as_const(entries)) {
+        if (total <= limit) break;
+        if (entry.absoluteFilePath() == QFileInfo(keep).absoluteFilePath()) continue;
+        if (QFile::remove(entry.absoluteFilePath())) total -= entry.size();
+    }
+}
+
+QStringList ReferenceCache::encoderArguments(int threads) {
+    // level 3 with slices decodes in parallel; -g 1 keeps every frame seekable.
+    // passthrough keeps the source's frames and timestamps exactly, so -ss lands the same.
+    return {"-c:v", "ffv1", "-level", "3", "-g", "1", "-slices", "16", "-slicecrc", "0",
+            "-threads", QString::number(threads), "-fps_mode", "passthrough", "-an", "-sn", "-f", "matroska"};
+}
@@ -0,0 +1,46 @@
+#ifndef REFERENCECACHE_H
+#define REFERENCECACHE_H
+
+#include <QString>
+#include <QStringList>
+
+// On-disk cache of lossless reference proxies: a master's decoded video stored as
+// all-intra FFV1 in Matroska, in its original pixel format. FfmpegJob writes the
+// proxy alongside the first full-length comparison against a master (the decoded
+// frames are split off, so no extra decode), and later comparisons read the proxy
+// instead of decoding the heavy mezzanine codec again.
+//
+// Entries are keyed by the master's identity (canonical path, size, mtime), so a
+// changed master is never served stale. The cache is bounded by size and evicts the
+// least recently used proxies; a lookup counts as a use.
+class ReferenceCache {
+public:
+    static QString directory();
+    // Size limit in bytes ("referenceCache/maxGiB", default 100 GiB)
+    static qint64 maxBytes();
+    static void setMaxBytes(qint64 bytes);
+    static qint64 totalBytes();
+    static void clear();
+
+    // Proxy of `source` if one is cached, else an empty string
+    static QString lookup(const QString& source);
+    // Reserves a new proxy of `source` for one job: a pending file name of its own,
+    // guarded by a per-entry lock file so that only one job (in any process) writes a
+    // proxy of a master at a time. Empty when another job already holds it.
+    static QString reservePending(const QString& source);
+    // Moves a completed pending proxy into the cache, evicts older entries to fit and
+    // releases the reservation. False (and the pending file removed) if it could not be stored.
+    static bool commit(const QString& source, const QString& pendingPath, QString *message = nullptr);
+    // Removes the job's own pending file and releases its reservation
+    static void discard(const QString& pendingPath);
+
+    // ffmpeg output options for the proxy: lossless, intra-only, slice-threaded
+    static QStringList encoderArguments(int threads);
+
+private:
+    static QString entryPath(const QString& source);
+    static void release(const QString& pendingPath);
+    static void evict(qint64 limit, const QString& keep = QString());
+};
+
+#endif // REFERENCECACHE_H
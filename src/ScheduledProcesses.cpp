@@ -0,0 +1,67 @@
+#include "ScheduledProcesses.h"
+#include "JobScheduler.h"
+#include "ProcessSupervisor.h"
+#include <QProcess>
+#include <memory>
+
+ScheduledProcesses::ScheduledProcesses(QObject *parent) : QObject(parent) {}
+
+ScheduledProcesses::~ScheduledProcesses() {
+    stopAll();
+}
+
+int ScheduledProcesses::run(const QString& label, const std::function<QStringList(int)>& arguments, int threads,
+                            const Output& onOutput, const Done& onDone) {
+    auto ticket = std::make_shared<int>(0);
+    *ticket = JobScheduler::instance()->submit(label, JobScheduler::Normal, threads,
+                                               [this, ticket, arguments, onOutput, onDone](int granted) {
+        QProcess *process = new QProcess(this);
+        JobScheduler::instance()->prepareProcess(process);
+        process->setWorkingDirectory(m_workingDirectory);
+        m_processes[*ticket] = process;
+
+        // The tail of stderr explains a failure
+        auto errors = std::make_shared<QString>();
+        connect(process, &QProcess::readyReadStandardError, this, [process, onOutput, errors]() {
+            const QString text = QString::fromLocal8Bit(process->readAllStandardError());
+            *errors = (*errors + text).right(2000);
+            if (onOutput) onOutput(text);
+        });
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this, process, ticket, onDone, errors](int exitCode, QProcess::ExitStatus status) {
+            m_processes.remove(*ticket);
+            process->deleteLater();
+            JobScheduler::instance()->release(*ticket);
+            onDone(status == QProcess::NormalExit && exitCode == 0, *errors);
+        });
+
+        process->start("ffmpeg", arguments(granted));
+        if (!process->waitForStarted()) {
+            m_processes.remove(*ticket);
+            process->deleteLater();
+            JobScheduler::instance()->release(*ticket);
+            onDone(false, "could not start ffmpeg; ensure it is in your PATH");
+            return;
+        }
+        JobScheduler::instance()->applyToStartedProcess(process);
+    });
+    m_processes.insert(*ticket, nullptr);
+    return *ticket;
+}
+
+void ScheduledProcesses::stopAll() {
+    JobScheduler *scheduler = JobScheduler::instance();
+    const QMap<int, QProcess*> processes = m_processes;
+    m_processes.clear();
+    for (auto it = processes.cbegin(); it != processes.cend(); ++it) {
+        if (QProcess *process = it.value()) {
+            process->disconnect(this);
+            ProcessSupervisor::killTree(process);
+            process->waitForFinished(3000);
+            delete process;
+            scheduler->release(it.key());
+        } else {
+            scheduler->withdraw(it.key());
+        }
+    }
+}
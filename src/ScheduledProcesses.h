@@ -0,0 +1,41 @@
+#ifndef SCHEDULEDPROCESSES_H
+#define SCHEDULEDPROCESSES_H
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <functional>
+
+class QProcess;
+
+// The ffmpeg steps of a multi-process job (chunked encode, ladder search), each run as
+// its own JobScheduler job. Tracks every step from submission to exit so the owner can
+// stop them all at once: queued ones are withdrawn, running ones killed with their tree.
+class ScheduledProcesses : public QObject {
+    Q_OBJECT
+
+public:
+    using Output = std::function<void(const QString& text)>;
+    using Done = std::function<void(bool ok, const QString& errorOutput)>;
+
+    explicit ScheduledProcesses(QObject *parent = nullptr);
+    ~ScheduledProcesses() override;
+
+    // Steps started from now on run in this directory
+    void setWorkingDirectory(const QString& path) { m_workingDirectory = path; }
+
+    // Submits ffmpeg as a Normal priority job; `arguments` gets the granted threads.
+    // `onOutput` (optional) sees stderr as it arrives, `onDone` gets its last 2000
+    // characters. Returns the scheduler ticket.
+    int run(const QString& label, const std::function<QStringList(int)>& arguments, int threads,
+            const Output& onOutput, const Done& onDone);
+    // Withdraws or kills every step; none of their callbacks run afterwards
+    void stopAll();
+
+private:
+    QString m_workingDirectory;
+    QMap<int, QProcess*> m_processes;   // by scheduler ticket; nullptr while queued
+};
+
+#endif // SCHEDULEDPROCESSES_H
@@ -1,4 +1,6 @@
 #include "VerifyTab.h"
+#include "FrameArchive.h"
+#include "QualityTimeline.h"
 #include "VideoUtils.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -8,9 +10,20 @@
 #include <QScrollBar>
 #include <QFileInfo>
 #include <QTime>
+#include <QHeaderView>
+#include <QDateTime>
+#include <QDir>
+#include <QDialog>
+#include <QPixmap>
+#include <QProcess>
+#include <QScrollArea>
+#include <algorithm>
+#include <numeric>
 
 VerifyTab::VerifyTab(QWidget *parent) : QWidget(parent) {
     ffmpegJob = new FfmpegJob(this);
+    ffmpegJob->setCollectFrameMetrics(true);
+    frameTrackProbe = new FrameTrackProbe(this);
     setupUI();
 
     // Log lines → output widget
@@ -84,22 +97,139 @@ VerifyTab::VerifyTab(QWidget *parent) : QWidget(parent) {
         resultsGroup->setVisible(true);
     });
 
+    // Per-file results → table row (multi-file runs only)
+    connect(ffmpegJob, &FfmpegJob::comparisonResult, this, [this](int index, const ComparisonResult& r) {
+        if (index >= m_multiResults.size()) return;
+        m_multiResults[index] = r;
+        if (m_multiResults.size() == 1 && !r.extra.isEmpty()) {
+            QStringList lines;
+            for (const MetricScore& s : r.extra) lines << s.text();
+            extraMetricsLabel->setText(lines.join("    "));
+            extraHeader->setVisible(true);
+            extraMetricsLabel->setVisible(true);
+            resultsGroup->setVisible(true);
+        }
+        if (m_multiResults.size() < 2 || index >= multiResultsTable->rowCount()) return;
+        auto ssimText = r.hasSsim ? QString::number(r.ssim.all, 'f', 4) : QString("--");
+        auto psnrText = r.hasPsnr ? (r.psnr.avgDb == "inf" ? QString("∞") : r.psnr.avgDb) : QString("--");
+        auto vmafText = r.hasVmaf ? QString::number(r.vmaf, 'f', 2) : QString("--");
+        multiResultsTable->setItem(index, 1, new QTableWidgetItem(ssimText));
+        multiResultsTable->setItem(index, 2, new QTableWidgetItem(psnrText));
+        multiResultsTable->setItem(index, 3, new QTableWidgetItem(vmafText));
+        if (r.hasGate) {
+            QTableWidgetItem *gateItem = new QTableWidgetItem(r.gatePassed ? "PASS" : "FAIL");
+            gateItem->setToolTip(r.gateDetail);
+            gateItem->setForeground(r.gatePassed ? QColor("#2e7d32") : QColor("#c62828"));
+            multiResultsTable->setItem(index, 4, gateItem);
+        }
+        if (!r.extra.isEmpty()) {
+            QStringList extra;
+            for (const MetricScore& s : r.extra) extra << s.text();
+            multiResultsTable->setItem(index, 5, new QTableWidgetItem(extra.join(", ")));
+        }
+        multiResultsGroup->setVisible(true);
+    });
+
+    // Per-frame series → timeline (first file shown; others via the results table)
+    connect(ffmpegJob, &FfmpegJob::frameMetricsReady, this, [this](int index, const FrameMetrics& metrics) {
+        if (index >= m_frameMetrics.size()) return;
+        m_frameMetrics[index] = metrics;
+        if (m_timelineIndex < 0) showTimeline(index);
+
+        // Keep the series so the history entry can reopen it later
+        const QString distorted = rowFile(index);
+        const QString path = FrameArchive::newArchivePath(distorted, index);
+        QJsonObject metadata{{"reference", originalFileEdit->text()}, {"distorted", distorted},
+                             {"created", QDateTime::currentDateTime().toString(Qt::ISODate)},
+                             {"proxy", ffmpegJob->proxyLabel()}};
+        if (!m_windows.isEmpty()) metadata["window"] = m_windows.value(index).label();
+        QString error;
+        if (FrameArchive::write(path, metrics, metadata, &error))
+            m_frameArchives[index] = path;
+        else
+            outputText->append("Could not save per-frame data: " + error);
+    });
+
+    // Timing and resource usage → stats panel
+    connect(ffmpegJob, &FfmpegJob::statsReady, this, &VerifyTab::showStats);
+
     // Finished → restore UI and emit history signal
     connect(ffmpegJob, &FfmpegJob::finished, this, [this](bool success, int exitCode) {
         runBtn->setEnabled(true);
-        runBtn->setText("Run Comparison");
+        runBtn->setText(ffmpegJob->isRemote() ? "Run Comparison (on server)" : "Run Comparison");
         progressBar->setVisible(false);
         outputText->append("\n" + QString("-").repeated(80));
-        if (success) {
-            outputText->append("\nComparison completed successfully!");
-            QString details = QFileInfo(originalFileEdit->text()).fileName() + " vs " +
-                              QFileInfo(comparisonFileEdit->text()).fileName();
+        // A run stopped by its gates is reported like a finished one, with the failure
+        const bool gateAbort = !success && ffmpegJob->abortedByGate();
+        if (gateAbort) outputText->append("\nStopped early: every input failed a quality gate.");
+        showGateVerdicts(gateAbort);
+        auto gateText = [](const ComparisonResult& r) {
+            return r.gatePassed ? QString("Gate: PASS") : "Gate: FAIL - " + r.gateDetail;
+        };
+        // Proxy scores must never be mistaken for full-resolution ones in the history
+        const QString type = ffmpegJob->isProxyMode() ? QString("Comparison (proxy %1)").arg(ffmpegJob->proxyLabel())
+                                                      : QString("Comparison");
+        // Overall scores as shown in the labels: the single input, or all windows combined
+        auto labelResults = [this]() {
             QStringList results;
             if (resultAllLabel->text() != "Overall: --")
                 results << "SSIM: " + resultAllLabel->text().replace("\n", " ");
             if (psnrAvgLabel->text() != "Average: --") results << "PSNR: " + psnrAvgLabel->text();
             if (vmafScoreLabel->text() != "VMAF Score: --") results << vmafScoreLabel->text();
-            emit comparisonCompleted("Comparison", details, results.join(" | "));
+            return results;
+        };
+        const QString reference = QFileInfo(originalFileEdit->text()).fileName();
+        if (success && !m_multiResults.isEmpty() && !m_multiResults.first().identical.isEmpty())
+            resultsGroup->setTitle(resultsGroup->title() + " - identical streams (" + m_multiResults.first().identical + ")");
+        // Scores of 8-bit SDR and 10-bit PQ runs are not comparable; say which this was
+        const QString format = m_multiResults.isEmpty() ? QString() : m_multiResults.first().formatLabel();
+        if (!format.isEmpty()) {
+            outputText->append("\nMetrics computed in " + format);
+            resultsGroup->setTitle(resultsGroup->title() + " - " + format);
+        }
+        if ((success || gateAbort) && m_multiResults.size() > 1) {
+            if (m_windows.isEmpty())
+                outputText->append(QString("\nCompared %1 files against one reference decode.")
+                                   .arg(m_multiResults.size()));
+            else
+                outputText->append(QString("\nCompared %1 windows in one run.").arg(m_windows.size()));
+            for (int i = 0; i < m_multiResults.size(); ++i) {
+                const ComparisonResult& r = m_multiResults[i];
+                QStringList results;
+                if (r.hasSsim) results << "SSIM: " + QString::number(r.ssim.all, 'f', 4);
+                if (r.hasPsnr) results << "PSNR: " + r.psnr.avgDb + " dB";
+                if (r.hasVmaf) results << "VMAF: " + QString::number(r.vmaf, 'f', 2);
+                for (const MetricScore& s : r.extra) results << s.text();
+                if (r.hasGate) results << gateText(r);
+                if (r.bitrateKbps > 0) results << QString("Bitrate: %1 kbps").arg(r.bitrateKbps, 0, 'f', 0);
+                if (!r.pixelFormat.isEmpty()) results << "Format: " + r.formatLabel();
+                if (!r.crop.isEmpty()) results << "Crop: " + r.crop;
+                if (!r.identical.isEmpty()) results << "Identical: " + r.identical;
+                const QString window = r.window.isEmpty() ? QString() : " @ " + r.window;
+                emit comparisonCompleted(type, reference + " vs " + QFileInfo(r.file).fileName() + window,
+                                         results.join(" | "), m_frameArchives.value(i));
+            }
+            // Duration-weighted total of a windowed run
+            if (!m_windows.isEmpty() && success) {
+                emit comparisonCompleted(type, QString("%1 vs %2 (%3 windows combined)")
+                                             .arg(reference, QFileInfo(rowFile(0)).fileName()).arg(m_windows.size()),
+                                         labelResults().join(" | "), QString());
+            }
+        } else if (success || gateAbort) {
+            if (success) outputText->append("\nComparison completed successfully!");
+            QString details = reference + " vs " + QFileInfo(rowFile(0)).fileName();
+            if (!m_windows.isEmpty()) details += " @ " + m_windows.first().label();
+            QStringList results = labelResults();
+            for (const MetricScore& s : m_multiResults.value(0).extra) results << s.text();
+            if (m_multiResults.value(0).hasGate) results << gateText(m_multiResults.value(0));
+            if (m_multiResults.value(0).bitrateKbps > 0)
+                results << QString("Bitrate: %1 kbps").arg(m_multiResults.value(0).bitrateKbps, 0, 'f', 0);
+            if (!m_multiResults.value(0).pixelFormat.isEmpty())
+                results << "Format: " + m_multiResults.value(0).formatLabel();
+            if (!m_multiResults.value(0).crop.isEmpty()) results << "Crop: " + m_multiResults.value(0).crop;
+            if (!m_multiResults.value(0).identical.isEmpty())
+                results << "Identical: " + m_multiResults.value(0).identical;
+            emit comparisonCompleted(type, details, results.join(" | "), m_frameArchives.value(0));
         } else {
             outputText->append(QString("\nFFmpeg exited with code: %1").arg(exitCode));
         }
@@ -107,6 +237,12 @@ VerifyTab::VerifyTab(QWidget *parent) : QWidget(parent) {
     });
 }
 
+void VerifyTab::setRemoteClient(JobClient *client) {
+    ffmpegJob->setRemote(client);
+    // Paths are opened by the server, so they must be valid on that machine
+    runBtn->setText(client ? "Run Comparison (on server)" : "Run Comparison");
+}
+
 void VerifyTab::setupUI() {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     
@@ -119,7 +255,7 @@ void VerifyTab::setupUI() {
     QLabel *originalLabel = new QLabel("Original Media:", this);
     originalLabel->setMinimumWidth(120);
     originalFileEdit = new QLineEdit(this);
-    originalFileEdit->setReadOnly(true);
+    originalFileEdit->setPlaceholderText("Browse, or type an http(s):// URL or named pipe");
     originalFileBtn = new QPushButton("Browse...", this);
     originalResolutionLabel = new QLabel("", this);
     originalResolutionLabel->setStyleSheet("QLabel { color: #0066cc; font-weight: bold; }");
@@ -135,7 +271,7 @@ void VerifyTab::setupUI() {
     QLabel *comparisonLabel = new QLabel("Comparison Media:", this);
     comparisonLabel->setMinimumWidth(120);
     comparisonFileEdit = new QLineEdit(this);
-    comparisonFileEdit->setReadOnly(true);
+    comparisonFileEdit->setPlaceholderText("Browse, or type an http(s):// URL or named pipe");
     comparisonFileBtn = new QPushButton("Browse...", this);
     comparisonResolutionLabel = new QLabel("", this);
     comparisonResolutionLabel->setStyleSheet("QLabel { color: #0066cc; font-weight: bold; }");
@@ -174,6 +310,96 @@ void VerifyTab::setupUI() {
     durationLayout->addStretch();
     timeLayout->addLayout(durationLayout);
     
+    // Several windows of one file, scored in a single run
+    QHBoxLayout *windowsLayout = new QHBoxLayout();
+    useWindowsCheckbox = new QCheckBox("Windows:", this);
+    windowsEdit = new QLineEdit(this);
+    windowsEdit->setPlaceholderText("00:00:00+30, 00:12:00+60, 01:20:00-01:21:00");
+    windowsEdit->setToolTip("Time windows of the comparison file, as start+duration or start-end, separated by ','.\n"
+                            "All windows are scored in one ffmpeg run; each gets its own row plus a\n"
+                            "duration-weighted combined score. Replaces the start time and duration.");
+    windowsEdit->setEnabled(false);
+    windowsLayout->addWidget(useWindowsCheckbox);
+    windowsLayout->addWidget(windowsEdit);
+    timeLayout->addLayout(windowsLayout);
+
+    // Keyframe placement of seeked ranges
+    snapKeyframesCheckbox = new QCheckBox("Start on keyframes (indexed once, cached)", this);
+    snapKeyframesCheckbox->setToolTip("Move the start time or each window back to the nearest earlier keyframe shared by\n"
+                                      "both videos (up to 10 s), so decoding starts right away instead of discarding\n"
+                                      "frames. Each file's keyframes are scanned once without decoding and cached.");
+    timeLayout->addWidget(snapKeyframesCheckbox);
+
+    // Lossless proxy of the original for repeated comparisons
+    referenceCacheCheckbox = new QCheckBox("Cache decoded original (lossless FFV1 proxy)", this);
+    referenceCacheCheckbox->setToolTip("The first full-length comparison stores the decoded original as FFV1 on disk;\n"
+                                       "later comparisons against it read the proxy instead of decoding the master.\n"
+                                       "Size limit and clearing: Settings > Reference Cache.");
+    timeLayout->addWidget(referenceCacheCheckbox);
+
+    // Per-stage timing
+    stageTimingCheckbox = new QCheckBox("Record per-stage timing (-benchmark_all)", this);
+    stageTimingCheckbox->setToolTip("Break decode and encode time down per input. Adds several log lines per frame to ffmpeg's output.");
+    timeLayout->addWidget(stageTimingCheckbox);
+
+    // Proxy scoring
+    QHBoxLayout *proxyLayout = new QHBoxLayout();
+    proxyCheckbox = new QCheckBox("Fast proxy scoring (640x360)", this);
+    proxyCheckbox->setToolTip("Scale both videos to 640x360 right after decoding for quick triage.\n"
+                              "Scores are approximate and not comparable to full-resolution results.");
+    proxyVmafCheckbox = new QCheckBox("Include VMAF (phone model)", this);
+    proxyVmafCheckbox->setEnabled(false);
+    proxyLayout->addWidget(proxyCheckbox);
+    proxyLayout->addWidget(proxyVmafCheckbox);
+    proxyLayout->addStretch();
+    timeLayout->addLayout(proxyLayout);
+
+    // Automatic letterbox/pillarbox cropping
+    autoCropCheckbox = new QCheckBox("Crop black bars automatically", this);
+    autoCropCheckbox->setToolTip("Run cropdetect on a few samples of the original first and crop the bars it finds\n"
+                                 "from both videos, so letterboxed content is scored on the picture only.");
+    timeLayout->addWidget(autoCropCheckbox);
+
+    // Identical-stream fast path
+    QHBoxLayout *hashLayout = new QHBoxLayout();
+    hashCheckbox = new QCheckBox("Skip scoring identical streams (packet hash)", this);
+    hashCheckbox->setToolTip("Hash the compressed video packets of both videos first (no decoding).\n"
+                             "A remux or copy of the original gets perfect scores in seconds.");
+    hashFramesCheckbox = new QCheckBox("Also compare decoded frames", this);
+    hashFramesCheckbox->setToolTip("If the packets differ, hash the decoded frames too. This decodes both\n"
+                                   "videos but skips the metrics.");
+    hashFramesCheckbox->setEnabled(false);
+    hashLayout->addWidget(hashCheckbox);
+    hashLayout->addWidget(hashFramesCheckbox);
+    hashLayout->addStretch();
+    timeLayout->addLayout(hashLayout);
+
+    // Extra metrics, computed by the same libvmaf filter as VMAF
+    QHBoxLayout *extraLayout = new QHBoxLayout();
+    extraLayout->addWidget(new QLabel("Extra metrics (libvmaf):", this));
+    for (const ExtraMetric& metric : MetricSet::available()) {
+        QCheckBox *box = new QCheckBox(metric.label, this);
+        box->setProperty("metricId", metric.id);
+        box->setToolTip(QString("Adds libvmaf's %1 feature extractor to the VMAF pass; no extra decode.\n"
+                                "Requires a libvmaf build that includes it.").arg(metric.feature));
+        extraMetricCheckboxes << box;
+        extraLayout->addWidget(box);
+    }
+    extraLayout->addStretch();
+    timeLayout->addLayout(extraLayout);
+
+    // Quality gates
+    QHBoxLayout *gatesLayout = new QHBoxLayout();
+    gatesLayout->addWidget(new QLabel("Quality gates:", this));
+    gatesEdit = new QLineEdit(this);
+    gatesEdit->setPlaceholderText("e.g. vmaf >= 93; ssim window 2s >= 0.95; psnr frame >= 30");
+    gatesEdit->setToolTip("Pass/fail rules separated by ';'. \"<metric> >= x\" checks the overall score,\n"
+                          "\"<metric> window Ns >= x\" every N-second window, \"<metric> frame >= x\" every frame.\n"
+                          "SSIM and PSNR rules are checked while the comparison runs, which stops as soon\n"
+                          "as a rule can no longer pass; VMAF rules are checked when it finishes.");
+    gatesLayout->addWidget(gatesEdit);
+    timeLayout->addLayout(gatesLayout);
+    
     mainLayout->addWidget(timeGroup);
     
     // Run button
@@ -187,6 +413,12 @@ void VerifyTab::setupUI() {
     progressBar->setTextVisible(true);
     mainLayout->addWidget(progressBar);
     
+    // Quality-gate verdict
+    gateLabel = new QLabel(this);
+    gateLabel->setWordWrap(true);
+    gateLabel->setVisible(false);
+    mainLayout->addWidget(gateLabel);
+    
     // Results Group
     resultsGroup = new QGroupBox("Comprehensive Quality Analysis Results", this);
     resultsGroup->setVisible(false);
@@ -275,7 +507,91 @@ void VerifyTab::setupUI() {
     vmafLayout->addWidget(vmafScoreLabel);
     
     resultsLayout->addLayout(vmafLayout);
+
+    // Extra libvmaf metrics; hidden unless the run computed some
+    extraHeader = new QLabel("<b>Additional metrics</b> - from the same libvmaf pass (CAMBI: banding, lower is better)", this);
+    extraHeader->setStyleSheet("QLabel { color: #555; font-size: 9pt; padding: 5px; background-color: #f3e5f5; border-radius: 3px; margin-top: 10px; }");
+    extraHeader->setVisible(false);
+    resultsLayout->addWidget(extraHeader);
+    extraMetricsLabel = new QLabel(this);
+    extraMetricsLabel->setStyleSheet("QLabel { font-size: 12pt; font-weight: bold; padding: 8px; background-color: #f3e5f5; border-radius: 5px; }");
+    extraMetricsLabel->setAlignment(Qt::AlignCenter);
+    extraMetricsLabel->setVisible(false);
+    resultsLayout->addWidget(extraMetricsLabel);
     mainLayout->addWidget(resultsGroup);
+
+    // Multi-file results table
+    multiResultsGroup = new QGroupBox("Per-File Results", this);
+    multiResultsGroup->setVisible(false);
+    QVBoxLayout *multiLayout = new QVBoxLayout(multiResultsGroup);
+    multiResultsTable = new QTableWidget(this);
+    multiResultsTable->setColumnCount(6);
+    multiResultsTable->setHorizontalHeaderLabels({"File", "SSIM", "PSNR (dB)", "VMAF", "Gate", "Other"});
+    multiResultsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    multiResultsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    multiLayout->addWidget(multiResultsTable);
+    mainLayout->addWidget(multiResultsGroup);
+
+    // Per-frame timeline
+    timelineGroup = new QGroupBox("Per-Frame Timeline", this);
+    timelineGroup->setVisible(false);
+    QVBoxLayout *timelineLayout = new QVBoxLayout(timelineGroup);
+    QHBoxLayout *timelineControls = new QHBoxLayout();
+    timelineControls->addWidget(new QLabel("Metric:", this));
+    timelineMetricCombo = new QComboBox(this);
+    timelineMetricCombo->addItem("SSIM", FrameMetrics::Ssim);
+    timelineMetricCombo->addItem("PSNR", FrameMetrics::Psnr);
+    timelineMetricCombo->addItem("VMAF", FrameMetrics::Vmaf);
+    timelineMetricCombo->setCurrentIndex(2);
+    timelineControls->addWidget(timelineMetricCombo);
+    timelineControls->addWidget(new QLabel("Bit rate:", this));
+    frameTrackCombo = new QComboBox(this);
+    frameTrackCombo->addItem("Off");
+    frameTrackCombo->addItem("Packets (fast)");
+    frameTrackCombo->addItem("Frames (I/P/B, decodes)");
+    frameTrackCombo->setToolTip("Per-frame size and keyframes of the comparison file, drawn under the metric");
+    timelineControls->addWidget(frameTrackCombo);
+    QLabel *timelineHint = new QLabel("Wheel to zoom, drag to pan, double-click to reset, click to pick a frame", this);
+    timelineHint->setStyleSheet("QLabel { color: #777; font-size: 8pt; }");
+    timelineControls->addWidget(timelineHint);
+    timelineControls->addStretch();
+    extractFramesBtn = new QPushButton("Extract Frames", this);
+    extractFramesBtn->setEnabled(false);
+    extractFramesBtn->setToolTip("Show the reference and comparison frame side by side");
+    timelineControls->addWidget(extractFramesBtn);
+    timelineLayout->addLayout(timelineControls);
+
+    QHBoxLayout *timelineBody = new QHBoxLayout();
+    timeline = new QualityTimeline(this);
+    timelineBody->addWidget(timeline, 3);
+    worstSegmentsList = new QListWidget(this);
+    worstSegmentsList->setToolTip("Lowest-scoring windows; click to zoom in");
+    worstSegmentsList->setMaximumWidth(260);
+    timelineBody->addWidget(worstSegmentsList, 1);
+    timelineLayout->addLayout(timelineBody);
+    mainLayout->addWidget(timelineGroup);
+
+    // Job statistics
+    statsGroup = new QGroupBox("Job Statistics", this);
+    statsGroup->setVisible(false);
+    QVBoxLayout *statsLayout = new QVBoxLayout(statsGroup);
+    QHBoxLayout *statsHeader = new QHBoxLayout();
+    statsSummaryLabel = new QLabel(this);
+    statsSummaryLabel->setWordWrap(true);
+    statsSummaryLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    statsHeader->addWidget(statsSummaryLabel, 1);
+    exportTraceBtn = new QPushButton("Export Chrome Trace...", this);
+    exportTraceBtn->setToolTip("Save a trace-event JSON file for chrome://tracing or Perfetto");
+    statsHeader->addWidget(exportTraceBtn, 0, Qt::AlignTop);
+    statsLayout->addLayout(statsHeader);
+    statsTable = new QTableWidget(this);
+    statsTable->setColumnCount(5);
+    statsTable->setHorizontalHeaderLabels({"Stage", "Calls", "User (s)", "System (s)", "Real (s)"});
+    statsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    statsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    statsTable->setMaximumHeight(180);
+    statsLayout->addWidget(statsTable);
+    mainLayout->addWidget(statsGroup);
     
     // Add spacing
     mainLayout->addSpacing(10);
@@ -293,9 +609,262 @@ void VerifyTab::setupUI() {
     // Connect signals
     connect(originalFileBtn, &QPushButton::clicked, this, &VerifyTab::selectOriginalFile);
     connect(comparisonFileBtn, &QPushButton::clicked, this, &VerifyTab::selectComparisonFile);
+    // Typed inputs (URLs, pipes) are read in place; nothing is downloaded first
+    connect(originalFileEdit, &QLineEdit::editingFinished, this, [this]() {
+        if (originalFileEdit->isModified()) setOriginalInput(originalFileEdit->text().trimmed());
+        originalFileEdit->setModified(false);
+    });
+    connect(comparisonFileEdit, &QLineEdit::editingFinished, this, [this]() {
+        if (comparisonFileEdit->isModified()) setComparisonInputs(QStringList{comparisonFileEdit->text().trimmed()});
+        comparisonFileEdit->setModified(false);
+    });
     connect(runBtn, &QPushButton::clicked, this, &VerifyTab::runComparison);
     connect(useStartTimeCheckbox, &QCheckBox::toggled, startTimeEdit, &QLineEdit::setEnabled);
     connect(useDurationCheckbox, &QCheckBox::toggled, durationEdit, &QLineEdit::setEnabled);
+    connect(useWindowsCheckbox, &QCheckBox::toggled, this, [this](bool checked) {
+        windowsEdit->setEnabled(checked);
+        useStartTimeCheckbox->setEnabled(!checked);
+        useDurationCheckbox->setEnabled(!checked);
+        startTimeEdit->setEnabled(!checked && useStartTimeCheckbox->isChecked());
+        durationEdit->setEnabled(!checked && useDurationCheckbox->isChecked());
+    });
+    connect(proxyCheckbox, &QCheckBox::toggled, proxyVmafCheckbox, &QCheckBox::setEnabled);
+    connect(hashCheckbox, &QCheckBox::toggled, hashFramesCheckbox, &QCheckBox::setEnabled);
+
+    connect(multiResultsTable, &QTableWidget::currentCellChanged, this, [this](int row) {
+        if (row >= 0 && row < m_frameMetrics.size() && !m_frameMetrics[row].isEmpty()) showTimeline(row);
+    });
+    connect(timelineMetricCombo, &QComboBox::currentIndexChanged, this, [this]() {
+        timeline->setMetric(static_cast<FrameMetrics::Metric>(timelineMetricCombo->currentData().toInt()));
+        updateWorstSegments();
+    });
+    connect(worstSegmentsList, &QListWidget::itemClicked, this, [this](QListWidgetItem *item) {
+        const int first = item->data(Qt::UserRole).toInt();
+        const int count = item->data(Qt::UserRole + 1).toInt();
+        const int worst = item->data(Qt::UserRole + 2).toInt();
+        timeline->zoomTo(first, count);
+        selectFrame(worst);
+    });
+    connect(timeline, &QualityTimeline::frameClicked, this, &VerifyTab::selectFrame);
+    connect(frameTrackCombo, &QComboBox::currentIndexChanged, this, [this]() {
+        // A different mode reads again
+        m_frameTracks = QVector<FrameTrack>(m_frameMetrics.size());
+        startFrameTrack();
+    });
+    connect(frameTrackProbe, &FrameTrackProbe::finished, this, [this](bool success) {
+        const int index = m_frameTrackIndex;
+        m_frameTrackIndex = -1;
+        if (index < 0 || index >= m_frameTracks.size()) return;
+        if (!success) {
+            outputText->append("Could not read the bit rate track of " + QFileInfo(rowFile(index)).fileName());
+            return;
+        }
+        m_frameTracks[index] = frameTrackProbe->track();
+        const FrameTrack& track = m_frameTracks[index];
+        const QVector<int> gops = track.gopLengths();
+        if (!gops.isEmpty()) {
+            const double mean = std::accumulate(gops.begin(), gops.end(), 0.0) / gops.size();
+            outputText->append(QString("%1: %2 frames, %3 keyframes, GOP mean %4 / max %5 frames")
+                .arg(QFileInfo(rowFile(index)).fileName()).arg(track.frameCount()).arg(gops.size() + 1)
+                .arg(mean, 0, 'f', 1).arg(*std::max_element(gops.begin(), gops.end())));
+        }
+        if (index == m_timelineIndex) {
+            timeline->setFrameTrack(track);
+            updateWorstSegments();
+        }
+    });
+    connect(extractFramesBtn, &QPushButton::clicked, this, [this]() { extractFrames(m_selectedFrame); });
+    connect(exportTraceBtn, &QPushButton::clicked, this, &VerifyTab::exportTrace);
+}
+
+void VerifyTab::showStats(const JobStats& stats) {
+    m_lastStats = stats;
+    auto seconds = [](double s) { return QString::number(s, 'f', 2) + " s"; };
+
+    QStringList lines;
+    lines << QString("Wall %1 (queued %2, startup %3, processing %4, finalize %5, reading logs %6)")
+                 .arg(seconds(stats.wallSeconds), seconds(stats.queuedSeconds), seconds(stats.startupSeconds),
+                      seconds(stats.processingSeconds), seconds(stats.finalizeSeconds), seconds(stats.postSeconds));
+    QStringList usage;
+    usage << QString("%1 threads granted").arg(stats.threads);
+    if (stats.frames > 0)
+        usage << QString("%1 frames at %2 fps").arg(stats.frames).arg(stats.framesPerSecond(), 0, 'f', 1);
+    if (stats.cpuSeconds() >= 0) {
+        usage << "CPU " + seconds(stats.cpuSeconds());
+        if (stats.wallSeconds > 0)
+            usage << QString("%1 cores busy on average").arg(stats.cpuSeconds() / stats.wallSeconds, 0, 'f', 1);
+    }
+    if (stats.peakRssKiB() >= 0)
+        usage << QString("peak memory %1 MiB").arg(stats.peakRssKiB() / 1024.0, 0, 'f', 0);
+    lines << usage.join(", ");
+    statsSummaryLabel->setText(lines.join("\n"));
+
+    // Stage rows, plus the CPU the stages don't account for (the filter graph)
+    statsTable->setRowCount(0);
+    auto addRow = [this](const QString& name, const QString& calls, double user, double system, double real) {
+        const int row = statsTable->rowCount();
+        statsTable->insertRow(row);
+        statsTable->setItem(row, 0, new QTableWidgetItem(name));
+        statsTable->setItem(row, 1, new QTableWidgetItem(calls));
+        statsTable->setItem(row, 2, new QTableWidgetItem(user   >= 0 ? QString::number(user,   'f', 3) : "--"));
+        statsTable->setItem(row, 3, new QTableWidgetItem(system >= 0 ? QString::number(system, 'f', 3) : "--"));
+        statsTable->setItem(row, 4, new QTableWidgetItem(real   >= 0 ? QString::number(real,   'f', 3) : "--"));
+    };
+    for (const StageTiming& t : stats.stages)
+        addRow(t.name, QString::number(t.calls), t.userSeconds, t.systemSeconds, t.realSeconds);
+    if (stats.unattributedCpuSeconds() >= 0)
+        addRow("filters (scale/ssim/psnr/libvmaf) and other", "", stats.unattributedCpuSeconds(), -1, -1);
+    statsTable->setVisible(statsTable->rowCount() > 0);
+
+    // Remote jobs report totals only; the trace lives on the server
+    exportTraceBtn->setEnabled(!stats.events.isEmpty());
+    statsGroup->setVisible(true);
+}
+
+void VerifyTab::exportTrace() {
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Chrome Trace", "vidmetric-trace.json",
+                                                    "Trace JSON (*.json);;All Files (*.*)");
+    if (fileName.isEmpty()) return;
+    QString error;
+    if (!m_lastStats.writeChromeTrace(fileName, &error))
+        QMessageBox::warning(this, "Export Failed", "Could not write the trace:\n" + error);
+}
+
+void VerifyTab::selectFrame(int frame) {
+    m_selectedFrame = frame;
+    const FrameMetrics& metrics = m_frameMetrics[m_timelineIndex];
+    extractFramesBtn->setText(QString("Extract Frames @ %1")
+        .arg(QTime(0, 0).addMSecs(int(metrics.timeOfFrame(frame) * 1000)).toString("HH:mm:ss.zzz")));
+    extractFramesBtn->setEnabled(true);
+}
+
+void VerifyTab::showTimeline(int index) {
+    m_timelineIndex = index;
+    m_selectedFrame = -1;
+    extractFramesBtn->setText("Extract Frames");
+    extractFramesBtn->setEnabled(false);
+    timeline->setMetric(static_cast<FrameMetrics::Metric>(timelineMetricCombo->currentData().toInt()));
+    timeline->setMetrics(m_frameMetrics[index]);
+    const QString window = m_windows.isEmpty() ? QString() : " @ " + m_windows.value(index).label();
+    timelineGroup->setTitle(QString("Per-Frame Timeline - %1%2").arg(QFileInfo(rowFile(index)).fileName(), window));
+    timelineGroup->setVisible(true);
+    if (index < m_frameTracks.size() && !m_frameTracks[index].isEmpty()) timeline->setFrameTrack(m_frameTracks[index]);
+    updateWorstSegments();
+    startFrameTrack();
+}
+
+void VerifyTab::startFrameTrack() {
+    const int index = m_timelineIndex;
+    if (frameTrackCombo->currentIndex() == 0 || index < 0 || index >= m_frameTracks.size()) {
+        frameTrackProbe->cancel();
+        m_frameTrackIndex = -1;
+        if (index >= 0 && index < m_frameTracks.size() && m_frameTracks[index].isEmpty()) timeline->setFrameTrack(FrameTrack());
+        return;
+    }
+    if (!m_frameTracks[index].isEmpty() || (m_frameTrackIndex == index && frameTrackProbe->isRunning())) return;
+    if (VideoUtils::isPipe(rowFile(index))) {
+        outputText->append("No bit rate track: " + rowFile(index) + " is a pipe and has already been read.");
+        return;
+    }
+
+    // Same range of the comparison file that was scored, so frame i lines up with the series
+    const FrameMetrics& metrics = m_frameMetrics[index];
+    const double duration = metrics.frameRate > 0 ? metrics.frameCount() / metrics.frameRate : 0;
+    m_frameTrackIndex = index;
+    frameTrackProbe->start(rowFile(index), metrics.startTime, duration,
+                           static_cast<FrameTrackProbe::Mode>(frameTrackCombo->currentIndex() - 1));
+}
+
+void VerifyTab::updateWorstSegments() {
+    worstSegmentsList->clear();
+    if (m_timelineIndex < 0) return;
+    const FrameMetrics& metrics = m_frameMetrics[m_timelineIndex];
+    const QVector<float>& values = metrics.series(timeline->metric());
+
+    // Two-second windows, or 48 frames when the frame rate is unknown
+    const int window = metrics.frameRate > 0 ? qMax(1, int(metrics.frameRate * 2)) : 48;
+    const QList<FrameSegment> worst = FrameMetricsIO::worstSegments(values, window, 5);
+    const int decimals = timeline->metric() == FrameMetrics::Ssim ? 4 : 2;
+    auto timeText = [&metrics](int frame) {
+        return QTime(0, 0).addMSecs(int(metrics.timeOfFrame(frame) * 1000)).toString("HH:mm:ss");
+    };
+
+    for (const FrameSegment& s : worst) {
+        // Drill-down target: the single lowest frame inside the window
+        int worstFrame = s.firstFrame;
+        for (int f = s.firstFrame; f < s.firstFrame + s.frameCount; ++f)
+            if (values[f] < values[worstFrame]) worstFrame = f;
+
+        QString text = QString("%1 - %2   mean %3, min %4")
+            .arg(timeText(s.firstFrame), timeText(s.firstFrame + s.frameCount))
+            .arg(s.mean, 0, 'f', decimals)
+            .arg(values[worstFrame], 0, 'f', decimals);
+        if (m_timelineIndex < m_frameTracks.size() && !m_frameTracks[m_timelineIndex].isEmpty() && metrics.frameRate > 0)
+            text += QString(", %1 kbps").arg(m_frameTracks[m_timelineIndex].bitrateKbps(
+                s.firstFrame, s.firstFrame + s.frameCount, metrics.frameRate), 0, 'f', 0);
+        QListWidgetItem *item = new QListWidgetItem(text);
+        item->setData(Qt::UserRole, s.firstFrame);
+        item->setData(Qt::UserRole + 1, s.frameCount);
+        item->setData(Qt::UserRole + 2, worstFrame);
+        worstSegmentsList->addItem(item);
+    }
+    timeline->setHighlights(worst);
+}
+
+void VerifyTab::extractFrames(int frame) {
+    if (m_timelineIndex < 0 || frame < 0) return;
+    const FrameMetrics& metrics = m_frameMetrics[m_timelineIndex];
+    const double seconds = metrics.timeOfFrame(frame);
+    const QString at = QString::number(seconds, 'f', 3);
+    const QString comparisonFile = rowFile(m_timelineIndex);
+    if (VideoUtils::isPipe(originalFileEdit->text()) || VideoUtils::isPipe(comparisonFile)) {
+        outputText->append("Frame extraction needs to seek; a named pipe has already been read to the end.");
+        return;
+    }
+
+    // Reference left, comparison (scaled to the reference size) right, as one PNG on stdout
+    QStringList arguments;
+    arguments << "-hide_banner" << "-loglevel" << "error"
+              << "-ss" << at << VideoUtils::inputOptions(originalFileEdit->text()) << "-i" << originalFileEdit->text()
+              << "-ss" << at << VideoUtils::inputOptions(comparisonFile) << "-i" << comparisonFile
+              << "-filter_complex" << "[1:v][0:v]scale2ref[d][r];[r]format=rgb24[rf];[d]format=rgb24[df];[rf][df]hstack"
+              << "-frames:v" << "1" << "-f" << "image2pipe" << "-c:v" << "png" << "-";
+
+    extractFramesBtn->setEnabled(false);
+    QProcess *process = new QProcess(this);
+    connect(process, &QProcess::finished, this, [this, process, seconds, comparisonFile](int exitCode) {
+        process->deleteLater();
+        extractFramesBtn->setEnabled(true);
+        QPixmap pixmap;
+        if (exitCode != 0 || !pixmap.loadFromData(process->readAllStandardOutput(), "PNG")) {
+            outputText->append("Frame extraction failed: " +
+                               QString::fromLocal8Bit(process->readAllStandardError()).trimmed());
+            return;
+        }
+
+        QDialog *dialog = new QDialog(this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->setWindowTitle(QString("%1 vs %2 @ %3")
+            .arg(QFileInfo(originalFileEdit->text()).fileName(), QFileInfo(comparisonFile).fileName(),
+                 QTime(0, 0).addMSecs(int(seconds * 1000)).toString("HH:mm:ss.zzz")));
+        QVBoxLayout *layout = new QVBoxLayout(dialog);
+        QScrollArea *scroll = new QScrollArea(dialog);
+        QLabel *image = new QLabel(scroll);
+        image->setPixmap(pixmap);
+        scroll->setWidget(image);
+        layout->addWidget(new QLabel("Left: original    Right: comparison", dialog));
+        layout->addWidget(scroll);
+        dialog->resize(qMin(pixmap.width() + 40, 1600), qMin(pixmap.height() + 80, 900));
+        dialog->show();
+    });
+    // ffmpeg missing or not executable: no finished() follows
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) return;
+        outputText->append("Frame extraction failed: could not start ffmpeg: " + process->errorString());
+        extractFramesBtn->setEnabled(true);
+        process->deleteLater();
+    });
+    process->start("ffmpeg", arguments);
 }
 
 void VerifyTab::selectOriginalFile() {
@@ -304,48 +873,68 @@ void VerifyTab::selectOriginalFile() {
         "",
         "Video Files (*.mp4 *.avi *.mkv *.mov *.wmv *.flv);;All Files (*.*)");
     
-    if (!fileName.isEmpty()) {
-        if (!VideoUtils::isValidVideoFile(fileName)) {
-            QMessageBox::warning(this, "Invalid File", 
-                "Please select a valid video file (MP4, AVI, MKV, MOV, WMV, or FLV).");
-            return;
-        }
-        
-        originalFileEdit->setText(fileName);
-        
-        // Get and display resolution
-        QString resolution = VideoUtils::getVideoResolution(fileName);
-        if (!resolution.isEmpty()) {
-            originalResolutionLabel->setText(resolution);
-        } else {
-            originalResolutionLabel->setText("(unknown)");
-        }
+    if (!fileName.isEmpty()) setOriginalInput(fileName);
+}
+
+void VerifyTab::setOriginalInput(const QString& input) {
+    if (!input.isEmpty() && !VideoUtils::isValidVideoFile(input)) {
+        QMessageBox::warning(this, "Invalid File", 
+            "Please select a valid video file (MP4, AVI, MKV, MOV, WMV, or FLV), URL or named pipe.");
+        originalFileEdit->clear();
+        originalResolutionLabel->clear();
+        return;
     }
+    
+    originalFileEdit->setText(input);
+    originalResolutionLabel->setText(resolutionText(input));
+}
+
+QString VerifyTab::inputsLabel(const QStringList& inputs) {
+    if (inputs.size() <= 1) return inputs.value(0);
+    QStringList names;
+    for (const QString& fileName : inputs) names << QFileInfo(fileName).fileName();
+    return QString("%1 files: %2").arg(inputs.size()).arg(names.join("; "));
+}
+
+// Resolution label of an input; pipes are not probed, since that would consume them
+QString VerifyTab::resolutionText(const QString& input) {
+    if (input.isEmpty()) return QString();
+    if (VideoUtils::isPipe(input)) return "(pipe)";
+    const QString resolution = VideoUtils::getVideoResolution(input);
+    return resolution.isEmpty() ? QString("(unknown)") : resolution;
 }
 
 void VerifyTab::selectComparisonFile() {
-    QString fileName = QFileDialog::getOpenFileName(this,
-        "Select Comparison Media File",
+    // Several files may be selected: they are all scored against one decode of the original
+    QStringList fileNames = QFileDialog::getOpenFileNames(this,
+        "Select Comparison Media File(s)",
         "",
         "Video Files (*.mp4 *.avi *.mkv *.mov *.wmv *.flv);;All Files (*.*)");
     
-    if (!fileName.isEmpty()) {
-        if (!VideoUtils::isValidVideoFile(fileName)) {
+    if (!fileNames.isEmpty()) setComparisonInputs(fileNames);
+}
+
+void VerifyTab::setComparisonInputs(const QStringList& inputs) {
+    if (inputs.value(0).isEmpty()) {
+        m_comparisonFiles.clear();
+        comparisonFileEdit->clear();
+        comparisonResolutionLabel->clear();
+        return;
+    }
+    for (const QString& input : inputs) {
+        if (!VideoUtils::isValidVideoFile(input)) {
             QMessageBox::warning(this, "Invalid File", 
-                "Please select a valid video file (MP4, AVI, MKV, MOV, WMV, or FLV).");
+                "Please select a valid video file (MP4, AVI, MKV, MOV, WMV, or FLV), URL or named pipe.");
+            comparisonFileEdit->setText(inputsLabel(m_comparisonFiles));   // back to the previous selection
             return;
         }
-        
-        comparisonFileEdit->setText(fileName);
-        
-        // Get and display resolution
-        QString resolution = VideoUtils::getVideoResolution(fileName);
-        if (!resolution.isEmpty()) {
-            comparisonResolutionLabel->setText(resolution);
-        } else {
-            comparisonResolutionLabel->setText("(unknown)");
-        }
     }
+    
+    m_comparisonFiles = inputs;
+    comparisonFileEdit->setText(inputsLabel(inputs));
+    
+    // Resolution of the first input when several are selected
+    comparisonResolutionLabel->setText(resolutionText(inputs.first()));
 }
 
 bool VerifyTab::validateInputs() {
@@ -354,11 +943,32 @@ bool VerifyTab::validateInputs() {
         return false;
     }
     
-    if (comparisonFileEdit->text().isEmpty()) {
+    if (m_comparisonFiles.isEmpty()) {
         QMessageBox::warning(this, "Validation Error", "Please select a comparison media file.");
         return false;
     }
     
+    if (useWindowsCheckbox->isChecked()) {
+        QString windowError;
+        TimeWindow::parseList(windowsEdit->text(), &windowError);
+        if (!windowError.isEmpty()) {
+            QMessageBox::warning(this, "Validation Error", windowError +
+                ".\nUse windows like \"00:12:00+60\" or \"00:12:00-00:13:00\", separated by ','.");
+            return false;
+        }
+        if (m_comparisonFiles.size() != 1) {
+            QMessageBox::warning(this, "Validation Error",
+                "Time windows are scored on a single comparison file.");
+            return false;
+        }
+        if (VideoUtils::isPipe(originalFileEdit->text()) || VideoUtils::isPipe(m_comparisonFiles.first())) {
+            QMessageBox::warning(this, "Validation Error",
+                "Time windows seek into the inputs once per window; a named pipe can only be read once.");
+            return false;
+        }
+        return validateGates();
+    }
+    
     // Validate time format
     QRegularExpression timeRegex("^\\d{2}:\\d{2}:\\d{2}$");
     
@@ -378,9 +988,46 @@ bool VerifyTab::validateInputs() {
         }
     }
     
+    return validateGates();
+}
+
+bool VerifyTab::validateGates() {
+    QString gateError;
+    QualityGate::parse(gatesEdit->text(), &gateError);
+    if (!gateError.isEmpty()) {
+        QMessageBox::warning(this, "Validation Error", gateError +
+            ".\nUse rules like \"vmaf >= 93\", \"vmaf window 2s >= 80\" or \"ssim frame >= 0.9\", separated by ';'.");
+        return false;
+    }
     return true;
 }
 
+QString VerifyTab::rowFile(int row) const {
+    return m_windows.isEmpty() ? m_comparisonFiles.value(row) : m_comparisonFiles.value(0);
+}
+
+void VerifyTab::showGateVerdicts(bool stoppedEarly) {
+    QStringList failures;
+    bool checked = false;
+    for (const ComparisonResult& r : std::as_const(m_multiResults)) {
+        if (!r.hasGate) continue;
+        checked = true;
+        const QString name = r.window.isEmpty() ? QFileInfo(r.file).fileName() : r.window;
+        if (!r.gatePassed) failures << name + ": " + r.gateDetail;
+    }
+    if (!checked) return;
+    const QString style = "QLabel { font-size: 11pt; font-weight: bold; padding: 8px; border-radius: 5px; ";
+    if (failures.isEmpty()) {
+        gateLabel->setText("Quality gates: PASS");
+        gateLabel->setStyleSheet(style + "background-color: #4caf50; color: white; }");
+    } else {
+        gateLabel->setText(QString("Quality gates: FAIL%1\n%2")
+                           .arg(stoppedEarly ? " (stopped early)" : "", failures.join("\n")));
+        gateLabel->setStyleSheet(style + "background-color: #f44336; color: white; }");
+    }
+    gateLabel->setVisible(true);
+}
+
 void VerifyTab::runComparison() {
     if (!validateInputs()) return;
 
@@ -390,10 +1037,67 @@ void VerifyTab::runComparison() {
     progressBar->setValue(0);
     progressBar->setVisible(true);
     resultsGroup->setVisible(false);
+    gateLabel->setVisible(false);
+    multiResultsGroup->setVisible(false);
+    timelineGroup->setVisible(false);
+    statsGroup->setVisible(false);
+    timeline->clear();
+
+    // Clear summary values so a metric skipped this run (e.g. VMAF in proxy mode)
+    // doesn't carry over into the history entry
+    resultAllLabel->setText("Overall: --");
+    psnrAvgLabel->setText("Average: --");
+    vmafScoreLabel->setText("VMAF Score: --");
+    extraHeader->setVisible(false);
+    extraMetricsLabel->setVisible(false);
+    const bool proxy = proxyCheckbox->isChecked();
+    ffmpegJob->setProxyMode(proxy, QSize(640, 360), proxyVmafCheckbox->isChecked());
+    const QString proxyNote = proxy ? QString(" - PROXY %1, for triage only").arg(ffmpegJob->proxyLabel()) : QString();
+    resultsGroup->setTitle("Comprehensive Quality Analysis Results" + proxyNote);
+    m_windows = useWindowsCheckbox->isChecked() ? TimeWindow::parseList(windowsEdit->text()) : QList<TimeWindow>();
+    const int rows = m_windows.isEmpty() ? int(m_comparisonFiles.size()) : int(m_windows.size());
+    multiResultsGroup->setTitle((m_windows.isEmpty() ? "Per-File Results" : "Per-Window Results") + proxyNote);
+    multiResultsTable->setHorizontalHeaderItem(0, new QTableWidgetItem(m_windows.isEmpty() ? "File" : "Window"));
+    worstSegmentsList->clear();
+    m_frameMetrics = QVector<FrameMetrics>(rows);
+    frameTrackProbe->cancel();
+    m_frameTrackIndex = -1;
+    m_frameTracks = QVector<FrameTrack>(rows);
+    m_frameArchives = QStringList();
+    for (int i = 0; i < rows; ++i) m_frameArchives << QString();
+    m_timelineIndex = -1;
 
-    ffmpegJob->start(
+    // Prepare one table row per comparison file (or window)
+    m_multiResults = QVector<ComparisonResult>(rows);
+    multiResultsTable->setRowCount(rows);
+    for (int i = 0; i < rows; ++i) {
+        const QString name = m_windows.isEmpty() ? QFileInfo(m_comparisonFiles[i]).fileName() : m_windows[i].label();
+        multiResultsTable->setItem(i, 0, new QTableWidgetItem(name));
+        for (int col = 1; col < 6; ++col)
+            multiResultsTable->setItem(i, col, new QTableWidgetItem("--"));
+    }
+
+    ffmpegJob->setStageTiming(stageTimingCheckbox->isChecked());
+    ffmpegJob->setQualityGates(QualityGate::parse(gatesEdit->text()));
+    QStringList extraMetrics;
+    for (QCheckBox *box : std::as_const(extraMetricCheckboxes))
+        if (box->isChecked()) extraMetrics << box->property("metricId").toString();
+    ffmpegJob->setExtraMetrics(extraMetrics);
+    ffmpegJob->setAutoCrop(autoCropCheckbox->isChecked());
+    ffmpegJob->setSnapToKeyframes(snapKeyframesCheckbox->isChecked());
+    ffmpegJob->setReferenceCache(referenceCacheCheckbox->isChecked());
+    ffmpegJob->setHashCheck(!hashCheckbox->isChecked() ? FfmpegJob::NoHashCheck
+                            : hashFramesCheckbox->isChecked() ? FfmpegJob::PacketAndFrameHash
+                                                              : FfmpegJob::PacketHash);
+    if (!m_windows.isEmpty()) {
+        resultsGroup->setTitle(QString("Comprehensive Quality Analysis Results - %1 windows combined%2")
+                               .arg(m_windows.size()).arg(proxyNote));
+        ffmpegJob->startWindows(originalFileEdit->text(), m_comparisonFiles.first(), m_windows);
+        return;
+    }
+    ffmpegJob->startMulti(
         originalFileEdit->text(),
-        comparisonFileEdit->text(),
+        m_comparisonFiles,
         useStartTimeCheckbox->isChecked() ? startTimeEdit->text() : QString(),
         useDurationCheckbox ->isChecked() ? durationEdit ->text() : QString()
     );
@@ -9,25 +9,52 @@
 #include <QProgressBar>
 #include <QGroupBox>
 #include <QTextEdit>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QListWidget>
+#include <QStringList>
+#include <QVector>
 #include "FfmpegJob.h"
+#include "FrameTrack.h"
+
+class QualityTimeline;
 
 class VerifyTab : public QWidget {
     Q_OBJECT
 
 public:
     explicit VerifyTab(QWidget *parent = nullptr);
+    // Routes jobs to a JobServer; nullptr runs them on this machine
+    void setRemoteClient(JobClient *client);
 
 signals:
-    void comparisonCompleted(const QString& type, const QString& details, const QString& result);
+    // frameArchive: per-frame data for this result (FrameArchive file), or empty
+    void comparisonCompleted(const QString& type, const QString& details, const QString& result,
+                             const QString& frameArchive);
 
 private slots:
     void selectOriginalFile();
     void selectComparisonFile();
     void runComparison();
+    void showTimeline(int index);
+    void updateWorstSegments();
+    void startFrameTrack();
+    void selectFrame(int frame);
+    void extractFrames(int frame);
+    void showStats(const JobStats& stats);
+    void exportTrace();
+    void showGateVerdicts(bool stoppedEarly);
 
 private:
     void setupUI();
     bool validateInputs();
+    bool validateGates();
+    void setOriginalInput(const QString& input);
+    void setComparisonInputs(const QStringList& inputs);
+    static QString inputsLabel(const QStringList& inputs);
+    static QString resolutionText(const QString& input);
+    // Distorted file scored in table row `row` (the one file of a windowed run)
+    QString rowFile(int row) const;
 
     QLineEdit *originalFileEdit;
     QLineEdit *comparisonFileEdit;
@@ -40,6 +67,19 @@ private:
     QLineEdit *startTimeEdit;
     QCheckBox *useDurationCheckbox;
     QLineEdit *durationEdit;
+    QCheckBox *useWindowsCheckbox;
+    QLineEdit *windowsEdit;
+    QCheckBox *stageTimingCheckbox;
+    QCheckBox *proxyCheckbox;
+    QCheckBox *proxyVmafCheckbox;
+    QCheckBox *autoCropCheckbox;
+    QCheckBox *snapKeyframesCheckbox;
+    QCheckBox *referenceCacheCheckbox;
+    QCheckBox *hashCheckbox;
+    QCheckBox *hashFramesCheckbox;
+    QList<QCheckBox*> extraMetricCheckboxes;   // one per MetricSet::available() entry
+    QLineEdit *gatesEdit;
+    QLabel *gateLabel;
     
     QPushButton *runBtn;
     QProgressBar *progressBar;
@@ -49,6 +89,37 @@ private:
     QLabel *resultYLabel, *resultULabel, *resultVLabel, *resultAllLabel;
     QLabel *psnrYLabel, *psnrULabel, *psnrVLabel, *psnrAvgLabel;
     QLabel *vmafScoreLabel;
+    QLabel *extraHeader, *extraMetricsLabel;
+
+    // Per-file (or per-window) results when several inputs are scored in one run
+    QGroupBox *multiResultsGroup;
+    QTableWidget *multiResultsTable;
+    QStringList m_comparisonFiles;
+    QVector<ComparisonResult> m_multiResults;
+    QList<TimeWindow> m_windows;   // windows of the current run; rows are windows when set
+
+    // Per-frame timeline of one comparison file (the selected table row)
+    QGroupBox *timelineGroup;
+    QComboBox *timelineMetricCombo;
+    QComboBox *frameTrackCombo;   // off / packets / frames (FrameTrackProbe::Mode + 1)
+    QualityTimeline *timeline;
+    QListWidget *worstSegmentsList;
+    QPushButton *extractFramesBtn;
+    QVector<FrameMetrics> m_frameMetrics;
+    QStringList m_frameArchives;   // per comparison file; empty when not written
+    int m_timelineIndex = -1;
+    int m_selectedFrame = -1;
+    // Bit rate / GOP track per row, read after the run on demand
+    FrameTrackProbe *frameTrackProbe;
+    QVector<FrameTrack> m_frameTracks;
+    int m_frameTrackIndex = -1;   // row the probe is reading
+
+    // Where the last run's time and memory went
+    QGroupBox *statsGroup;
+    QLabel *statsSummaryLabel;
+    QTableWidget *statsTable;
+    QPushButton *exportTraceBtn;
+    JobStats m_lastStats;
     
     QTextEdit *outputText;
     FfmpegJob *ffmpegJob;
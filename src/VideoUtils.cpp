@@ -1,11 +1,20 @@
 #include "VideoUtils.h"
+#include <QFile>
 #include <QFileInfo>
 #include <QProcess>
+#include <QRegularExpression>
+#include <QSettings>
 #include <QStringList>
+#include <QUrl>
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 namespace VideoUtils {
 
 bool isValidVideoFile(const QString& filePath) {
+    if (isStreamInput(filePath)) return true;
+
     // Check file extension
     QStringList validExtensions = {"mp4", "avi", "mkv", "mov", "wmv", "flv", "webm", "mpg", "mpeg", "m4v"};
     QFileInfo fileInfo(filePath);
@@ -14,7 +23,59 @@ bool isValidVideoFile(const QString& filePath) {
     return validExtensions.contains(extension);
 }
 
+bool isUrl(const QString& input) {
+    static const QStringList schemes = {"http", "https", "ftp"};
+    const QUrl url(input);
+    return input.contains("://") && schemes.contains(url.scheme().toLower()) && !url.host().isEmpty();
+}
+
+bool isPipe(const QString& input) {
+#ifdef Q_OS_WIN
+    return input.startsWith("\\\\.\\pipe\\", Qt::CaseInsensitive);
+#else
+    struct stat info;
+    return ::stat(QFile::encodeName(input).constData(), &info) == 0 && S_ISFIFO(info.st_mode);
+#endif
+}
+
+StreamOptions StreamOptions::load() {
+    QSettings settings;
+    StreamOptions options;
+    options.readAheadKiB   = settings.value("streamInput/readAheadKiB", options.readAheadKiB).toInt();
+    options.timeoutSeconds = settings.value("streamInput/timeoutSeconds", options.timeoutSeconds).toInt();
+    options.reconnect      = settings.value("streamInput/reconnect", options.reconnect).toBool();
+    return options;
+}
+
+void StreamOptions::save() const {
+    QSettings settings;
+    settings.setValue("streamInput/readAheadKiB", readAheadKiB);
+    settings.setValue("streamInput/timeoutSeconds", timeoutSeconds);
+    settings.setValue("streamInput/reconnect", reconnect);
+}
+
+QStringList inputOptions(const QString& input) {
+    if (!isUrl(input)) return {};
+    const StreamOptions options = StreamOptions::load();
+    QStringList arguments;
+    if (options.timeoutSeconds > 0)
+        arguments << "-rw_timeout" << QString::number(qint64(options.timeoutSeconds) * 1000000);
+    if (!input.startsWith("http", Qt::CaseInsensitive)) return arguments;
+
+    // Keep-alive, so the range request behind every seek reuses the connection, and
+    // short forward seeks (interleaved audio, B-frame reordering) just read on
+    arguments << "-multiple_requests" << "1"
+              << "-short_seek_size" << QString::number(qint64(options.readAheadKiB) * 1024);
+    if (options.reconnect)
+        arguments << "-reconnect" << "1" << "-reconnect_on_network_error" << "1"
+                  << "-reconnect_delay_max" << QString::number(qMax(1, options.timeoutSeconds / 2));
+    return arguments;
+}
+
 QString getVideoResolution(const QString& filePath) {
+    // Probing a pipe would take the data away from the run that reads it
+    if (isPipe(filePath)) return "";
+
     // Use ffprobe to get video resolution
     QProcess process;
     QStringList arguments;
@@ -23,6 +84,7 @@ QString getVideoResolution(const QString& filePath) {
               << "-select_streams" << "v:0"
               << "-show_entries" << "stream=width,height"
               << "-of" << "csv=s=x:p=0"
+              << inputOptions(filePath)
               << filePath;
     
     process.start("ffprobe", arguments);
@@ -31,7 +93,7 @@ QString getVideoResolution(const QString& filePath) {
         return "";
     }
     
-    if (!process.waitForFinished(5000)) {
+    if (!process.waitForFinished(isUrl(filePath) ? 20000 : 5000)) {
         process.kill();
         return "";
     }
@@ -46,4 +108,102 @@ QString getVideoResolution(const QString& filePath) {
     return "";
 }
 
-} // namespace VideoUtils
\ No newline at end of file
+VideoFormat describePixelFormat(const QString& pixelFormat) {
+    VideoFormat format;
+    format.pixelFormat = pixelFormat;
+    // Planar YUV: yuv420p, yuvj444p, yuv422p10le, ...
+    static QRegularExpression planarRx("^yuvj?(420|422|444)p(\\d+)?(le|be)?$");
+    // Semi-planar (hardware decoders): nv12/nv21, p010le, p216le, p410le, ...
+    static QRegularExpression semiPlanarRx("^p([024])(\\d\\d)(le|be)?$");
+    // Planar RGB: gbrp, gbrp10le, ...
+    static QRegularExpression rgbRx("^gbrap?(\\d+)?(le|be)?$");
+    static QRegularExpression grayRx("^gray(\\d+)?(le|be)?$");
+
+    QRegularExpressionMatch m = planarRx.match(pixelFormat);
+    if (m.hasMatch()) {
+        format.chroma   = m.captured(1);
+        format.bitDepth = m.captured(2).isEmpty() ? 8 : m.captured(2).toInt();
+    } else if ((m = semiPlanarRx.match(pixelFormat)).hasMatch()) {
+        const QString layout = m.captured(1);
+        format.chroma   = layout == "0" ? "420" : layout == "2" ? "422" : "444";
+        format.bitDepth = m.captured(2).toInt();
+    } else if (pixelFormat == "nv12" || pixelFormat == "nv21") {
+        format.chroma = "420";
+    } else if ((m = rgbRx.match(pixelFormat)).hasMatch()) {
+        format.chroma   = "444";
+        format.bitDepth = m.captured(1).isEmpty() ? 8 : m.captured(1).toInt();
+    } else if ((m = grayRx.match(pixelFormat)).hasMatch()) {
+        format.bitDepth = m.captured(1).isEmpty() ? 8 : m.captured(1).toInt();
+    }
+    return format;
+}
+
+VideoFormat getVideoFormat(const QString& filePath) {
+    if (isPipe(filePath)) return VideoFormat();
+
+    QProcess process;
+    process.start("ffprobe", formatProbeArguments(filePath));
+    if (!process.waitForStarted(3000)) return VideoFormat();
+    if (!process.waitForFinished(isUrl(filePath) ? 20000 : 5000)) {
+        process.kill();
+        return VideoFormat();
+    }
+    return parseFormatProbe(process.readAllStandardOutput());
+}
+
+QStringList formatProbeArguments(const QString& filePath) {
+    QStringList arguments;
+    arguments << "-v" << "error"
+              << "-select_streams" << "v:0"
+              << "-show_entries" << "stream=pix_fmt,bits_per_raw_sample,color_transfer,width,height,avg_frame_rate:format=bit_rate,duration"
+              << "-of" << "default=noprint_wrappers=1"
+              << inputOptions(filePath)
+              << filePath;
+    return arguments;
+}
+
+VideoFormat parseFormatProbe(const QByteArray& output) {
+    // One "key=value" per line
+    QString pixelFormat, transfer;
+    int rawBits = 0, width = 0, height = 0;
+    double bitrate = 0, duration = 0, frameRate = 0;
+    const QStringList lines = QString::fromLocal8Bit(output).split('\n');
+    for (const QString& line : lines) {
+        const QString key   = line.section('=', 0, 0).trimmed();
+        const QString value = line.section('=', 1).trimmed();
+        if (key == "pix_fmt") pixelFormat = value;
+        else if (key == "color_transfer" && value != "unknown") transfer = value;
+        else if (key == "bits_per_raw_sample") rawBits = value.toInt();
+        else if (key == "bit_rate") bitrate = value.toDouble();
+        else if (key == "duration") duration = value.toDouble();
+        else if (key == "width") width = value.toInt();
+        else if (key == "height") height = value.toInt();
+        else if (key == "avg_frame_rate" && value.section('/', 1).toDouble() > 0)
+            frameRate = value.section('/', 0, 0).toDouble() / value.section('/', 1).toDouble();
+    }
+    if (pixelFormat.isEmpty() || pixelFormat == "unknown") return VideoFormat();
+
+    VideoFormat format = describePixelFormat(pixelFormat);
+    // Packed or unusual formats: trust the decoder's sample size when it reports one
+    if (format.chroma.isEmpty() && rawBits > 0) format.bitDepth = rawBits;
+    format.transfer = transfer;
+    format.bitrateKbps = bitrate / 1000.0;
+    format.durationSeconds = duration;
+    format.width = width;
+    format.height = height;
+    format.frameRate = frameRate;
+    return format;
+}
+
+QString planarYuvFormat(const QString& chroma, int bitDepth) {
+    const QString base = QString("yuv%1p").arg(chroma.isEmpty() ? QString("420") : chroma);
+    return bitDepth <= 8 ? base : QString("%1%2le").arg(base).arg(bitDepth);
+}
+
+QString transferLabel(const QString& transfer) {
+    if (transfer == "smpte2084") return "PQ";
+    if (transfer == "arib-std-b67") return "HLG";
+    return transfer.isEmpty() ? QString("unspecified") : transfer;
+}
+
+} // namespace VideoUtils
@@ -1,11 +1,62 @@
 #ifndef VIDEOUTILS_H
 #define VIDEOUTILS_H
 
+#include <QByteArray>
 #include <QString>
+#include <QStringList>
 
 namespace VideoUtils {
+    // Pixel format and transfer characteristics of a file's first video stream,
+    // plus the container's overall bit rate
+    struct VideoFormat {
+        QString pixelFormat;   // ffmpeg name, e.g. "yuv420p10le"; empty if probing failed
+        int bitDepth = 8;
+        QString chroma;        // "420", "422" or "444"; empty for formats without chroma
+        QString transfer;      // color_transfer, e.g. "bt709", "smpte2084" (PQ), "arib-std-b67" (HLG)
+        double bitrateKbps = 0;   // 0 when the container doesn't report one
+        double durationSeconds = 0;   // container duration; 0 when unknown
+        int width = 0, height = 0;
+        double frameRate = 0;         // average frame rate; 0 when unknown
+
+        bool isValid() const { return !pixelFormat.isEmpty(); }
+        bool isHdr() const { return transfer == "smpte2084" || transfer == "arib-std-b67"; }
+    };
+
+    // Local files with a known video extension, plus stream inputs
     bool isValidVideoFile(const QString& filePath);
+
+    // Inputs ffmpeg reads as a stream instead of a local file. URLs (http, https, ftp)
+    // are read in place with range requests, so probes and seeks still work; a named
+    // pipe (FIFO, or \\.\pipe\... on Windows) can only be read once, so nothing
+    // may probe or pre-scan it before the run that consumes it.
+    bool isUrl(const QString& input);
+    bool isPipe(const QString& input);
+    inline bool isStreamInput(const QString& input) { return isUrl(input) || isPipe(input); }
+
+    // How URL inputs are read ("streamInput/..." settings)
+    struct StreamOptions {
+        int readAheadKiB = 8192;   // forward seeks within this are read through, not a new range request
+        int timeoutSeconds = 30;   // a stalled connection fails the job instead of hanging it
+        bool reconnect = true;     // reopen at the current offset after a dropped connection
+
+        static StreamOptions load();
+        void save() const;
+    };
+    // Protocol options to put right before `input` on an ffmpeg (-i) or ffprobe command
+    // line; empty for local files and pipes
+    QStringList inputOptions(const QString& input);
+
     QString getVideoResolution(const QString& filePath);
+    // Runs ffprobe and waits for it; jobs use the two halves below from their own QProcess
+    VideoFormat getVideoFormat(const QString& filePath);
+    QStringList formatProbeArguments(const QString& filePath);
+    VideoFormat parseFormatProbe(const QByteArray& output);
+    // Fills bitDepth and chroma from an ffmpeg pixel format name
+    VideoFormat describePixelFormat(const QString& pixelFormat);
+    // Planar YUV format with the given subsampling and depth, e.g. ("420", 10) -> "yuv420p10le"
+    QString planarYuvFormat(const QString& chroma, int bitDepth);
+    // Short name of a transfer characteristic: "PQ", "HLG", "bt709", ...
+    QString transferLabel(const QString& transfer);
 }
 
 #endif // VIDEOUTILS_H
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "WatchFolder.h"
+#include "VideoUtils.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSet>
+
+static constexpr int PollIntervalMs = 2000;
+
+QString ReferenceRule::referenceFor(const QString& encodedFile, QString *why) const {
+    auto fail = [why](const QString& reason) {
+        if (why) *why = reason;
+        return QString();
+    };
+    const QRegularExpression re(pattern);
+    if (!re.isValid()) return fail("Invalid naming pattern: " + re.errorString());
+
+    const QFileInfo encoded(encodedFile);
+    const QString name = encoded.completeBaseName();
+    const QRegularExpressionMatch match = re.match(name);
+    if (!match.hasMatch()) return fail("Name does not match the naming pattern");
+    QString expanded = replacement;
+    for (int i = 9; i >= 0; --i) expanded.replace(QString("\\%1").arg(i), match.captured(i));
+    QString base = name;
+    base.replace(match.capturedStart(), match.capturedLength(), expanded);
+
+    const QDir dir(directory.isEmpty() ? encoded.absolutePath() : directory);
+    const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Name);
+    for (const QFileInfo& fi : entries) {
+        if (fi.completeBaseName() != base || fi.absoluteFilePath() == encoded.absoluteFilePath()) continue;
+        if (VideoUtils::isValidVideoFile(fi.absoluteFilePath())) return fi.absoluteFilePath();
+    }
+    return fail(QString("No reference named \"%1.*\" in %2").arg(base, dir.absolutePath()));
+}
+
+WatchFolder::WatchFolder(QObject *parent) : QObject(parent) {
+    m_pollTimer.setInterval(PollIntervalMs);
+    connect(&m_pollTimer, &QTimer::timeout, this, [this]() { scan(); });
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, [this]() { scan(); });
+}
+
+bool WatchFolder::start(const QString& directory, bool includeExisting, QString *errorMessage) {
+    stop();
+    const QFileInfo info(directory);
+    if (!info.isDir()) {
+        if (errorMessage) *errorMessage = "Not a directory: " + directory;
+        return false;
+    }
+    m_directory = info.absoluteFilePath();
+    m_clock.start();
+    // Notifications are an optimisation; polling alone still works if this fails
+    m_watcher.addPath(m_directory);
+    scan(!includeExisting);
+    m_pollTimer.start();
+    return true;
+}
+
+void WatchFolder::stop() {
+    m_pollTimer.stop();
+    if (!m_watcher.directories().isEmpty()) m_watcher.removePaths(m_watcher.directories());
+    m_directory.clear();
+    m_candidates.clear();
+    m_reported.clear();
+}
+
+void WatchFolder::scan(bool baseline) {
+    if (m_directory.isEmpty()) return;
+    const qint64 now = m_clock.elapsed();
+    const QFileInfoList entries = QDir(m_directory).entryInfoList(QDir::Files | QDir::NoDotAndDotDot, QDir::Name);
+
+    QSet<QString> present;
+    QStringList ready;
+    for (const QFileInfo& fi : entries) {
+        const QString path = fi.absoluteFilePath();
+        // Hidden files and "x.mkv.part"-style temporaries fail the extension check
+        if (fi.fileName().startsWith('.') || !VideoUtils::isValidVideoFile(path)) continue;
+        const QDateTime modified = fi.lastModified();
+        if (m_reported.value(path) == modified) continue;
+        present.insert(path);
+
+        auto it = m_candidates.find(path);
+        if (it == m_candidates.end()) {
+            m_candidates.insert(path, Candidate{fi.size(), modified, now, baseline});
+            continue;
+        }
+        Candidate& c = *it;
+        if (c.size != fi.size() || c.modified != modified) {
+            // Still being written (or rewritten): restart the settle clock
+            c.size = fi.size();
+            c.modified = modified;
+            c.unchangedSinceMs = now;
+            c.baseline = false;
+            continue;
+        }
+        if (!c.baseline && c.size > 0 && now - c.unchangedSinceMs >= m_settleSeconds * 1000LL)
+            ready << path;
+    }
+
+    // Forget files that were deleted or renamed away
+    for (auto it = m_candidates.begin(); it != m_candidates.end();) {
+        if (present.contains(it.key())) ++it;
+        else it = m_candidates.erase(it);
+    }
+    for (const QString& path : std::as_const(ready)) {
+        m_reported.insert(path, m_candidates.take(path).modified);
+        emit fileReady(path);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef WATCHFOLDER_H
+#define WATCHFOLDER_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+
+// Maps an encode to its reference by file name. `pattern` is matched against the
+// encode's base name (without extension) and `replacement` - which may use \1..\9 -
+// gives the reference's base name, looked up with any video extension in `directory`.
+// The default strips the last "_suffix": "movie_crf30.mkv" -> "movie.*".
+struct ReferenceRule {
+    QString directory;
+    QString pattern     = "^(.+)_[^_]+$";
+    QString replacement = "\\1";
+
+    // Returns the reference path, or an empty string with the reason in `why`
+    QString referenceFor(const QString& encodedFile, QString *why = nullptr) const;
+};
+
+// Reports video files that appear in a directory once they are completely written.
+// Change notifications trigger an immediate scan, and a poll timer rescans in any
+// case (network shares often deliver no notifications). A file counts as complete
+// when its size and modification time have not changed for settleSeconds().
+class WatchFolder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WatchFolder(QObject *parent = nullptr);
+
+    // Files already in the directory are ignored unless includeExisting is set
+    // (or they are still growing).
+    bool start(const QString& directory, bool includeExisting, QString *errorMessage = nullptr);
+    void stop();
+    bool isActive() const { return !m_directory.isEmpty(); }
+    QString directory() const { return m_directory; }
+
+    int settleSeconds() const { return m_settleSeconds; }
+    void setSettleSeconds(int seconds) { m_settleSeconds = qMax(1, seconds); }
+
+signals:
+    // A new (or rewritten) file is complete; emitted once per version of a file
+    void fileReady(const QString& path);
+
+private:
+    void scan(bool baseline = false);
+
+    struct Candidate {
+        qint64 size = -1;
+        QDateTime modified;
+        qint64 unchangedSinceMs = 0;
+        bool baseline = false;   // present at start(); only reported if it changes
+    };
+
+    QFileSystemWatcher m_watcher;
+    QTimer m_pollTimer;
+    QElapsedTimer m_clock;
+    QString m_directory;
+    int m_settleSeconds = 10;
+    QHash<QString, Candidate> m_candidates;
+    QHash<QString, QDateTime> m_reported;   // path -> modification time when reported
+};
+
+#endif // WATCHFOLDER_H
@@ -0,0 +1,304 @@
+#include "WatchTab.h"
+#include "FrameArchive.h"
+#include "JobScheduler.h"
+#include <QDateTime>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QGroupBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QRegularExpression>
+#include <QScrollBar>
+#include <QSettings>
+#include <QTime>
+
+WatchTab::WatchTab(QWidget *parent) : QWidget(parent) {
+    watcher = new WatchFolder(this);
+    setupUI();
+    loadSettings();
+    connect(watcher, &WatchFolder::fileReady, this, &WatchTab::enqueue);
+}
+
+void WatchTab::setupUI() {
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QGroupBox *settingsGroup = new QGroupBox("Watch Settings", this);
+    QFormLayout *form = new QFormLayout(settingsGroup);
+
+    auto dirRow = [this](QLineEdit *edit, const QString& title) {
+        QHBoxLayout *row = new QHBoxLayout();
+        QPushButton *browse = new QPushButton("Browse...", this);
+        row->addWidget(edit);
+        row->addWidget(browse);
+        connect(browse, &QPushButton::clicked, this, [this, edit, title]() {
+            const QString dir = QFileDialog::getExistingDirectory(this, title, edit->text());
+            if (!dir.isEmpty()) edit->setText(dir);
+        });
+        return row;
+    };
+    watchDirEdit = new QLineEdit(this);
+    watchDirEdit->setToolTip("Directory the encoder writes its outputs into");
+    form->addRow("Watched folder:", dirRow(watchDirEdit, "Select Folder to Watch"));
+    referenceDirEdit = new QLineEdit(this);
+    referenceDirEdit->setPlaceholderText("same as watched folder");
+    form->addRow("Reference folder:", dirRow(referenceDirEdit, "Select Reference Folder"));
+
+    QHBoxLayout *ruleLayout = new QHBoxLayout();
+    patternEdit = new QLineEdit(this);
+    patternEdit->setToolTip("Regular expression matched against the encode's name without extension");
+    replacementEdit = new QLineEdit(this);
+    replacementEdit->setMaximumWidth(120);
+    replacementEdit->setToolTip("Reference name without extension; \\1..\\9 insert captured groups.\n"
+                                "Any video file with that name in the reference folder is used.");
+    ruleLayout->addWidget(patternEdit);
+    ruleLayout->addWidget(new QLabel("→", this));
+    ruleLayout->addWidget(replacementEdit);
+    form->addRow("Naming rule:", ruleLayout);
+
+    QHBoxLayout *limitsLayout = new QHBoxLayout();
+    concurrencySpin = new QSpinBox(this);
+    concurrencySpin->setRange(1, 16);
+    concurrencySpin->setToolTip("Comparisons run at the same time; they share the scheduler's thread budget");
+    settleSpin = new QSpinBox(this);
+    settleSpin->setRange(1, 600);
+    settleSpin->setSuffix(" s");
+    settleSpin->setToolTip("A file is treated as complete once its size has not changed for this long");
+    limitsLayout->addWidget(new QLabel("Concurrent comparisons:", this));
+    limitsLayout->addWidget(concurrencySpin);
+    limitsLayout->addSpacing(20);
+    limitsLayout->addWidget(new QLabel("Settle time:", this));
+    limitsLayout->addWidget(settleSpin);
+    limitsLayout->addStretch();
+    form->addRow(limitsLayout);
+
+    gatesEdit = new QLineEdit(this);
+    gatesEdit->setPlaceholderText("optional, e.g. vmaf >= 93; ssim window 2s >= 0.95");
+    gatesEdit->setToolTip("Quality gates checked for every encode (same syntax as in the Verify tab).\n"
+                          "SSIM/PSNR rules stop a failing comparison early.");
+    form->addRow("Quality gates:", gatesEdit);
+
+    includeExistingCheckbox = new QCheckBox("Also verify files already in the folder", this);
+    form->addRow(includeExistingCheckbox);
+    mainLayout->addWidget(settingsGroup);
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    watchBtn = new QPushButton("Start Watching", this);
+    watchBtn->setMinimumHeight(40);
+    cancelBtn = new QPushButton("Cancel Queue", this);
+    cancelBtn->setMinimumHeight(40);
+    cancelBtn->setEnabled(false);
+    buttons->addWidget(watchBtn, 1);
+    buttons->addWidget(cancelBtn);
+    mainLayout->addLayout(buttons);
+
+    statusLabel = new QLabel("Not watching", this);
+    mainLayout->addWidget(statusLabel);
+
+    jobsTable = new QTableWidget(this);
+    jobsTable->setColumnCount(6);
+    jobsTable->setHorizontalHeaderLabels({"File", "Reference", "Status", "SSIM", "PSNR (dB)", "VMAF"});
+    jobsTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    jobsTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::Stretch);
+    jobsTable->horizontalHeader()->setSectionResizeMode(2, QHeaderView::ResizeToContents);
+    jobsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    mainLayout->addWidget(jobsTable, 1);
+
+    QLabel *logLabel = new QLabel("Watch Log:", this);
+    logLabel->setStyleSheet("QLabel { font-weight: bold; }");
+    mainLayout->addWidget(logLabel);
+    logText = new QTextEdit(this);
+    logText->setReadOnly(true);
+    logText->setFont(QFont("Courier New", 8));
+    logText->setMaximumHeight(150);
+    mainLayout->addWidget(logText);
+
+    connect(watchBtn, &QPushButton::clicked, this, &WatchTab::toggleWatching);
+    connect(cancelBtn, &QPushButton::clicked, this, &WatchTab::cancelQueue);
+}
+
+void WatchTab::loadSettings() {
+    QSettings settings;
+    const ReferenceRule defaults;
+    watchDirEdit->setText(settings.value("watch/directory").toString());
+    referenceDirEdit->setText(settings.value("watch/referenceDirectory").toString());
+    patternEdit->setText(settings.value("watch/pattern", defaults.pattern).toString());
+    replacementEdit->setText(settings.value("watch/replacement", defaults.replacement).toString());
+    concurrencySpin->setValue(settings.value("watch/concurrency", 2).toInt());
+    settleSpin->setValue(settings.value("watch/settleSeconds", watcher->settleSeconds()).toInt());
+    gatesEdit->setText(settings.value("watch/gates").toString());
+}
+
+void WatchTab::saveSettings() const {
+    QSettings settings;
+    settings.setValue("watch/directory", watchDirEdit->text());
+    settings.setValue("watch/referenceDirectory", referenceDirEdit->text());
+    settings.setValue("watch/pattern", patternEdit->text());
+    settings.setValue("watch/replacement", replacementEdit->text());
+    settings.setValue("watch/concurrency", concurrencySpin->value());
+    settings.setValue("watch/settleSeconds", settleSpin->value());
+    settings.setValue("watch/gates", gatesEdit->text());
+}
+
+void WatchTab::toggleWatching() {
+    if (watcher->isActive()) {
+        watcher->stop();
+        watchBtn->setText("Start Watching");
+        statusLabel->setText("Not watching");
+        log("Stopped watching; queued comparisons continue.");
+        return;
+    }
+
+    m_rule.directory   = referenceDirEdit->text().trimmed();
+    m_rule.pattern     = patternEdit->text();
+    m_rule.replacement = replacementEdit->text();
+    if (!QRegularExpression(m_rule.pattern).isValid()) {
+        QMessageBox::warning(this, "Invalid Naming Rule", "The naming pattern is not a valid regular expression.");
+        return;
+    }
+    QString gateError;
+    m_gates = QualityGate::parse(gatesEdit->text(), &gateError);
+    if (!gateError.isEmpty()) {
+        QMessageBox::warning(this, "Invalid Quality Gates", gateError);
+        return;
+    }
+    watcher->setSettleSeconds(settleSpin->value());
+    QString error;
+    if (!watcher->start(watchDirEdit->text().trimmed(), includeExistingCheckbox->isChecked(), &error)) {
+        QMessageBox::warning(this, "Watch Folder", error);
+        return;
+    }
+    saveSettings();
+    watchBtn->setText("Stop Watching");
+    statusLabel->setText("Watching " + watcher->directory());
+    log("Watching " + watcher->directory());
+}
+
+void WatchTab::enqueue(const QString& file) {
+    Item item;
+    item.file = file;
+    QString why;
+    item.reference = m_rule.referenceFor(file, &why);
+
+    item.row = jobsTable->rowCount();
+    jobsTable->insertRow(item.row);
+    jobsTable->setItem(item.row, 0, new QTableWidgetItem(QFileInfo(file).fileName()));
+    jobsTable->setItem(item.row, 1, new QTableWidgetItem(QFileInfo(item.reference).fileName()));
+    jobsTable->item(item.row, 0)->setToolTip(file);
+    jobsTable->item(item.row, 1)->setToolTip(item.reference);
+    m_items << item;
+
+    const int index = m_items.size() - 1;
+    if (item.reference.isEmpty()) {
+        setStatus(index, "No reference");
+        jobsTable->item(item.row, 1)->setToolTip(why);
+        log(QFileInfo(file).fileName() + ": " + why);
+        return;
+    }
+    setStatus(index, "Queued");
+    log(QString("%1 is complete; pairing with %2").arg(QFileInfo(file).fileName(), QFileInfo(item.reference).fileName()));
+    m_pending << index;
+    startNext();
+}
+
+void WatchTab::startNext() {
+    const int concurrency = concurrencySpin->value();
+    // Split the budget so a full set of watch jobs fits at once
+    const int threads = qMax(1, JobScheduler::instance()->threadBudget() / concurrency);
+    while (m_running < concurrency && !m_pending.isEmpty()) {
+        const int index = m_pending.takeFirst();
+        FfmpegJob *job = new FfmpegJob(this);
+        job->setCollectFrameMetrics(true);
+        job->setPriority(JobScheduler::Low);   // interactive comparisons go first
+        job->setThreads(threads);
+        job->setQualityGates(m_gates);
+        m_items[index].job = job;
+        ++m_running;
+
+        connect(job, &FfmpegJob::processStarted, this, [this, index]() { setStatus(index, "Running"); });
+        connect(job, &FfmpegJob::progressUpdated, this, [this, index](double current, double total) {
+            if (total > 0) setStatus(index, QString("Running %1%").arg(qMin(100, int(current / total * 100.0))));
+        });
+        connect(job, &FfmpegJob::comparisonResult, this, [this, index](int, const ComparisonResult& r) {
+            m_items[index].result = r;
+            m_items[index].hasResult = true;
+        });
+        connect(job, &FfmpegJob::frameMetricsReady, this, [this, index](int, const FrameMetrics& metrics) {
+            Item& item = m_items[index];
+            const QString path = FrameArchive::newArchivePath(item.file);
+            const QJsonObject metadata{{"reference", item.reference}, {"distorted", item.file},
+                                       {"created", QDateTime::currentDateTime().toString(Qt::ISODate)},
+                                       {"watch", true}};
+            QString error;
+            if (FrameArchive::write(path, metrics, metadata, &error)) item.frameArchive = path;
+            else log("Could not save per-frame data: " + error);
+        });
+        connect(job, &FfmpegJob::finished, this, [this, index](bool success, int exitCode) {
+            Item& item = m_items[index];
+            const ComparisonResult& r = item.result;
+            // Stopped by a failed gate: still a verdict worth recording
+            const bool gateAbort = !success && item.job->abortedByGate();
+            if ((success || gateAbort) && item.hasResult) {
+                const auto ssimText = r.hasSsim ? QString::number(r.ssim.all, 'f', 4) : QString("--");
+                const auto psnrText = r.hasPsnr ? (r.psnr.avgDb == "inf" ? QString("∞") : r.psnr.avgDb) : QString("--");
+                const auto vmafText = r.hasVmaf ? QString::number(r.vmaf, 'f', 2) : QString("--");
+                jobsTable->setItem(item.row, 3, new QTableWidgetItem(ssimText));
+                jobsTable->setItem(item.row, 4, new QTableWidgetItem(psnrText));
+                jobsTable->setItem(item.row, 5, new QTableWidgetItem(vmafText));
+                setStatus(index, !r.hasGate ? QString("Done")
+                                 : r.gatePassed ? QString("Done - gates passed")
+                                 : gateAbort ? QString("Gate failed (stopped early)") : QString("Gate failed"));
+
+                QStringList results;
+                if (r.hasSsim) results << "SSIM: " + ssimText;
+                if (r.hasPsnr) results << "PSNR: " + r.psnr.avgDb + " dB";
+                if (r.hasVmaf) results << "VMAF: " + vmafText;
+                for (const MetricScore& s : r.extra) results << s.text();
+                if (r.hasGate) results << (r.gatePassed ? QString("Gate: PASS") : "Gate: FAIL - " + r.gateDetail);
+                if (r.bitrateKbps > 0) results << QString("Bitrate: %1 kbps").arg(r.bitrateKbps, 0, 'f', 0);
+                if (!r.pixelFormat.isEmpty()) results << "Format: " + r.formatLabel();
+                emit comparisonCompleted("Comparison (watch)",
+                                         QFileInfo(item.reference).fileName() + " vs " + QFileInfo(item.file).fileName(),
+                                         results.join(" | "), item.frameArchive);
+                log(QFileInfo(item.file).fileName() + ": " + results.join(" | "));
+            } else {
+                setStatus(index, item.cancelled ? "Cancelled" : QString("Failed (exit %1)").arg(exitCode));
+                log(QString("%1: ffmpeg exited with code %2").arg(QFileInfo(item.file).fileName()).arg(exitCode));
+            }
+            item.job->deleteLater();
+            item.job = nullptr;
+            --m_running;
+            startNext();
+        });
+
+        setStatus(index, "Waiting for scheduler");
+        job->start(m_items[index].reference, m_items[index].file);
+    }
+    cancelBtn->setEnabled(m_running > 0 || !m_pending.isEmpty());
+}
+
+void WatchTab::cancelQueue() {
+    for (int index : std::as_const(m_pending)) setStatus(index, "Cancelled");
+    m_pending.clear();
+    for (Item& item : m_items) {
+        if (!item.job) continue;
+        item.cancelled = true;
+        item.job->cancel();
+    }
+    log("Cancelled queued and running comparisons.");
+}
+
+void WatchTab::setStatus(int index, const QString& status) {
+    jobsTable->setItem(m_items[index].row, 2, new QTableWidgetItem(status));
+    if (watcher->isActive())
+        statusLabel->setText(QString("Watching %1 - %2 running, %3 queued")
+                             .arg(watcher->directory()).arg(m_running).arg(m_pending.size()));
+}
+
+void WatchTab::log(const QString& line) {
+    logText->append(QTime::currentTime().toString("HH:mm:ss") + "  " + line);
+    logText->verticalScrollBar()->setValue(logText->verticalScrollBar()->maximum());
+}
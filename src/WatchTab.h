@@ -0,0 +1,75 @@
+#ifndef WATCHTAB_H
+#define WATCHTAB_H
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QLabel>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <QTextEdit>
+#include <QList>
+#include "FfmpegJob.h"
+#include "WatchFolder.h"
+
+// Watch-folder mode: every encode that lands in the watched directory is paired
+// with its reference by name and scored in the background, a few at a time,
+// so verification overlaps with the rest of an encoding batch.
+class WatchTab : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit WatchTab(QWidget *parent = nullptr);
+
+signals:
+    // Same shape as VerifyTab::comparisonCompleted, for the history
+    void comparisonCompleted(const QString& type, const QString& details, const QString& result,
+                             const QString& frameArchive);
+
+private slots:
+    void toggleWatching();
+    void cancelQueue();
+    void enqueue(const QString& file);
+
+private:
+    void setupUI();
+    void loadSettings();
+    void saveSettings() const;
+    void startNext();
+    void setStatus(int item, const QString& status);
+    void log(const QString& line);
+
+    struct Item {
+        QString file, reference;
+        int row = -1;
+        FfmpegJob *job = nullptr;
+        ComparisonResult result;
+        bool hasResult = false;
+        bool cancelled = false;
+        QString frameArchive;
+    };
+
+    QLineEdit *watchDirEdit;
+    QLineEdit *referenceDirEdit;
+    QLineEdit *patternEdit;
+    QLineEdit *replacementEdit;
+    QSpinBox *concurrencySpin;
+    QSpinBox *settleSpin;
+    QLineEdit *gatesEdit;
+    QCheckBox *includeExistingCheckbox;
+    QPushButton *watchBtn;
+    QPushButton *cancelBtn;
+    QLabel *statusLabel;
+    QTableWidget *jobsTable;
+    QTextEdit *logText;
+
+    WatchFolder *watcher;
+    ReferenceRule m_rule;
+    QList<GateRule> m_gates;
+    QList<Item> m_items;
+    QList<int> m_pending;   // indices into m_items, in arrival order
+    int m_running = 0;
+};
+
+#endif // WATCHTAB_H
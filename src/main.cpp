@@ -1,9 +1,52 @@
 #include "MainWindow.h"
+#include "JobProtocol.h"
+#include "JobServer.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
 #include <QIcon>
 
+// Headless job server: QCoreApplication only, so it runs on display-less worker boxes.
+static int runServer(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("VidMetric");
+    QCoreApplication::setApplicationName("VidMetric");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("VidMetric job server");
+    parser.addHelpOption();
+    parser.addOption({"server", "Run as a headless job server."});
+    parser.addOption({"listen",
+                      QString("Address to listen on: [host:]port or local:<name>. May be repeated. "
+                              "Default: 127.0.0.1:%1").arg(JobProtocol::DefaultPort),
+                      "address"});
+    parser.process(app);
+
+    QStringList addresses = parser.values("listen");
+    if (addresses.isEmpty()) addresses << QString("127.0.0.1:%1").arg(JobProtocol::DefaultPort);
+
+    JobServer server;
+    QObject::connect(&server, &JobServer::logLine, [](const QString& line) {
+        qInfo().noquote() << line;
+    });
+    for (const QString& address : addresses) {
+        QString error;
+        if (!server.listen(address, &error)) {
+            qCritical().noquote() << "Cannot listen on" << address << ":" << error;
+            return 1;
+        }
+    }
+    return app.exec();
+}
+
 int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i)
+        if (qstrcmp(argv[i], "--server") == 0) return runServer(argc, argv);
+
     QApplication app(argc, argv);
+    QCoreApplication::setOrganizationName("VidMetric");
+    QCoreApplication::setApplicationName("VidMetric");
     
     // Set application icon
     app.setWindowIcon(QIcon(":/ffmpeg-icon.ico"));